@@ -0,0 +1,80 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/LevelMeter.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+
+namespace {
+// The per-sample loop LevelMeter::analyse() replaces, as a baseline
+LevelMeter::Levels analyseScalar(const float *data, int numSamples) {
+  float peak = 0.0f;
+  float sumOfSquares = 0.0f;
+  for (int i = 0; i < numSamples; ++i) {
+    peak = juce::jmax(peak, std::abs(data[i]));
+    sumOfSquares += data[i] * data[i];
+  }
+  return {peak, sumOfSquares};
+}
+
+// Metering one track's stereo output for a block: what each track adds to
+// processBlock. rt_budget_pct is comparable with BM_ProcessBlock's.
+void BM_TrackMetering(benchmark::State &state) {
+  const auto blockSize = static_cast<int>(state.range(0));
+  const auto vectorised = state.range(1) != 0;
+  const double sampleRate = 48000.0;
+  state.SetLabel(vectorised ? "simd" : "scalar");
+
+  juce::AudioBuffer<float> block(2, blockSize);
+  juce::Random random(42);
+  for (int channel = 0; channel < 2; ++channel)
+    for (int i = 0; i < blockSize; ++i)
+      block.setSample(channel, i, random.nextFloat() * 0.2f - 0.1f);
+
+  LevelMeter meter;
+  meter.prepare(sampleRate);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (auto _ : state) {
+    for (int channel = 0; channel < 2; ++channel) {
+      const float *data = block.getReadPointer(channel);
+      if (vectorised) {
+        meter.measure(channel, data, blockSize, 0.7f);
+      } else {
+        const auto levels = analyseScalar(data, blockSize);
+        benchmark::DoNotOptimize(levels);
+      }
+    }
+    benchmark::DoNotOptimize(meter.update(blockSize));
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  const double samples = static_cast<double>(state.iterations()) * blockSize;
+  state.SetItemsProcessed(static_cast<int64_t>(samples));
+  state.counters["ns_per_sample"] = elapsed.count() * 1.0e9 / samples;
+  state.counters["rt_budget_pct"] =
+      100.0 * elapsed.count() / (samples / sampleRate);
+}
+
+BENCHMARK(BM_TrackMetering)
+    ->ArgNames({"block", "simd"})
+    ->ArgsProduct({{32, 128, 512, 2048}, {0, 1}})
+    ->UseRealTime();
+} // namespace
@@ -0,0 +1,135 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench_session.h"
+
+namespace {
+enum Mix { playAll = 0, soloHalf = 1, recordOne = 2 };
+
+const char *mixName(int mix) {
+  switch (mix) {
+  case soloHalf:
+    return "solo";
+  case recordOne:
+    return "record";
+  default:
+    return "play";
+  }
+}
+
+// Tracks x layers x block size, all tracks playing at 48 kHz
+void BM_ProcessBlock(benchmark::State &state) {
+  const auto numTracks = static_cast<int>(state.range(0));
+  const auto numLayers = static_cast<int>(state.range(1));
+  const auto blockSize = static_cast<int>(state.range(2));
+  auto &session = getSession(numTracks, numLayers, 48000.0);
+
+  session.run(state, blockSize);
+}
+
+BENCHMARK(BM_ProcessBlock)
+    ->ArgNames({"tracks", "layers", "block"})
+    ->ArgsProduct({{1, 4, 16, 64}, {1, 4, 32}, {32, 128, 512, 2048}})
+    ->UseRealTime();
+
+// Eight tracks of four layers at common sample rates
+void BM_ProcessBlockSampleRate(benchmark::State &state) {
+  const auto sampleRate = static_cast<double>(state.range(0));
+  const int blockSize = 256;
+  auto &session = getSession(8, 4, sampleRate);
+
+  session.run(state, blockSize);
+}
+
+BENCHMARK(BM_ProcessBlockSampleRate)
+    ->ArgName("rate")
+    ->Arg(44100)
+    ->Arg(48000)
+    ->Arg(96000)
+    ->UseRealTime();
+
+// Everything playing, half the tracks soloed, or one track overdubbing
+void BM_ProcessBlockMix(benchmark::State &state) {
+  const auto mix = static_cast<int>(state.range(0));
+  const auto numTracks = static_cast<int>(state.range(1));
+  const int blockSize = 256;
+  state.SetLabel(mixName(mix));
+
+  // Changes the session, so don't share it
+  BenchSession session(numTracks, 4, 48000.0);
+  auto &manager = session.manager;
+  const auto tracks = manager.getTracks();
+  if (mix == soloHalf) {
+    for (size_t i = 0; i < tracks.size(); i += 2)
+      tracks[i]->setSoloed(true);
+  }
+  if (mix != recordOne) {
+    session.process(blockSize);
+    session.run(state, blockSize);
+    return;
+  }
+
+  // Overdub for a little under one pass, then undo what it recorded (a
+  // layer either side of the loop's end) and wait for the layer sum before
+  // starting again, so the layers don't pile up
+  const auto &looper = tracks.front()->getLooper();
+  const int recordId = tracks.front()->getId();
+  const auto numLayers = looper.getNumLoops();
+  auto rearm = [&] {
+    while (looper.getNumLoops() > numLayers) {
+      manager.undoTrack(recordId);
+      session.process(blockSize);
+    }
+    while (!looper.hasLayerSum()) {
+      juce::Thread::sleep(1);
+      session.process(blockSize);
+    }
+    manager.startRecordingTrack(recordId);
+    session.process(blockSize);
+  };
+  manager.startRecordingTrack(recordId);
+  session.process(blockSize);
+
+  session.run(state, blockSize, session.loopLength / blockSize - 2, rearm);
+}
+
+BENCHMARK(BM_ProcessBlockMix)
+    ->ArgNames({"mix", "tracks"})
+    ->ArgsProduct({{playAll, soloHalf, recordOne}, {1, 16}})
+    ->UseRealTime();
+
+// Serial against parallel playback rendering, to find the crossover
+void BM_ParallelRender(benchmark::State &state) {
+  const auto numTracks = static_cast<int>(state.range(0));
+  const auto parallel = state.range(1) != 0;
+  const int blockSize = 256;
+
+  BenchSession session(numTracks, 1, 48000.0);
+  const int numWorkers =
+      juce::jmax(1, juce::SystemStats::getNumPhysicalCpus() - 1);
+  session.manager.setParallelRendering(parallel ? numWorkers : 0, 1);
+  session.process(blockSize);
+
+  session.run(state, blockSize);
+}
+
+BENCHMARK(BM_ParallelRender)
+    ->ArgNames({"tracks", "parallel"})
+    ->ArgsProduct({{2, 4, 8, 16, 32, 64}, {0, 1}})
+    ->UseRealTime();
+} // namespace
@@ -0,0 +1,149 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../Source/Models/Track.h"
+#include "../Source/Models/TrackManager.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+
+/**
+ * BenchSession - A headless multi-track session for benchmarks
+ *
+ * Builds a TrackManager with `numTracks` playing tracks of `numLayers`
+ * layers each, recorded from noise straight into the loopers so setup stays
+ * fast. The benchmark thread then acts as the audio thread.
+ */
+class BenchSession {
+public:
+  static constexpr int maxBlockSize = 2048;
+  static constexpr double loopSeconds = 0.25;
+
+  BenchSession(int numTracks, int numLayers, double sampleRate)
+      : sampleRate(sampleRate),
+        loopLength(static_cast<int>(sampleRate * loopSeconds)),
+        noise(2, loopLength), block(2, maxBlockSize) {
+    juce::Random random(42);
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < loopLength; ++i)
+        noise.setSample(channel, i, random.nextFloat() * 0.2f - 0.1f);
+
+    manager.prepare(sampleRate, maxBlockSize);
+    manager.setBaseLoopLength(loopLength);
+
+    for (int t = 0; t < numTracks; ++t) {
+      auto &looper = manager.addTrack()->getLooper();
+      looper.startRecording(0, loopLength);
+      for (int layer = 0; layer < numLayers; ++layer) {
+        // Stop one short of the end on the last pass so recording doesn't
+        // roll over into an empty layer
+        const int passLength =
+            layer == numLayers - 1 ? loopLength - 1 : loopLength;
+        juce::AudioBuffer<float> pass(noise.getArrayOfWritePointers(), 2, 0,
+                                      passLength);
+        looper.processRecording(pass, loopLength, 0);
+      }
+      looper.stopRecording(loopLength);
+    }
+
+    manager.startPlayback();
+    process(maxBlockSize);
+  }
+
+  // One block of `numSamples`, with fresh input for any recording track
+  void process(int numSamples) {
+    const int start = position % (loopLength - numSamples + 1);
+    for (int channel = 0; channel < 2; ++channel)
+      block.copyFrom(channel, 0, noise, channel, start, numSamples);
+    position += numSamples;
+
+    juce::AudioBuffer<float> buffer(block.getArrayOfWritePointers(), 2, 0,
+                                    numSamples);
+    manager.processBlock(buffer, false);
+  }
+
+  // Time blocks of `blockSize` and report ns per sample and the share of
+  // the real-time budget used, both from the wall clock
+  void run(benchmark::State &state, int blockSize) {
+    run(state, blockSize, 0, [] {});
+  }
+
+  // As above, but with timing paused, calls `reset` every `numBlocks`
+  // blocks, so sessions that would otherwise grow for as long as the
+  // benchmark runs are measured in a steady state
+  template <typename Reset>
+  void run(benchmark::State &state, int blockSize, int numBlocks,
+           Reset &&reset) {
+    using Clock = std::chrono::steady_clock;
+    Clock::duration elapsed{};
+    auto start = Clock::now();
+    int blocksLeft = numBlocks;
+    for (auto _ : state) {
+      process(blockSize);
+      if (numBlocks > 0 && --blocksLeft == 0) {
+        elapsed += Clock::now() - start;
+        state.PauseTiming();
+        reset();
+        blocksLeft = numBlocks;
+        state.ResumeTiming();
+        start = Clock::now();
+      }
+    }
+    elapsed += Clock::now() - start;
+    report(state, blockSize,
+           std::chrono::duration<double>(elapsed).count());
+  }
+
+  TrackManager manager;
+  const double sampleRate;
+  const int loopLength;
+
+private:
+  juce::AudioBuffer<float> noise;
+  juce::AudioBuffer<float> block;
+  int position = 0;
+
+  void report(benchmark::State &state, int blockSize, double seconds) {
+    const double samples = static_cast<double>(state.iterations()) * blockSize;
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["ns_per_sample"] = seconds * 1.0e9 / samples;
+    state.counters["rt_budget_pct"] =
+        100.0 * seconds / (samples / sampleRate);
+  }
+};
+
+// Sessions are slow to build, so keep the last one around while a sweep
+// only changes the block size
+inline BenchSession &getSession(int numTracks, int numLayers,
+                                double sampleRate) {
+  static std::unique_ptr<BenchSession> session;
+  static int cachedTracks = 0, cachedLayers = 0;
+  static double cachedRate = 0.0;
+
+  if (session == nullptr || cachedTracks != numTracks ||
+      cachedLayers != numLayers || cachedRate != sampleRate) {
+    session.reset();
+    session = std::make_unique<BenchSession>(numTracks, numLayers, sampleRate);
+    cachedTracks = numTracks;
+    cachedLayers = numLayers;
+    cachedRate = sampleRate;
+  }
+  return *session;
+}
@@ -0,0 +1,179 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/LayerCodec.h"
+#include "bench_session.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+void BM_WaveformPeaks(benchmark::State &state) {
+  const auto numLayers = static_cast<int>(state.range(0));
+  const int numBins = 512;
+  auto &session = getSession(1, numLayers, 48000.0);
+  const auto &looper = session.manager.getTracks().front()->getLooper();
+
+  for (auto _ : state) {
+    auto peaks = looper.getWaveformPeaks(numBins, 0, session.loopLength);
+    benchmark::DoNotOptimize(peaks.data());
+  }
+}
+
+BENCHMARK(BM_WaveformPeaks)->ArgName("layers")->Arg(1)->Arg(8)->Arg(32);
+
+// Saving a session into a block, as getStateInformation() does
+juce::MemoryBlock saveSession(const BenchSession &session,
+                              bool compressAudio) {
+  juce::MemoryBlock block;
+  juce::MemoryOutputStream stream(block, false);
+  stream.preallocate(session.manager.getStateSizeEstimate());
+  SessionWriter writer(stream);
+  session.manager.writeState(writer, session.sampleRate, compressAudio);
+  writer.finish();
+  stream.flush();
+  return block;
+}
+
+// Throughput is of the raw session, so compressed runs compare directly
+void reportSize(benchmark::State &state, size_t rawBytes, size_t numBytes) {
+  state.SetBytesProcessed(static_cast<juce::int64>(state.iterations()) *
+                          static_cast<juce::int64>(rawBytes));
+  state.counters["bytes"] = static_cast<double>(numBytes);
+  state.counters["ratio"] =
+      static_cast<double>(rawBytes) / static_cast<double>(numBytes);
+}
+
+void BM_GetState(benchmark::State &state) {
+  const auto numTracks = static_cast<int>(state.range(0));
+  const auto numLayers = static_cast<int>(state.range(1));
+  const bool compressAudio = state.range(2) != 0;
+  auto &session = getSession(numTracks, numLayers, 48000.0);
+
+  size_t numBytes = 0;
+  for (auto _ : state) {
+    const auto block = saveSession(session, compressAudio);
+    numBytes = block.getSize();
+    benchmark::DoNotOptimize(block.getData());
+  }
+  reportSize(state, saveSession(session, false).getSize(), numBytes);
+}
+
+BENCHMARK(BM_GetState)
+    ->ArgNames({"tracks", "layers", "compressed"})
+    ->ArgsProduct({{1, 8}, {1, 8}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_SetState(benchmark::State &state) {
+  const auto numTracks = static_cast<int>(state.range(0));
+  const auto numLayers = static_cast<int>(state.range(1));
+  const bool compressAudio = state.range(2) != 0;
+  auto &session = getSession(numTracks, numLayers, 48000.0);
+  const auto block = saveSession(session, compressAudio);
+
+  TrackManager restored;
+  restored.prepare(session.sampleRate, BenchSession::maxBlockSize);
+  for (auto _ : state) {
+    SessionReader reader(block.getData(), block.getSize());
+    restored.readState(reader, session.sampleRate);
+  }
+  reportSize(state, saveSession(session, false).getSize(), block.getSize());
+}
+
+BENCHMARK(BM_SetState)
+    ->ArgNames({"tracks", "layers", "compressed"})
+    ->ArgsProduct({{1, 8}, {1, 8}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// The codec alone on one channel of ten seconds, by kind of material:
+// white noise, a 24-bit sine, and a sine that is silent half the time
+enum class Material { noise, sine24, gated };
+
+std::vector<float> makeMaterial(Material material) {
+  std::vector<float> samples(480000);
+  juce::Random random(42);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const auto sine = std::sin(static_cast<float>(i) * 0.0314f) * 0.5f;
+    const auto quantised = std::round(sine * 8388608.0f) / 8388608.0f;
+    switch (material) {
+    case Material::noise:
+      samples[i] = random.nextFloat() * 0.2f - 0.1f;
+      break;
+    case Material::sine24:
+      samples[i] = quantised;
+      break;
+    case Material::gated:
+      samples[i] = (i / 24000) % 2 == 0 ? quantised : 0.0f;
+      break;
+    }
+  }
+  return samples;
+}
+
+void encode(LayerCodec &codec, const std::vector<float> &samples,
+            juce::MemoryOutputStream &output) {
+  output.reset();
+  const int total = static_cast<int>(samples.size());
+  for (int pos = 0; pos < total; pos += LayerCodec::maxFrameSize)
+    codec.encodeFrame(samples.data() + pos,
+                      juce::jmin(LayerCodec::maxFrameSize, total - pos),
+                      output);
+}
+
+void BM_LayerEncode(benchmark::State &state) {
+  const auto samples = makeMaterial(static_cast<Material>(state.range(0)));
+  LayerCodec codec;
+  juce::MemoryOutputStream output;
+  for (auto _ : state) {
+    encode(codec, samples, output);
+    benchmark::DoNotOptimize(output.getData());
+  }
+  reportSize(state, sizeof(float) * samples.size(), output.getDataSize());
+}
+
+BENCHMARK(BM_LayerEncode)
+    ->ArgName("material")
+    ->DenseRange(0, 2)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_LayerDecode(benchmark::State &state) {
+  const auto samples = makeMaterial(static_cast<Material>(state.range(0)));
+  LayerCodec codec;
+  juce::MemoryOutputStream encoded;
+  encode(codec, samples, encoded);
+
+  std::vector<float> decoded(samples.size());
+  const int total = static_cast<int>(samples.size());
+  for (auto _ : state) {
+    juce::MemoryInputStream input(encoded.getData(), encoded.getDataSize(),
+                                  false);
+    for (int pos = 0; pos < total; pos += LayerCodec::maxFrameSize)
+      codec.decodeFrame(input,
+                        juce::jmin(LayerCodec::maxFrameSize, total - pos),
+                        decoded.data() + pos);
+    benchmark::DoNotOptimize(decoded.data());
+  }
+  reportSize(state, sizeof(float) * samples.size(), encoded.getDataSize());
+}
+
+BENCHMARK(BM_LayerDecode)
+    ->ArgName("material")
+    ->DenseRange(0, 2)
+    ->Unit(benchmark::kMillisecond);
+} // namespace
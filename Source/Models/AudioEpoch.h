@@ -0,0 +1,55 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <juce_core/juce_core.h>
+
+/**
+ * AudioEpoch - Lets other threads tell when the audio thread has moved on
+ *
+ * The counter is odd while a block is being processed. Once something has
+ * been unpublished, the audio thread can only still be holding it if it was
+ * mid-block at that moment; as soon as the counter moves past the value read
+ * right after unpublishing, that block is over.
+ */
+class AudioEpoch {
+public:
+  // Wraps one audio callback
+  class Scope {
+  public:
+    explicit Scope(AudioEpoch &e) : epoch(e) { epoch.counter.fetch_add(1); }
+    ~Scope() { epoch.counter.fetch_add(1); }
+
+  private:
+    AudioEpoch &epoch;
+
+    JUCE_DECLARE_NON_COPYABLE(Scope)
+  };
+
+  juce::uint64 now() const { return counter.load(); }
+
+  // True once no block that was running at `stamp` can still be running
+  bool hasPassed(juce::uint64 stamp) const {
+    return (stamp & 1) == 0 || counter.load() != stamp;
+  }
+
+private:
+  std::atomic<juce::uint64> counter{0};
+};
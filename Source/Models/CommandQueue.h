@@ -0,0 +1,95 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <juce_core/juce_core.h>
+
+/**
+ * CommandQueue - Fixed-capacity multi-producer, single-consumer queue
+ *
+ * Any number of threads may push while one thread pops. Neither side locks
+ * or allocates, so the audio thread can sit on either end (hosts may deliver
+ * parameter changes on it). A full queue makes push() fail rather than wait.
+ *
+ * Each slot carries a sequence number saying whose turn it is: producers
+ * claim a slot by advancing the write position, fill it, then hand it to the
+ * consumer by bumping its sequence.
+ */
+template <typename ItemType, int capacity> class CommandQueue {
+public:
+  static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                "capacity must be a power of two");
+
+  CommandQueue() {
+    for (size_t i = 0; i < slots.size(); ++i)
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  // Any thread
+  bool push(const ItemType &item) {
+    auto position = writePosition.load(std::memory_order_relaxed);
+    for (;;) {
+      auto &slot = slots[position & mask];
+      const auto sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+
+      if (lag == 0) {
+        if (writePosition.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+          slot.item = item;
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (lag < 0) {
+        return false; // full
+      } else {
+        position = writePosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consumer thread only
+  bool pop(ItemType &item) {
+    auto &slot = slots[readPosition & mask];
+    const auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != readPosition + 1)
+      return false; // empty, or the producer is still filling it
+
+    item = slot.item;
+    slot.sequence.store(readPosition + capacity, std::memory_order_release);
+    ++readPosition;
+    return true;
+  }
+
+private:
+  static constexpr size_t mask = static_cast<size_t>(capacity) - 1;
+
+  struct Slot {
+    std::atomic<size_t> sequence{0};
+    ItemType item{};
+  };
+
+  std::array<Slot, static_cast<size_t>(capacity)> slots;
+  std::atomic<size_t> writePosition{0};
+  size_t readPosition = 0;
+
+  JUCE_DECLARE_NON_COPYABLE(CommandQueue)
+};
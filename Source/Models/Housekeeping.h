@@ -0,0 +1,40 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+/**
+ * HousekeepingThread - Low-priority thread for work kept off the audio thread
+ *
+ * Shared by every looper in the process; take a reference with
+ * juce::SharedResourcePointer<HousekeepingThread> and register a
+ * juce::TimeSliceClient on it.
+ */
+class HousekeepingThread : public juce::TimeSliceThread {
+public:
+  HousekeepingThread() : juce::TimeSliceThread("Looper Housekeeping") {
+    startThread(juce::Thread::Priority::low);
+  }
+
+  ~HousekeepingThread() override { stopThread(2000); }
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HousekeepingThread)
+};
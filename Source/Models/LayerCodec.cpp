@@ -0,0 +1,373 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LayerCodec.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+juce::uint32 bitsOf(float value) {
+  juce::uint32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+float floatOf(juce::uint32 bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Negative floats count down from -1, so neighbouring values stay close and
+// -0.0 and +0.0 remain distinct. Its own inverse.
+juce::uint32 toOrdered(juce::uint32 bits) {
+  return bits ^ ((bits & 0x80000000u) != 0 ? 0x7fffffffu : 0u);
+}
+
+juce::uint32 zigzag(juce::uint32 residual) {
+  return (residual << 1) ^ (0u - (residual >> 31));
+}
+
+juce::uint32 unzigzag(juce::uint32 value) {
+  return (value >> 1) ^ (0u - (value & 1u));
+}
+
+// What a fixed predictor expects at `i`; wraps like the residuals do
+juce::uint32 predict(const juce::uint32 *values, int i, int order) {
+  const juce::uint32 last = i > 0 ? values[i - 1] : 0u;
+  const juce::uint32 beforeLast = i > 1 ? values[i - 2] : 0u;
+  switch (order) {
+  case 1:
+    return last;
+  case 2:
+    return 2u * last - beforeLast;
+  default:
+    return 0u;
+  }
+}
+
+int numPartitionsFor(int numSamples) {
+  return (numSamples + LayerCodec::partitionSize - 1) /
+         LayerCodec::partitionSize;
+}
+
+// Most-significant bit first
+class BitWriter {
+public:
+  explicit BitWriter(std::vector<juce::uint8> &dest) : bytes(dest) {}
+
+  // `numBits` up to 32; `value` must fit in them
+  void write(juce::uint32 value, int numBits) {
+    buffer = (buffer << numBits) | value;
+    pending += numBits;
+    while (pending >= 8) {
+      pending -= 8;
+      bytes.push_back(static_cast<juce::uint8>(buffer >> pending));
+    }
+  }
+
+  void flush() {
+    if (pending > 0)
+      write(0, 8 - pending);
+  }
+
+private:
+  std::vector<juce::uint8> &bytes;
+  juce::uint64 buffer = 0;
+  int pending = 0;
+};
+
+class BitReader {
+public:
+  BitReader(const juce::uint8 *source, size_t numBytes)
+      : bytes(source), size(numBytes) {}
+
+  juce::uint32 read(int numBits) {
+    while (pending < numBits) {
+      if (position == size) {
+        overrun = true;
+        return 0;
+      }
+      buffer = (buffer << 8) | bytes[position++];
+      pending += 8;
+    }
+    pending -= numBits;
+    return static_cast<juce::uint32>(buffer >> pending) &
+           static_cast<juce::uint32>((juce::uint64{1} << numBits) - 1);
+  }
+
+  // Count one bits up to a zero bit, or up to `limit` ones
+  int readUnary(int limit) {
+    int count = 0;
+    while (count < limit && read(1) == 1u)
+      ++count;
+    return count;
+  }
+
+  bool hasOverrun() const { return overrun; }
+
+private:
+  const juce::uint8 *bytes;
+  size_t size;
+  size_t position = 0;
+  juce::uint64 buffer = 0;
+  int pending = 0;
+  bool overrun = false;
+};
+} // namespace
+
+LayerCodec::LayerCodec() {
+  values.resize(maxFrameSize);
+  for (auto &orderResiduals : residuals)
+    orderResiduals.resize(maxFrameSize);
+  bits.reserve(sizeof(float) * maxFrameSize);
+}
+
+juce::uint8 LayerCodec::toIntegers(const float *samples, int numSamples) {
+  // The smallest power of two every sample is a whole multiple of
+  int shift = 0;
+  bool scalable = true;
+  for (int i = 0; i < numSamples && scalable; ++i) {
+    const auto sampleBits = bitsOf(samples[i]);
+    const auto magnitude = sampleBits & 0x7fffffffu;
+    const int exponent = static_cast<int>(magnitude >> 23);
+
+    // Negative zero, infinities and NaNs keep their bits
+    if (magnitude == 0) {
+      scalable = sampleBits == 0;
+      continue;
+    }
+    if (exponent == 0xff) {
+      scalable = false;
+      continue;
+    }
+
+    auto mantissa = magnitude & 0x7fffffu;
+    if (exponent > 0)
+      mantissa |= 0x800000u;
+    const int trailingZeros =
+        juce::countNumberOfBits((mantissa & (0u - mantissa)) - 1u);
+    const int lowestBit = juce::jmax(exponent, 1) - 150 + trailingZeros;
+    shift = juce::jmax(shift, -lowestBit);
+  }
+
+  if (scalable) {
+    // The loudest sample must still fit once scaled. Check before
+    // converting: casting a double out of int32 range is undefined.
+    const double scale = std::ldexp(1.0, shift);
+    for (int i = 0; i < numSamples && scalable; ++i) {
+      const double scaled = static_cast<double>(samples[i]) * scale;
+      scalable = std::abs(scaled) < 1073741824.0;
+      if (scalable)
+        values[static_cast<size_t>(i)] =
+            static_cast<juce::uint32>(static_cast<juce::int32>(scaled));
+    }
+    if (scalable)
+      return static_cast<juce::uint8>(shift);
+  }
+
+  for (int i = 0; i < numSamples; ++i)
+    values[static_cast<size_t>(i)] = toOrdered(bitsOf(samples[i]));
+  return floatBits;
+}
+
+void LayerCodec::encodeFrame(const float *samples, int numSamples,
+                             juce::OutputStream &output) {
+  jassert(numSamples > 0 && numSamples <= maxFrameSize);
+
+  bool silent = true;
+  for (int i = 0; samples != nullptr && i < numSamples && silent; ++i)
+    silent = bitsOf(samples[i]) == 0;
+  if (silent) {
+    output.writeByte(static_cast<char>(FrameType::silent));
+    return;
+  }
+
+  const auto scale = toIntegers(samples, numSamples);
+
+  // Keep the predictor that leaves the smallest residuals
+  int order = 0;
+  juce::uint64 bestSum = 0;
+  for (int candidate = 0; candidate <= maxOrder; ++candidate) {
+    auto &orderResiduals = residuals[static_cast<size_t>(candidate)];
+    juce::uint64 sum = 0;
+    for (int i = 0; i < numSamples; ++i) {
+      const auto residual = values[static_cast<size_t>(i)] -
+                            predict(values.data(), i, candidate);
+      orderResiduals[static_cast<size_t>(i)] = zigzag(residual);
+      sum += orderResiduals[static_cast<size_t>(i)];
+    }
+    if (candidate == 0 || sum < bestSum) {
+      order = candidate;
+      bestSum = sum;
+    }
+  }
+
+  // Rice parameters near log2 of each partition's mean residual
+  const auto &best = residuals[static_cast<size_t>(order)];
+  const int numPartitions = numPartitionsFor(numSamples);
+  std::array<juce::uint8, maxPartitions> parameters{};
+  bits.clear();
+  BitWriter writer(bits);
+  for (int p = 0; p < numPartitions; ++p) {
+    const int start = p * partitionSize;
+    const int end = juce::jmin(numSamples, start + partitionSize);
+    juce::uint64 sum = 0;
+    for (int i = start; i < end; ++i)
+      sum += best[static_cast<size_t>(i)];
+
+    if (sum == 0) {
+      parameters[static_cast<size_t>(p)] = zeroPartition;
+      continue;
+    }
+
+    const auto count = static_cast<juce::uint64>(end - start);
+    int k = 0;
+    while (k < 30 && (count << (k + 1)) <= sum)
+      ++k;
+    parameters[static_cast<size_t>(p)] = static_cast<juce::uint8>(k);
+
+    for (int i = start; i < end; ++i) {
+      const auto value = best[static_cast<size_t>(i)];
+      const auto quotient = value >> k;
+      if (quotient < static_cast<juce::uint32>(escapeQuotient)) {
+        const int unaryBits = static_cast<int>(quotient) + 1;
+        writer.write(((1u << quotient) - 1u) << 1, unaryBits);
+        if (k > 0)
+          writer.write(value & ((1u << k) - 1u), k);
+      } else {
+        writer.write((1u << escapeQuotient) - 1u, escapeQuotient);
+        writer.write(value, 32);
+      }
+    }
+  }
+  writer.flush();
+
+  const size_t predictedSize = 3 + static_cast<size_t>(numPartitions) +
+                               sizeof(juce::uint32) + bits.size();
+  const size_t verbatimSize =
+      1 + sizeof(float) * static_cast<size_t>(numSamples);
+
+  if (predictedSize >= verbatimSize) {
+    output.writeByte(static_cast<char>(FrameType::verbatim));
+    for (int i = 0; i < numSamples; ++i)
+      output.writeFloat(samples[i]);
+    return;
+  }
+
+  output.writeByte(static_cast<char>(FrameType::predicted));
+  output.writeByte(static_cast<char>(scale));
+  output.writeByte(static_cast<char>(order));
+  output.write(parameters.data(), static_cast<size_t>(numPartitions));
+  output.writeInt(static_cast<int>(bits.size()));
+  output.write(bits.data(), bits.size());
+}
+
+LayerCodec::FrameType LayerCodec::peekFrameType(juce::InputStream &input) {
+  const auto position = input.getPosition();
+  const auto type = static_cast<FrameType>(input.readByte());
+  input.setPosition(position);
+  return type;
+}
+
+bool LayerCodec::decodeFrame(juce::InputStream &input, int numSamples,
+                             float *dest) {
+  if (numSamples <= 0 || numSamples > maxFrameSize || input.isExhausted())
+    return false;
+
+  if (dest == nullptr) {
+    discard.resize(maxFrameSize);
+    dest = discard.data();
+  }
+
+  const auto type = static_cast<FrameType>(input.readByte());
+  if (type == FrameType::silent) {
+    std::fill(dest, dest + numSamples, 0.0f);
+    return true;
+  }
+
+  if (type == FrameType::verbatim) {
+    const int numBytes =
+        static_cast<int>(sizeof(float) * static_cast<size_t>(numSamples));
+    if (input.read(dest, numBytes) != numBytes)
+      return false;
+#if JUCE_BIG_ENDIAN
+    for (int i = 0; i < numSamples; ++i)
+      dest[i] = juce::ByteOrder::swapIfBigEndian(dest[i]);
+#endif
+    return true;
+  }
+
+  if (type != FrameType::predicted)
+    return false;
+
+  const auto scale = static_cast<juce::uint8>(input.readByte());
+  const int order = input.readByte();
+  const int numPartitions = numPartitionsFor(numSamples);
+  std::array<juce::uint8, maxPartitions> parameters{};
+  if (order < 0 || order > maxOrder ||
+      input.read(parameters.data(), numPartitions) != numPartitions)
+    return false;
+
+  // Every residual escaped is as large as a frame gets
+  const auto numBytes = static_cast<juce::uint32>(input.readInt());
+  const auto maxBytes = static_cast<juce::uint32>(
+      numSamples * (escapeQuotient + 32) / 8 + 8);
+  if (numBytes > maxBytes)
+    return false;
+  bits.resize(numBytes);
+  if (input.read(bits.data(), static_cast<int>(numBytes)) !=
+      static_cast<int>(numBytes))
+    return false;
+
+  BitReader reader(bits.data(), bits.size());
+  for (int p = 0; p < numPartitions; ++p) {
+    const int k = parameters[static_cast<size_t>(p)];
+    const int start = p * partitionSize;
+    const int end = juce::jmin(numSamples, start + partitionSize);
+    if (k != zeroPartition && k > 30)
+      return false;
+
+    for (int i = start; i < end; ++i) {
+      juce::uint32 value = 0;
+      if (k != zeroPartition) {
+        const int quotient = reader.readUnary(escapeQuotient);
+        value = quotient == escapeQuotient
+                    ? reader.read(32)
+                    : (static_cast<juce::uint32>(quotient) << k) |
+                          reader.read(k);
+      }
+      values[static_cast<size_t>(i)] =
+          unzigzag(value) + predict(values.data(), i, order);
+    }
+  }
+  if (reader.hasOverrun())
+    return false;
+
+  if (scale == floatBits) {
+    for (int i = 0; i < numSamples; ++i)
+      dest[i] = floatOf(toOrdered(values[static_cast<size_t>(i)]));
+  } else {
+    const double unscale = std::ldexp(1.0, -static_cast<int>(scale));
+    for (int i = 0; i < numSamples; ++i)
+      dest[i] = static_cast<float>(
+          static_cast<juce::int32>(values[static_cast<size_t>(i)]) *
+          unscale);
+  }
+  return true;
+}
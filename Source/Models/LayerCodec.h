@@ -0,0 +1,88 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <juce_core/juce_core.h>
+#include <vector>
+
+/**
+ * LayerCodec - Lossless compression for saved layer audio
+ *
+ * A channel is coded in frames of up to maxFrameSize samples, each decodable
+ * on its own:
+ *   silent     every sample +0.0f; just the frame type
+ *   verbatim   little-endian float32, when nothing else is smaller
+ *   predicted  samples turned into integers, predicted from the one or two
+ *              before them (FLAC's fixed predictors of order 0 to 2) and the
+ *              residuals Rice-coded in partitions of partitionSize samples.
+ *              A partition of zero residuals, as in a run of silence, costs
+ *              only its parameter byte.
+ *
+ * Frames whose samples are all multiples of a common power of two, as
+ * audio from a 16 or 24-bit converter is, are coded as those multiples.
+ * Other frames code each float's bits mapped to an order-preserving integer.
+ * Decoding restores the exact bits of every sample either way, negative
+ * zeros and NaNs included.
+ *
+ * An instance keeps scratch space between frames; use one per thread.
+ */
+class LayerCodec {
+public:
+  static constexpr int maxFrameSize = 4096;
+  static constexpr int partitionSize = 256;
+
+  enum class FrameType : juce::uint8 { silent, verbatim, predicted };
+
+  LayerCodec();
+
+  // Append a frame of `numSamples` samples; null samples are silence
+  void encodeFrame(const float *samples, int numSamples,
+                   juce::OutputStream &output);
+
+  // Read a frame of `numSamples` samples into `dest`; a null `dest`
+  // discards it. Returns false if the frame is malformed.
+  bool decodeFrame(juce::InputStream &input, int numSamples, float *dest);
+
+  // The type of the next frame, leaving the stream where it was
+  static FrameType peekFrameType(juce::InputStream &input);
+
+private:
+  static constexpr int maxOrder = 2;
+  static constexpr int maxPartitions = maxFrameSize / partitionSize;
+
+  // Scale byte of a frame coding float bits rather than scaled samples
+  static constexpr juce::uint8 floatBits = 0xff;
+
+  // Rice parameter of a partition whose residuals are all zero
+  static constexpr juce::uint8 zeroPartition = 0xff;
+
+  // Quotients from here on are escaped and stored as 32 raw bits
+  static constexpr int escapeQuotient = 24;
+
+  std::vector<juce::uint32> values;
+  std::array<std::vector<juce::uint32>, maxOrder + 1> residuals;
+  std::vector<juce::uint8> bits;
+  std::vector<float> discard;
+
+  // Map samples to integers; returns the scale byte
+  juce::uint8 toIntegers(const float *samples, int numSamples);
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayerCodec)
+};
@@ -0,0 +1,222 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LayerImporter.h"
+#include <limits>
+#include <vector>
+
+namespace {
+constexpr int pollIntervalMs = 20;
+} // namespace
+
+LayerImporter::LayerImporter(std::shared_ptr<LoopPagePool> pool, int channels,
+                             Reclaimer &reclaimerToUse)
+    : pagePool(std::move(pool)), numChannels(channels),
+      reclaimer(reclaimerToUse) {
+  formats.registerBasicFormats();
+  housekeeping->addTimeSliceClient(this);
+}
+
+LayerImporter::~LayerImporter() {
+  housekeeping->removeTimeSliceClient(this);
+  delete finished.exchange(nullptr);
+}
+
+void LayerImporter::start(const juce::File &file, double sampleRate,
+                          int loopLength, int maxLength) {
+  {
+    const std::lock_guard<std::mutex> lock(jobMutex);
+    job.file = file;
+    job.sampleRate = sampleRate;
+    job.loopLength = loopLength;
+    job.maxLength = maxLength;
+    job.request = request.fetch_add(1, std::memory_order_acq_rel) + 1;
+    progress = 0.0f;
+  }
+  housekeeping->moveToFrontOfQueue(this);
+}
+
+void LayerImporter::cancel() {
+  settle(request.fetch_add(1, std::memory_order_acq_rel) + 1);
+}
+
+void LayerImporter::settle(juce::uint32 done) {
+  // Requests only move forward, even when settled out of order
+  auto current = settled.load();
+  while (current < done && !settled.compare_exchange_weak(current, done)) {
+  }
+}
+
+std::unique_ptr<LayerImporter::Result> LayerImporter::takeFinished() {
+  std::unique_ptr<Result> result(
+      finished.exchange(nullptr, std::memory_order_acquire));
+  if (result == nullptr)
+    return nullptr;
+
+  // Superseded by a later start() or cancel()
+  if (result->request != request.load()) {
+    reclaimer.retire(std::move(result));
+    return nullptr;
+  }
+
+  settle(result->request);
+  return result;
+}
+
+int LayerImporter::useTimeSlice() {
+  const auto wanted = request.load(std::memory_order_acquire);
+  if (wanted == completedRequest)
+    return pollIntervalMs;
+
+  if (inProgress == nullptr || inProgress->request != wanted) {
+    inProgress.reset();
+    Job next;
+    {
+      const std::lock_guard<std::mutex> lock(jobMutex);
+      next = job;
+    }
+
+    // Cancelled: nothing to do until the next start()
+    if (next.request != wanted) {
+      completedRequest = wanted;
+      return pollIntervalMs;
+    }
+
+    if (!begin(next)) {
+      numFailures.fetch_add(1);
+      settle(wanted);
+      completedRequest = wanted;
+      return pollIntervalMs;
+    }
+  }
+
+  // One chunk per slice, so other housekeeping isn't held up for long
+  if (decodeNext())
+    return 0;
+
+  finish();
+  completedRequest = wanted;
+  return pollIntervalMs;
+}
+
+bool LayerImporter::begin(const Job &next) {
+  reader.reset(formats.createReaderFor(next.file));
+  if (reader == nullptr || reader->sampleRate <= 0.0 ||
+      reader->lengthInSamples <= 0 || next.sampleRate <= 0.0)
+    return false;
+
+  const double fileRate = reader->sampleRate;
+  const int fileLength = static_cast<int>(juce::jmin<juce::int64>(
+      reader->lengthInSamples, std::numeric_limits<int>::max()));
+
+  targetRate = next.sampleRate;
+  int length = next.loopLength;
+  if (length <= 0)
+    length = juce::jmin(
+        Resampler::convertLength(fileLength, fileRate, targetRate),
+        next.maxLength);
+  sourceLength = fileRate == targetRate
+                     ? length
+                     : Resampler::convertLength(length, targetRate, fileRate);
+  if (length <= 0 || sourceLength <= 0)
+    return false;
+
+  readLength = juce::jmin(sourceLength, fileLength);
+  fitted = sourceLength != fileLength;
+  position = 0;
+
+  inProgress = std::make_unique<Result>();
+  inProgress->request = next.request;
+  inProgress->layer =
+      std::make_unique<LoopLayer>(pagePool, numChannels, length);
+  inProgress->layer->length = length;
+  inProgress->layer->sampleRate = targetRate;
+
+  // At the looper's rate the chunks go straight into the pages; otherwise
+  // the span is gathered, padding included, to be resampled as a loop
+  if (fileRate == targetRate) {
+    chunk.setSize(numChannels, chunkSize, false, false, true);
+    source.setSize(0, 0);
+  } else {
+    source.setSize(numChannels, sourceLength, false, true, false);
+  }
+  return true;
+}
+
+bool LayerImporter::decodeNext() {
+  const int len = juce::jmin(chunkSize, readLength - position);
+  if (len > 0 && source.getNumSamples() > 0) {
+    reader->read(&source, position, len, position, true, true);
+  } else if (len > 0) {
+    reader->read(&chunk, 0, len, position, true, true);
+    pagePool->reserve(numChannels * (LoopPagePool::pagesForSamples(len) + 1));
+    for (int channel = 0; channel < numChannels; ++channel)
+      inProgress->layer->buffer.copyFrom(channel, position,
+                                         chunk.getReadPointer(channel), len);
+  }
+
+  position += juce::jmax(0, len);
+  progress = static_cast<float>(position) /
+             static_cast<float>(juce::jmax(1, readLength));
+  return position < readLength;
+}
+
+void LayerImporter::finish() {
+  auto &layer = *inProgress->layer;
+  auto &buffer = layer.buffer;
+  const int length = layer.length;
+
+  if (source.getNumSamples() > 0) {
+    Resampler kernel(reader->sampleRate, targetRate);
+    std::vector<float> output(static_cast<size_t>(length));
+    pagePool->reserve(LoopPagePool::pagesForSamples(length) * numChannels);
+    for (int channel = 0; channel < numChannels; ++channel) {
+      kernel.processLoop(source.getReadPointer(channel), sourceLength,
+                         output.data(), length);
+      buffer.copyFrom(channel, 0, output.data(), length);
+    }
+  }
+
+  // A file cut or padded to the loop gets the same seam crossfade as a
+  // recording; one that already fits is taken as it is
+  const int fadeSamples =
+      fitted ? juce::jmin(length, static_cast<int>(targetRate *
+                                                   crossfadeSeconds))
+             : 0;
+  std::vector<float> fadeIn(static_cast<size_t>(fadeSamples));
+  for (int channel = 0; channel < numChannels && fadeSamples > 0; ++channel) {
+    buffer.copyTo(channel, 0, fadeIn.data(), fadeSamples);
+    for (int i = 0; i < fadeSamples; ++i) {
+      const float alpha =
+          static_cast<float>(i) / static_cast<float>(fadeSamples);
+      const int end = length - fadeSamples + i;
+      buffer.setSample(channel, end,
+                       buffer.getSample(channel, end) * (1.0f - alpha) +
+                           fadeIn[static_cast<size_t>(i)] * alpha);
+    }
+  }
+
+  layer.peaks.refreshAll();
+  layer.hasContent = true;
+
+  reader.reset();
+  chunk.setSize(0, 0);
+  source.setSize(0, 0);
+  progress = 1.0f;
+  delete finished.exchange(inProgress.release(), std::memory_order_acq_rel);
+}
@@ -0,0 +1,133 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Housekeeping.h"
+#include "LoopStorage.h"
+#include "Reclaimer.h"
+#include "Resampler.h"
+#include <atomic>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <memory>
+#include <mutex>
+
+/**
+ * LayerImporter - Turns an audio file into a looper layer in the background
+ *
+ * start() has the housekeeping thread decode a WAV, AIFF or FLAC file a
+ * chunk per time slice, straight into a new layer's pages when the file is
+ * at the looper's rate, or else into a buffer of the samples the layer
+ * spans, which is then resampled as one period of a loop. Only the part of
+ * the file the layer needs is read, so a long file costs no more memory or
+ * time than a loop's worth. The finished layer is handed back whole for the
+ * owning looper to add. Owner-side calls other than start() must come from
+ * the thread that adds and removes the looper's layers.
+ */
+class LayerImporter : private juce::TimeSliceClient {
+public:
+  struct Result : public Retirable {
+    std::unique_ptr<LoopLayer> layer;
+    juce::uint32 request = 0;
+  };
+
+  LayerImporter(std::shared_ptr<LoopPagePool> pagePool, int numChannels,
+                Reclaimer &reclaimer);
+  ~LayerImporter() override;
+
+  // Decode `file` into a layer of `loopLength` samples at `sampleRate`,
+  // trimming or padding it with silence; with no loop length, the layer is
+  // as long as the file, up to `maxLength`. Replaces any import in
+  // progress. Safe from any thread but the audio thread.
+  void start(const juce::File &file, double sampleRate, int loopLength,
+             int maxLength);
+
+  // Drop any import in progress (lock-free)
+  void cancel();
+
+  // True from start() until its layer has been taken or it has failed
+  bool isBusy() const { return request.load() != settled.load(); }
+
+  // Share of the file decoded so far by the import in progress
+  float getProgress() const { return progress.load(); }
+
+  // Counts imports that couldn't be read
+  int getNumFailures() const { return numFailures.load(); }
+
+  // The finished layer for the latest start(), or nullptr if not ready
+  std::unique_ptr<Result> takeFinished();
+
+private:
+  static constexpr int chunkSize = 1 << 15;
+
+  // Seam crossfade for files trimmed or padded to the loop, as recorded
+  // layers get
+  static constexpr double crossfadeSeconds = 0.01;
+
+  std::shared_ptr<LoopPagePool> pagePool;
+  const int numChannels;
+  Reclaimer &reclaimer;
+
+  // Owner -> housekeeping: the job for `request`, under jobMutex
+  struct Job {
+    juce::File file;
+    double sampleRate = 0.0;
+    int loopLength = 0;
+    int maxLength = 0;
+    juce::uint32 request = 0;
+  };
+  std::mutex jobMutex;
+  Job job;
+  std::atomic<juce::uint32> request{0};
+  std::atomic<juce::uint32> settled{0}; // latest request taken or given up
+  std::atomic<float> progress{0.0f};
+  std::atomic<int> numFailures{0};
+
+  // Housekeeping -> owner
+  std::atomic<Result *> finished{nullptr};
+
+  // Housekeeping thread only
+  juce::AudioFormatManager formats;
+  juce::uint32 completedRequest = 0;
+  std::unique_ptr<juce::AudioFormatReader> reader;
+  std::unique_ptr<Result> inProgress;
+  double targetRate = 0.0;
+  int position = 0;
+  int readLength = 0;   // samples of the file read
+  int sourceLength = 0; // samples of the file the layer spans, padding too
+  bool fitted = false;  // trimmed or padded to the loop
+  juce::AudioBuffer<float> chunk, source;
+
+  juce::SharedResourcePointer<HousekeepingThread> housekeeping;
+
+  int useTimeSlice() override;
+
+  // Mark requests up to `done` as no longer busy
+  void settle(juce::uint32 done);
+
+  // Open the file and size the layer; false if it can't be read
+  bool begin(const Job &next);
+
+  // Decode the next chunk; false once the layer's span has been read
+  bool decodeNext();
+
+  // Resample if needed, smooth the seam and hand the layer back
+  void finish();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayerImporter)
+};
@@ -0,0 +1,91 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LayerPool.h"
+
+namespace {
+constexpr int refillIntervalMs = 20;
+constexpr double headroomSeconds = 2.0;
+} // namespace
+
+LayerPool::LayerPool(std::shared_ptr<LoopPagePool> pool, int channels)
+    : pagePool(std::move(pool)), numChannels(channels) {
+  housekeeping->addTimeSliceClient(this);
+}
+
+LayerPool::~LayerPool() {
+  housekeeping->removeTimeSliceClient(this);
+  drain();
+}
+
+void LayerPool::prepare(double sampleRate, int maxLoopLength) {
+  const std::lock_guard<std::mutex> lock(producerMutex);
+  drain();
+  layerCapacity.store(maxLoopLength);
+  headroomLength.store(static_cast<int>(sampleRate * headroomSeconds));
+  refill();
+}
+
+std::unique_ptr<LoopLayer> LayerPool::pop() {
+  auto layer = take();
+  if (layer != nullptr)
+    numServed.fetch_add(1);
+  else
+    numMisses.fetch_add(1);
+  return layer;
+}
+
+std::unique_ptr<LoopLayer> LayerPool::take() {
+  const auto scope = fifo.read(1);
+  if (scope.blockSize1 == 0)
+    return nullptr;
+
+  auto &slot = slots[static_cast<size_t>(scope.startIndex1)];
+  std::unique_ptr<LoopLayer> layer(slot);
+  slot = nullptr;
+  return layer;
+}
+
+int LayerPool::useTimeSlice() {
+  const std::lock_guard<std::mutex> lock(producerMutex);
+  refill();
+  return refillIntervalMs;
+}
+
+void LayerPool::refill() {
+  const int capacity = layerCapacity.load();
+  if (capacity <= 0)
+    return;
+
+  while (fifo.getFreeSpace() > 0) {
+    auto layer = std::make_unique<LoopLayer>(pagePool, numChannels, capacity);
+    const auto scope = fifo.write(1);
+    slots[static_cast<size_t>(scope.startIndex1)] = layer.release();
+  }
+
+  // Keep a full pass worth of zeroed pages on hand, or some headroom while
+  // the first loop is still being recorded and its length is unknown
+  const int expected = expectedLength.load();
+  const int stockLength = expected > 0 ? expected : headroomLength.load();
+  pagePool->reserve(LoopPagePool::pagesForSamples(stockLength) * numChannels);
+}
+
+void LayerPool::drain() {
+  while (take() != nullptr) {
+  }
+}
@@ -0,0 +1,82 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Housekeeping.h"
+#include "LoopStorage.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/**
+ * LayerPool - Ready-made layers for recording rollover
+ *
+ * A background thread keeps a few empty layers built and keeps the page pool
+ * stocked for the expected loop length, so the audio thread can start a new
+ * layer at the loop seam with a single lock-free pop.
+ *
+ * Single consumer: only the audio thread (or a thread that owns the looper
+ * while audio is stopped) may call pop().
+ */
+class LayerPool : private juce::TimeSliceClient {
+public:
+  static constexpr int depth = 2;
+
+  LayerPool(std::shared_ptr<LoopPagePool> pagePool, int numChannels);
+  ~LayerPool() override;
+
+  // Drop ready layers and rebuild them for a new sample rate and maximum
+  // loop length. Call while the audio thread is stopped.
+  void prepare(double sampleRate, int maxLoopLength);
+
+  // Loop length the next layers are expected to fill (audio-thread safe)
+  void setExpectedLength(int numSamples) { expectedLength.store(numSamples); }
+
+  // Take a ready layer, or nullptr (counted as a miss) if none is available
+  std::unique_ptr<LoopLayer> pop();
+
+  int getNumReady() const { return fifo.getNumReady(); }
+  int getNumServed() const { return numServed.load(); }
+  int getNumMisses() const { return numMisses.load(); }
+
+private:
+  std::shared_ptr<LoopPagePool> pagePool;
+  const int numChannels;
+
+  std::atomic<int> layerCapacity{0};
+  std::atomic<int> expectedLength{0};
+  std::atomic<int> headroomLength{0};
+  std::atomic<int> numServed{0};
+  std::atomic<int> numMisses{0};
+
+  // Serialises the producer side (refill vs prepare)
+  std::mutex producerMutex;
+  juce::AbstractFifo fifo{depth + 1};
+  std::array<LoopLayer *, depth + 1> slots{};
+
+  juce::SharedResourcePointer<HousekeepingThread> housekeeping;
+
+  int useTimeSlice() override;
+  std::unique_ptr<LoopLayer> take();
+  void refill();
+  void drain();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayerPool)
+};
@@ -0,0 +1,139 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LayerResampler.h"
+
+namespace {
+constexpr int pollIntervalMs = 20;
+} // namespace
+
+LayerResampler::LayerResampler(std::shared_ptr<LoopPagePool> pool,
+                               int channels, Reclaimer &reclaimerToUse,
+                               LayerFunction layerFunction)
+    : pagePool(std::move(pool)), numChannels(channels),
+      reclaimer(reclaimerToUse), layerAt(std::move(layerFunction)) {
+  housekeeping->addTimeSliceClient(this);
+}
+
+LayerResampler::~LayerResampler() {
+  housekeeping->removeTimeSliceClient(this);
+  delete finished.exchange(nullptr);
+}
+
+void LayerResampler::start(double sampleRate) {
+  targetRate.store(sampleRate);
+  request.fetch_add(1, std::memory_order_release);
+  busy.store(sampleRate > 0.0);
+  if (sampleRate > 0.0)
+    housekeeping->moveToFrontOfQueue(this);
+}
+
+std::unique_ptr<LayerResampler::Batch> LayerResampler::takeFinished() {
+  std::unique_ptr<Batch> batch(
+      finished.exchange(nullptr, std::memory_order_acquire));
+  if (batch == nullptr)
+    return nullptr;
+
+  // Superseded by a later start() or cancel()
+  if (batch->request != request.load()) {
+    reclaimer.retire(std::move(batch));
+    return nullptr;
+  }
+
+  busy.store(false);
+  return batch;
+}
+
+int LayerResampler::useTimeSlice() {
+  const auto wanted = request.load(std::memory_order_acquire);
+  if (wanted == completedRequest)
+    return pollIntervalMs;
+
+  const double sampleRate = targetRate.load();
+  if (inProgress == nullptr || inProgress->request != wanted) {
+    inProgress.reset();
+    if (sampleRate <= 0.0) {
+      completedRequest = wanted;
+      return pollIntervalMs;
+    }
+
+    inProgress = std::make_unique<Batch>();
+    inProgress->request = wanted;
+    inProgress->sampleRate = sampleRate;
+    nextIndex = 0;
+  }
+
+  // One layer per slice, so other housekeeping isn't held up for long
+  if (convertNext(*inProgress))
+    return 0;
+
+  completedRequest = wanted;
+  delete finished.exchange(inProgress.release(), std::memory_order_acq_rel);
+  return pollIntervalMs;
+}
+
+bool LayerResampler::convertNext(Batch &batch) {
+  // Keep the source layer alive while it is read
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+
+  for (;;) {
+    const auto *layer = layerAt(nextIndex);
+    if (layer == nullptr)
+      return false;
+
+    const int index = nextIndex++;
+    const double sourceRate = layer->sampleRate;
+    if (sourceRate <= 0.0 || sourceRate == batch.sampleRate)
+      continue;
+
+    const int length = layer->length;
+    const int newLength =
+        Resampler::convertLength(length, sourceRate, batch.sampleRate);
+    const int capacity =
+        newLength > 0 ? newLength
+                      : Resampler::convertLength(layer->buffer.getCapacity(),
+                                                 sourceRate, batch.sampleRate);
+
+    auto converted =
+        std::make_unique<LoopLayer>(pagePool, numChannels, capacity);
+    converted->sampleRate = batch.sampleRate;
+    converted->length = newLength;
+    converted->hasContent = layer->hasContent.load();
+
+    if (converted->hasContent && length > 0) {
+      if (kernel == nullptr || kernel->getSourceRate() != sourceRate ||
+          kernel->getTargetRate() != batch.sampleRate)
+        kernel = std::make_unique<Resampler>(sourceRate, batch.sampleRate);
+
+      pagePool->reserve(LoopPagePool::pagesForSamples(newLength) *
+                        numChannels);
+      input.resize(static_cast<size_t>(length));
+      output.resize(static_cast<size_t>(newLength));
+
+      for (int ch = 0; ch < numChannels; ++ch) {
+        layer->buffer.copyTo(ch, 0, input.data(), length);
+        kernel->processLoop(input.data(), length, output.data(), newLength);
+        converted->buffer.copyFrom(ch, 0, output.data(), newLength);
+      }
+      converted->peaks.refreshAll();
+    }
+
+    batch.entries.push_back({index, layer, std::move(converted)});
+    return true;
+  }
+}
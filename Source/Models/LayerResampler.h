@@ -0,0 +1,102 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Housekeeping.h"
+#include "LoopStorage.h"
+#include "Reclaimer.h"
+#include "Resampler.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * LayerResampler - Converts a looper's layers to a new sample rate
+ *
+ * start() has the housekeeping thread resample every layer that isn't at the
+ * target rate yet. The converted layers are handed back as one batch, so the
+ * owning looper can swap them all in at once; layers that were removed or
+ * replaced in the meantime are left alone. Owner-side calls must come from
+ * the thread that adds and removes the looper's layers.
+ */
+class LayerResampler : private juce::TimeSliceClient {
+public:
+  // The layer in slot `index`, or nullptr past the last one. Runs on the
+  // housekeeping thread with the reclaimer's readers lock held.
+  using LayerFunction = std::function<const LoopLayer *(int index)>;
+
+  struct Batch : public Retirable {
+    struct Entry {
+      int index = 0;
+      const LoopLayer *source = nullptr;
+      std::unique_ptr<LoopLayer> layer;
+    };
+
+    std::vector<Entry> entries;
+    double sampleRate = 0.0;
+    juce::uint32 request = 0;
+  };
+
+  LayerResampler(std::shared_ptr<LoopPagePool> pagePool, int numChannels,
+                 Reclaimer &reclaimer, LayerFunction layerAt);
+  ~LayerResampler() override;
+
+  // Convert the layers to `sampleRate`, dropping any conversion in progress
+  void start(double sampleRate);
+
+  // Drop any conversion in progress
+  void cancel() { start(0.0); }
+
+  // True from start() until its batch has been taken
+  bool isBusy() const { return busy.load(); }
+
+  // The finished batch for the latest start(), or nullptr if not ready
+  std::unique_ptr<Batch> takeFinished();
+
+private:
+  std::shared_ptr<LoopPagePool> pagePool;
+  const int numChannels;
+  Reclaimer &reclaimer;
+  LayerFunction layerAt;
+
+  // Owner -> housekeeping
+  std::atomic<double> targetRate{0.0};
+  std::atomic<juce::uint32> request{0};
+  std::atomic<bool> busy{false};
+
+  // Housekeeping -> owner
+  std::atomic<Batch *> finished{nullptr};
+
+  // Housekeeping thread only
+  std::unique_ptr<Batch> inProgress;
+  juce::uint32 completedRequest = 0;
+  int nextIndex = 0;
+  std::unique_ptr<Resampler> kernel;
+  std::vector<float> input, output;
+
+  juce::SharedResourcePointer<HousekeepingThread> housekeeping;
+
+  int useTimeSlice() override;
+
+  // Convert the next layer that needs it; false once every layer is done
+  bool convertNext(Batch &batch);
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayerResampler)
+};
@@ -0,0 +1,188 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LayerSum.h"
+
+namespace {
+constexpr int pollIntervalMs = 20;
+} // namespace
+
+LayerSum::LayerSum(std::shared_ptr<LoopPagePool> pool, int channels,
+                   Reclaimer &reclaimerToUse, SnapshotFunction snapshot)
+    : pagePool(std::move(pool)), numChannels(channels),
+      reclaimer(reclaimerToUse), snapshotLayers(std::move(snapshot)) {
+  housekeeping->addTimeSliceClient(this);
+}
+
+LayerSum::~LayerSum() {
+  housekeeping->removeTimeSliceClient(this);
+
+  if (subtractQueued.load()) {
+    delete subtractFrom;
+    delete subtractLayer;
+  }
+  delete result.exchange(nullptr);
+}
+
+void LayerSum::reset(int newCapacity) {
+  capacity.store(newCapacity);
+  delete result.exchange(nullptr);
+  rebuildRequested.store(false);
+
+  retireSum();
+  sum = std::make_unique<LoopLayer>(pagePool, numChannels, newCapacity);
+  sum->hasContent = true;
+  published.store(sum.get());
+}
+
+void LayerSum::removeLayer(std::unique_ptr<LoopLayer> layer,
+                           juce::uint32 generation) {
+  if (sum != nullptr && !subtractQueued.load(std::memory_order_acquire)) {
+    published.store(nullptr);
+    subtractFrom = sum.release();
+    subtractLayer = layer.release();
+    subtractGeneration = generation;
+    subtractQueued.store(true, std::memory_order_release);
+    return;
+  }
+
+  reclaimer.retire(std::move(layer));
+  invalidate();
+}
+
+void LayerSum::invalidate() {
+  retireSum();
+  rebuildRequested.store(true);
+}
+
+bool LayerSum::adoptPending(juce::uint32 generation) {
+  std::unique_ptr<Result> pending(
+      result.exchange(nullptr, std::memory_order_acquire));
+  if (pending == nullptr)
+    return false;
+
+  const bool adopted = pending->generation == generation;
+  if (adopted) {
+    retireSum();
+    sum = std::move(pending->sum);
+    published.store(sum.get());
+  } else if (sum == nullptr) {
+    // The layers changed while it was being built
+    rebuildRequested.store(true);
+  }
+
+  reclaimer.retire(std::move(pending));
+  return adopted;
+}
+
+int LayerSum::useTimeSlice() {
+  // The exact rebuild waits a slice, so the subtracted sum can play first
+  if (subtractQueued.load(std::memory_order_acquire)) {
+    runSubtraction();
+    rebuildRequested.store(true);
+    return pollIntervalMs;
+  }
+  if (rebuildRequested.exchange(false))
+    runRebuild();
+  return pollIntervalMs;
+}
+
+void LayerSum::runSubtraction() {
+  std::unique_ptr<LoopLayer> target(subtractFrom);
+  std::unique_ptr<LoopLayer> layer(subtractLayer);
+  const auto generation = subtractGeneration;
+  subtractFrom = nullptr;
+  subtractLayer = nullptr;
+  subtractQueued.store(false, std::memory_order_release);
+
+  const int length =
+      juce::jmin(target->buffer.getCapacity(), layer->buffer.getCapacity());
+
+  for (int ch = 0; ch < numChannels; ++ch) {
+    for (int pos = 0; pos < length; pos += LoopPagePool::pageSize) {
+      const float *source = layer->buffer.getReadPointer(ch, pos);
+      if (source == nullptr)
+        continue;
+
+      juce::FloatVectorOperations::subtract(
+          target->buffer.getWritePointer(ch, pos), source,
+          juce::jmin(LoopPagePool::pageSize, length - pos));
+    }
+  }
+  target->peaks.refreshAll();
+
+  publish(std::move(target), generation);
+
+  // Readers that found the layer before it was removed may still hold it
+  reclaimer.retire(std::move(layer));
+}
+
+void LayerSum::runRebuild() {
+  // Keep the snapshot's layers alive until they have been summed
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+
+  snapshot.clear();
+  juce::uint32 generation = 0;
+  if (!snapshotLayers(snapshot, generation)) {
+    rebuildRequested.store(true);
+    return;
+  }
+
+  auto newSum =
+      std::make_unique<LoopLayer>(pagePool, numChannels, capacity.load());
+  newSum->hasContent = true;
+
+  int pagesNeeded = 0;
+  for (const auto *layer : snapshot)
+    pagesNeeded = juce::jmax(pagesNeeded, layer->buffer.getNumAllocatedPages());
+  pagePool->reserve(pagesNeeded);
+
+  for (const auto *layer : snapshot) {
+    const int length = juce::jmin(newSum->buffer.getCapacity(),
+                                  layer->buffer.getCapacity());
+    for (int ch = 0; ch < numChannels; ++ch) {
+      for (int pos = 0; pos < length; pos += LoopPagePool::pageSize) {
+        if (const float *source = layer->buffer.getReadPointer(ch, pos))
+          newSum->buffer.addFrom(
+              ch, pos, source,
+              juce::jmin(LoopPagePool::pageSize, length - pos));
+      }
+    }
+  }
+  newSum->peaks.refreshAll();
+
+  publish(std::move(newSum), generation);
+}
+
+void LayerSum::publish(std::unique_ptr<LoopLayer> newSum,
+                       juce::uint32 generation) {
+  auto pending = std::make_unique<Result>();
+  pending->sum = std::move(newSum);
+  pending->generation = generation;
+
+  // Anything still waiting was never adopted and is out of date now. A
+  // reader may still be looking at it if it was shared before a removal.
+  reclaimer.retire(std::unique_ptr<Result>(
+      result.exchange(pending.release(), std::memory_order_acq_rel)));
+}
+
+void LayerSum::retireSum() {
+  published.store(nullptr);
+  if (sum != nullptr)
+    reclaimer.retire(std::move(sum));
+}
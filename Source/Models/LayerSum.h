@@ -0,0 +1,118 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Housekeeping.h"
+#include "LoopStorage.h"
+#include "Reclaimer.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * LayerSum - Running sum of a looper's layers, so playback reads one buffer
+ *
+ * The owning looper folds audio into the sum as it is recorded, so the live
+ * layer is always included, and patches it when fades rewrite a finished
+ * layer. Removing a layer can't be done in place on the audio thread, so the
+ * sum is handed to the housekeeping thread, which subtracts the layer (or
+ * rebuilds the sum from scratch) and hands it back. Until then get() returns
+ * nullptr and the looper mixes its layers directly. Subtracting leaves
+ * rounding behind, so every subtraction is followed by an exact rebuild,
+ * which replaces the subtracted sum as soon as it is adopted.
+ *
+ * Every hand-back is tagged with the looper's layer generation and is only
+ * adopted if nothing changed in the meantime. Owner-side calls must come from
+ * the thread that adds and removes the looper's layers.
+ */
+class LayerSum : private juce::TimeSliceClient {
+public:
+  // Fills `layers` with the layers to sum and `generation` with the current
+  // layer generation. Returns false if a rebuild can't run right now. Runs
+  // on the housekeeping thread with the reclaimer's readers lock held.
+  using SnapshotFunction = std::function<bool(
+      std::vector<const LoopLayer *> &layers, juce::uint32 &generation)>;
+
+  LayerSum(std::shared_ptr<LoopPagePool> pagePool, int numChannels,
+           Reclaimer &reclaimer, SnapshotFunction snapshotLayers);
+  ~LayerSum() override;
+
+  // Start over with an empty, valid sum. Call while audio is stopped.
+  void reset(int capacity);
+
+  // The sum, or nullptr while it is being rebuilt
+  LoopLayer *get() const { return sum.get(); }
+
+  // Whether get() would return a sum (safe from any thread)
+  bool isAvailable() const { return published.load() != nullptr; }
+
+  // The sum for readers on other threads, or nullptr while it is being
+  // rebuilt. Only valid while the reclaimer's readers lock is held.
+  const LoopLayer *getShared() const { return published.load(); }
+
+  // A layer was taken out: subtract it in the background (the sum takes
+  // ownership of the layer) or fall back to a full rebuild
+  void removeLayer(std::unique_ptr<LoopLayer> layer, juce::uint32 generation);
+
+  // Drop the sum and rebuild it from the layers in the background
+  void invalidate();
+
+  // Install a finished background sum if it matches `generation`; returns
+  // true if one was installed
+  bool adoptPending(juce::uint32 generation);
+
+private:
+  struct Result : public Retirable {
+    std::unique_ptr<LoopLayer> sum;
+    juce::uint32 generation = 0;
+  };
+
+  std::shared_ptr<LoopPagePool> pagePool;
+  const int numChannels;
+  Reclaimer &reclaimer;
+  SnapshotFunction snapshotLayers;
+
+  std::unique_ptr<LoopLayer> sum;
+  std::atomic<const LoopLayer *> published{nullptr};
+  std::atomic<int> capacity{0};
+
+  // Owner -> housekeeping: a subtraction, valid while subtractQueued is set
+  std::atomic<bool> subtractQueued{false};
+  LoopLayer *subtractFrom = nullptr;
+  LoopLayer *subtractLayer = nullptr;
+  juce::uint32 subtractGeneration = 0;
+
+  std::atomic<bool> rebuildRequested{false};
+
+  // Housekeeping -> owner
+  std::atomic<Result *> result{nullptr};
+
+  std::vector<const LoopLayer *> snapshot;
+
+  juce::SharedResourcePointer<HousekeepingThread> housekeeping;
+
+  int useTimeSlice() override;
+  void runSubtraction();
+  void runRebuild();
+  void publish(std::unique_ptr<LoopLayer> newSum, juce::uint32 generation);
+  void retireSum();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayerSum)
+};
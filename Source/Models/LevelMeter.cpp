@@ -0,0 +1,134 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LevelMeter.h"
+#include <cmath>
+#include <juce_dsp/juce_dsp.h>
+
+LevelMeter::Levels LevelMeter::analyse(const float *data,
+                                       int numSamples) noexcept {
+  float peak = 0.0f;
+  float sumOfSquares = 0.0f;
+  int i = 0;
+
+#if JUCE_USE_SIMD
+  using Register = juce::dsp::SIMDRegister<float>;
+  constexpr int width = static_cast<int>(Register::SIMDNumElements);
+
+  // Up to the first aligned sample one at a time, then a register at a time
+  for (; i < numSamples && !Register::isSIMDAligned(data + i); ++i) {
+    peak = juce::jmax(peak, std::abs(data[i]));
+    sumOfSquares += data[i] * data[i];
+  }
+
+  auto peaks = Register::expand(0.0f);
+  auto squares = Register::expand(0.0f);
+  for (; i + width <= numSamples; i += width) {
+    const auto samples = Register::fromRawArray(data + i);
+    peaks = Register::max(peaks, Register::abs(samples));
+    squares += samples * samples;
+  }
+
+  for (size_t lane = 0; lane < Register::SIMDNumElements; ++lane)
+    peak = juce::jmax(peak, peaks.get(lane));
+  sumOfSquares += squares.sum();
+#endif
+
+  for (; i < numSamples; ++i) {
+    peak = juce::jmax(peak, std::abs(data[i]));
+    sumOfSquares += data[i] * data[i];
+  }
+
+  return {peak, sumOfSquares};
+}
+
+void LevelMeter::prepare(double sampleRate) {
+  currentSampleRate = sampleRate;
+  coefficientBlockSize = 0;
+  reset();
+}
+
+void LevelMeter::reset() {
+  block = {};
+  meanSquare = {};
+  holdRemaining = {};
+  reading = {};
+}
+
+void LevelMeter::measure(int channel, const float *data, int numSamples,
+                         float gain) noexcept {
+  if (channel >= maxChannels || numSamples <= 0)
+    return;
+
+  const auto levels = analyse(data, numSamples);
+  auto &levelsSoFar = block[static_cast<size_t>(channel)];
+  levelsSoFar.peak = juce::jmax(levelsSoFar.peak, levels.peak * gain);
+  levelsSoFar.sumOfSquares += levels.sumOfSquares * gain * gain;
+}
+
+void LevelMeter::measure(const juce::AudioBuffer<float> &buffer) noexcept {
+  const int channels = juce::jmin(buffer.getNumChannels(), maxChannels);
+  for (int channel = 0; channel < channels; ++channel)
+    measure(channel, buffer.getReadPointer(channel), buffer.getNumSamples());
+}
+
+const MeterReading &LevelMeter::update(int numSamples) noexcept {
+  if (numSamples <= 0)
+    return reading;
+
+  if (numSamples != coefficientBlockSize) {
+    const double seconds = numSamples / currentSampleRate;
+    releaseGain = static_cast<float>(
+        std::pow(10.0, -releaseDbPerSecond * seconds / 20.0));
+    rmsCoefficient =
+        static_cast<float>(1.0 - std::exp(-seconds / rmsSeconds));
+    coefficientBlockSize = numSamples;
+  }
+
+  const int holdSamples = static_cast<int>(currentSampleRate * holdSeconds);
+  auto flush = [](float level) {
+    return level < MeterReading::silenceFloor ? 0.0f : level;
+  };
+
+  for (size_t channel = 0; channel < maxChannels; ++channel) {
+    const auto levels = block[channel];
+    block[channel] = {};
+
+    auto &peak = reading.peak[channel];
+    peak = flush(juce::jmax(levels.peak, peak * releaseGain));
+
+    auto &square = meanSquare[channel];
+    square += (levels.sumOfSquares / static_cast<float>(numSamples) - square) *
+              rmsCoefficient;
+    reading.rms[channel] = flush(std::sqrt(square));
+    if (reading.rms[channel] == 0.0f)
+      square = 0.0f; // rather than decay into denormals
+
+    auto &hold = reading.peakHold[channel];
+    if (levels.peak >= hold) {
+      hold = levels.peak;
+      holdRemaining[channel] = holdSamples;
+    } else if (holdRemaining[channel] > 0) {
+      holdRemaining[channel] -= numSamples;
+    } else {
+      hold = flush(juce::jmax(peak, hold * releaseGain));
+    }
+  }
+
+  return reading;
+}
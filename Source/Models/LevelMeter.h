@@ -0,0 +1,97 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/**
+ * MeterReading - Peak, RMS and held peak per channel, as linear gains
+ */
+struct MeterReading {
+  std::array<float, 2> peak{};
+  std::array<float, 2> rms{};
+  std::array<float, 2> peakHold{};
+
+  // Below this a meter shows nothing (-80 dB)
+  static constexpr float silenceFloor = 1.0e-4f;
+
+  // True once the held peaks of both channels have fallen to the floor
+  bool isSilent() const {
+    return peakHold[0] < silenceFloor && peakHold[1] < silenceFloor;
+  }
+};
+
+/**
+ * LevelMeter - Peak, RMS and peak-hold ballistics for a stereo signal
+ *
+ * The audio thread folds each run of samples into the meter with measure(),
+ * which reduces them with SIMD, and calls update() once per block to advance
+ * the ballistics. Peaks rise at once and fall at releaseDbPerSecond, the held
+ * peak stays put for holdSeconds before falling with them, and RMS is
+ * averaged over rmsSeconds. Doesn't allocate or lock.
+ */
+class LevelMeter {
+public:
+  static constexpr int maxChannels = 2;
+  static constexpr double holdSeconds = 1.5;
+  static constexpr double releaseDbPerSecond = 20.0;
+  static constexpr double rmsSeconds = 0.3;
+
+  struct Levels {
+    float peak = 0.0f;
+    float sumOfSquares = 0.0f;
+  };
+
+  // Largest magnitude and sum of squares of `numSamples` samples
+  static Levels analyse(const float *data, int numSamples) noexcept;
+
+  LevelMeter() = default;
+
+  // Sets the sample rate the ballistics are timed by, and resets the meter
+  void prepare(double sampleRate);
+  void reset();
+
+  // Fold a channel's samples, scaled by `gain`, into the current block
+  void measure(int channel, const float *data, int numSamples,
+               float gain = 1.0f) noexcept;
+
+  // Fold the first two channels of a buffer into the current block
+  void measure(const juce::AudioBuffer<float> &buffer) noexcept;
+
+  // Close a block of `numSamples` and advance the ballistics. With no
+  // samples the reading is left as it was.
+  const MeterReading &update(int numSamples) noexcept;
+
+  const MeterReading &getReading() const { return reading; }
+
+private:
+  double currentSampleRate = 44100.0;
+  std::array<Levels, maxChannels> block{};
+  std::array<float, maxChannels> meanSquare{};
+  std::array<int, maxChannels> holdRemaining{};
+  MeterReading reading;
+
+  // Per-block coefficients, kept for the last block size seen
+  int coefficientBlockSize = 0;
+  float releaseGain = 0.0f;
+  float rmsCoefficient = 0.0f;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeter)
+};
@@ -0,0 +1,261 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LoopStorage.h"
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+// LoopPagePool
+
+LoopPagePool::LoopPagePool() {}
+
+LoopPagePool::~LoopPagePool() {}
+
+void LoopPagePool::reserve(int pagesWanted) {
+  const std::lock_guard<std::mutex> lock(growMutex);
+  while (numFreePages.load() < pagesWanted && numSlabs.load() < maxSlabs) {
+    addSlab();
+  }
+}
+
+void LoopPagePool::addSlab() {
+  const int slabIndex = numSlabs.load();
+  auto slab = std::make_unique<Slab>();
+  const size_t slabSize =
+      static_cast<size_t>(pagesPerSlab) * static_cast<size_t>(pageStride);
+  slab->storage.reset(new float[slabSize + headerSize - 1]());
+
+  // new[] only promises the default alignment, so start at the first
+  // 64-byte boundary inside the block
+  const auto address = reinterpret_cast<std::uintptr_t>(slab->storage.get());
+  const auto padding = (alignment - address % alignment) % alignment;
+  slab->samples = slab->storage.get() + padding / sizeof(float);
+
+  for (int i = 0; i < pagesPerSlab; ++i) {
+    const int index = (slabIndex << pagesPerSlabLog2) + i;
+    float *header = slab->samples + static_cast<size_t>(i) * pageStride;
+    std::memcpy(header, &index, sizeof(index));
+
+    float *peaks = header + headerSize + pageSize;
+    for (int value = 0; value < numPeakValues; ++value)
+      new (peaks + value) std::atomic<float>(0.0f);
+  }
+
+  slabs[static_cast<size_t>(slabIndex)] = std::move(slab);
+  numSlabs.store(slabIndex + 1);
+  numPages.fetch_add(pagesPerSlab);
+
+  for (int i = 0; i < pagesPerSlab; ++i) {
+    push((slabIndex << pagesPerSlabLog2) + i);
+  }
+}
+
+float *LoopPagePool::acquire() {
+  int index = pop();
+  if (index < 0) {
+    // Out of pages: grow in place. This allocates, so callers on the audio
+    // thread should keep the pool topped up beforehand.
+    numEmergencyGrowths.fetch_add(1);
+    reserve(1);
+    index = pop();
+    if (index < 0)
+      return nullptr;
+  }
+  return pageData(index);
+}
+
+void LoopPagePool::release(float *page) {
+  if (page == nullptr)
+    return;
+  std::memset(page, 0, sizeof(float) * static_cast<size_t>(pageSize));
+  auto *peaks = getPeakBins(page);
+  for (int value = 0; value < numPeakValues; ++value)
+    peaks[value].store(0.0f, std::memory_order_relaxed);
+  push(indexOf(page));
+}
+
+int LoopPagePool::indexOf(const float *page) const {
+  int index = 0;
+  std::memcpy(&index, page - headerSize, sizeof(index));
+  return index;
+}
+
+float *LoopPagePool::pageData(int index) const {
+  auto &slab = slabs[static_cast<size_t>(index >> pagesPerSlabLog2)];
+  return slab->samples +
+         static_cast<size_t>(index & (pagesPerSlab - 1)) * pageStride +
+         headerSize;
+}
+
+std::atomic<juce::uint32> &LoopPagePool::nextOf(int index) const {
+  auto &slab = slabs[static_cast<size_t>(index >> pagesPerSlabLog2)];
+  return slab->next[static_cast<size_t>(index & (pagesPerSlab - 1))];
+}
+
+void LoopPagePool::push(int index) {
+  auto head = freeHead.load(std::memory_order_relaxed);
+  juce::uint64 newHead;
+  do {
+    nextOf(index).store(static_cast<juce::uint32>(head),
+                        std::memory_order_relaxed);
+    newHead = (((head >> 32) + 1) << 32) | static_cast<juce::uint64>(index + 1);
+  } while (!freeHead.compare_exchange_weak(head, newHead,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+  numFreePages.fetch_add(1);
+}
+
+int LoopPagePool::pop() {
+  auto head = freeHead.load(std::memory_order_acquire);
+  while (true) {
+    const auto slot = static_cast<juce::uint32>(head);
+    if (slot == 0)
+      return -1;
+
+    const int index = static_cast<int>(slot) - 1;
+    const auto next = nextOf(index).load(std::memory_order_relaxed);
+    const auto newHead = (((head >> 32) + 1) << 32) | next;
+    if (freeHead.compare_exchange_weak(head, newHead,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      numFreePages.fetch_sub(1);
+      return index;
+    }
+  }
+}
+
+// LoopBuffer
+
+LoopBuffer::LoopBuffer(std::shared_ptr<LoopPagePool> p, int channels, int cap)
+    : pool(std::move(p)), numChannels(channels), capacity(juce::jmax(0, cap)),
+      pagesPerChannel(LoopPagePool::pagesForSamples(capacity)),
+      pages(new std::atomic<float *>[static_cast<size_t>(numChannels *
+                                                          pagesPerChannel)]) {
+  for (int i = 0; i < numChannels * pagesPerChannel; ++i)
+    pages[static_cast<size_t>(i)].store(nullptr, std::memory_order_relaxed);
+}
+
+LoopBuffer::~LoopBuffer() { clear(); }
+
+const float *LoopBuffer::getReadPointer(int channel, int position) const {
+  if (!juce::isPositiveAndBelow(position, capacity))
+    return nullptr;
+  const float *page = pageAt(channel, position).load(std::memory_order_acquire);
+  return page != nullptr ? page + (position & LoopPagePool::pageMask)
+                         : nullptr;
+}
+
+std::atomic<float> *LoopBuffer::getPeakBins(int channel, int position) const {
+  if (!juce::isPositiveAndBelow(position, capacity))
+    return nullptr;
+  float *page = pageAt(channel, position).load(std::memory_order_acquire);
+  return page != nullptr ? LoopPagePool::getPeakBins(page) : nullptr;
+}
+
+float *LoopBuffer::getWritePointer(int channel, int position) {
+  if (!juce::isPositiveAndBelow(position, capacity))
+    return nullptr;
+  auto &slot = pageAt(channel, position);
+  float *page = slot.load(std::memory_order_relaxed);
+  if (page == nullptr) {
+    page = pool->acquire();
+    if (page == nullptr)
+      return nullptr;
+    slot.store(page, std::memory_order_release);
+    numAllocatedPages.fetch_add(1, std::memory_order_relaxed);
+  }
+  return page + (position & LoopPagePool::pageMask);
+}
+
+float LoopBuffer::getSample(int channel, int position) const {
+  const float *data = getReadPointer(channel, position);
+  return data != nullptr ? *data : 0.0f;
+}
+
+void LoopBuffer::setSample(int channel, int position, float value) {
+  if (float *data = getWritePointer(channel, position))
+    *data = value;
+}
+
+void LoopBuffer::copyFrom(int channel, int destPosition, const float *source,
+                          int numSamples) {
+  while (numSamples > 0) {
+    const int len = juce::jmin(numSamples, getContiguousLength(destPosition));
+    if (float *dest = getWritePointer(channel, destPosition))
+      juce::FloatVectorOperations::copy(dest, source, len);
+    destPosition += len;
+    source += len;
+    numSamples -= len;
+  }
+}
+
+void LoopBuffer::addFrom(int channel, int destPosition, const float *source,
+                         int numSamples) {
+  while (numSamples > 0) {
+    const int len = juce::jmin(numSamples, getContiguousLength(destPosition));
+    if (float *dest = getWritePointer(channel, destPosition))
+      juce::FloatVectorOperations::add(dest, source, len);
+    destPosition += len;
+    source += len;
+    numSamples -= len;
+  }
+}
+
+void LoopBuffer::copyTo(int channel, int sourcePosition, float *dest,
+                        int numSamples) const {
+  while (numSamples > 0) {
+    const int len = juce::jmin(numSamples, getContiguousLength(sourcePosition));
+    if (const float *src = getReadPointer(channel, sourcePosition))
+      juce::FloatVectorOperations::copy(dest, src, len);
+    else
+      juce::FloatVectorOperations::clear(dest, len);
+    sourcePosition += len;
+    dest += len;
+    numSamples -= len;
+  }
+}
+
+void LoopBuffer::addTo(int channel, int sourcePosition, float *dest,
+                       int numSamples) const {
+  while (numSamples > 0) {
+    const int len = juce::jmin(numSamples, getContiguousLength(sourcePosition));
+    if (const float *src = getReadPointer(channel, sourcePosition))
+      juce::FloatVectorOperations::add(dest, src, len);
+    sourcePosition += len;
+    dest += len;
+    numSamples -= len;
+  }
+}
+
+void LoopBuffer::allocateUpTo(int numSamples) {
+  const int end = juce::jmin(numSamples, capacity);
+  for (int channel = 0; channel < numChannels; ++channel) {
+    for (int pos = 0; pos < end; pos += LoopPagePool::pageSize) {
+      getWritePointer(channel, pos);
+    }
+  }
+}
+
+void LoopBuffer::clear() {
+  for (int i = 0; i < numChannels * pagesPerChannel; ++i) {
+    if (auto *page = pages[static_cast<size_t>(i)].exchange(nullptr))
+      pool->release(page);
+  }
+  numAllocatedPages.store(0);
+}
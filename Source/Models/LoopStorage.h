@@ -0,0 +1,222 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "PeakPyramid.h"
+#include "Reclaimer.h"
+#include <array>
+#include <atomic>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * LoopPagePool - Fixed-size chunks of audio shared by a looper's layers
+ *
+ * Pages are allocated in slabs and recycled through a lock-free free list, so
+ * taking or returning a page never touches the heap. Every page on the free
+ * list is zeroed, which lets a freshly acquired page stand in for silence.
+ *
+ * After its samples each page carries the PeakPyramid bins that summarise
+ * it, zeroed along with the samples, so peak data comes and goes with the
+ * audio it describes.
+ */
+class LoopPagePool {
+public:
+  static constexpr int pageSizeLog2 = 12;
+  static constexpr int pageSize = 1 << pageSizeLog2; // samples per page
+  static constexpr int pageMask = pageSize - 1;
+
+  // Min and max of every peak bin covering one page
+  static constexpr int numPeakValues = 2 * PeakPyramid::getNumBins(pageSize);
+
+  LoopPagePool();
+  ~LoopPagePool();
+
+  // Number of pages needed to hold `numSamples` samples of one channel
+  static int pagesForSamples(int numSamples) {
+    return (juce::jmax(0, numSamples) + pageMask) >> pageSizeLog2;
+  }
+
+  // Grow the pool until at least `numPages` pages are free.
+  // Allocates, so keep this off the audio thread.
+  void reserve(int numPages);
+
+  // Take a zeroed page. Lock-free while free pages remain; if the pool has
+  // run dry it falls back to growing, which allocates.
+  float *acquire();
+
+  // Zero a page and return it to the free list (lock-free)
+  void release(float *page);
+
+  int getNumFreePages() const { return numFreePages.load(); }
+  int getNumPages() const { return numPages.load(); }
+  int getNumEmergencyGrowths() const { return numEmergencyGrowths.load(); }
+
+  // The peak bins stored with a page
+  static std::atomic<float> *getPeakBins(float *page) {
+    return reinterpret_cast<std::atomic<float> *>(page + pageSize);
+  }
+
+private:
+  static constexpr int pagesPerSlabLog2 = 6;
+  static constexpr int pagesPerSlab = 1 << pagesPerSlabLog2;
+  static constexpr int maxSlabs = 4096;
+
+  // Each page is preceded by a small header holding its index, padded so the
+  // sample data stays 64-byte aligned: slabs start on a 64-byte boundary and
+  // every header and page is a whole number of 64-byte lines
+  static constexpr int alignment = 64;
+  static constexpr int headerSize = alignment / static_cast<int>(sizeof(float));
+  static constexpr int peakStride =
+      (numPeakValues + headerSize - 1) / headerSize * headerSize;
+  static constexpr int pageStride = headerSize + pageSize + peakStride;
+  static_assert(pageSize % headerSize == 0,
+                "Pages must keep the sample data aligned");
+  static_assert(sizeof(std::atomic<float>) == sizeof(float) &&
+                    std::atomic<float>::is_always_lock_free,
+                "Peak bins are kept in the page's float storage");
+
+  struct Slab {
+    std::unique_ptr<float[]> storage; // over-allocated to align `samples`
+    float *samples = nullptr;         // the first header, 64-byte aligned
+    std::array<std::atomic<juce::uint32>, pagesPerSlab> next{};
+  };
+
+  // Free list head: high 32 bits are an ABA tag, low 32 bits are
+  // (page index + 1), with 0 meaning empty
+  std::atomic<juce::uint64> freeHead{0};
+  std::atomic<int> numFreePages{0};
+  std::atomic<int> numPages{0};
+  std::atomic<int> numEmergencyGrowths{0};
+
+  std::mutex growMutex;
+  std::array<std::unique_ptr<Slab>, maxSlabs> slabs;
+  std::atomic<int> numSlabs{0};
+
+  void addSlab();
+  int indexOf(const float *page) const;
+  float *pageData(int index) const;
+  std::atomic<juce::uint32> &nextOf(int index) const;
+  void push(int index);
+  int pop();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopPagePool)
+};
+
+/**
+ * LoopBuffer - Multi-channel loop audio stored as pages from a LoopPagePool
+ *
+ * The page table covers the whole capacity, but pages are only taken from
+ * the pool when something is written to them, so memory follows the audio
+ * actually recorded. Unwritten regions read back as silence.
+ *
+ * One thread writes; others may read concurrently and see either silence or
+ * the page as it is being filled.
+ */
+class LoopBuffer {
+public:
+  LoopBuffer(std::shared_ptr<LoopPagePool> pool, int numChannels,
+             int capacity);
+  ~LoopBuffer();
+
+  int getNumChannels() const { return numChannels; }
+  int getCapacity() const { return capacity; }
+  int getNumAllocatedPages() const { return numAllocatedPages.load(); }
+
+  // Samples from `position` to the end of its page
+  static int getContiguousLength(int position) {
+    return LoopPagePool::pageSize - (position & LoopPagePool::pageMask);
+  }
+
+  // Page data at `position`, or nullptr if that page is still silent
+  const float *getReadPointer(int channel, int position) const;
+
+  // Page data at `position`, taking a page from the pool if needed
+  float *getWritePointer(int channel, int position);
+
+  // The peak bins of the page at `position`, or nullptr if that page is
+  // still silent. Only PeakPyramid should use these.
+  std::atomic<float> *getPeakBins(int channel, int position) const;
+
+  float getSample(int channel, int position) const;
+  void setSample(int channel, int position, float value);
+
+  // Range operations (may span pages)
+  void copyFrom(int channel, int destPosition, const float *source,
+                int numSamples);
+  void addFrom(int channel, int destPosition, const float *source,
+               int numSamples);
+  void copyTo(int channel, int sourcePosition, float *dest,
+              int numSamples) const;
+  void addTo(int channel, int sourcePosition, float *dest,
+             int numSamples) const;
+
+  // Take pages up front for [0, numSamples) on every channel
+  void allocateUpTo(int numSamples);
+
+  // Return every page to the pool
+  void clear();
+
+private:
+  std::shared_ptr<LoopPagePool> pool;
+  int numChannels = 0;
+  int capacity = 0;
+  int pagesPerChannel = 0;
+  std::atomic<int> numAllocatedPages{0};
+  // [channel * pagesPerChannel + page]
+  std::unique_ptr<std::atomic<float *>[]> pages;
+
+  std::atomic<float *> &pageAt(int channel, int position) const {
+    return pages[static_cast<size_t>(channel * pagesPerChannel +
+                                     (position >> LoopPagePool::pageSizeLog2))];
+  }
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopBuffer)
+};
+
+/**
+ * LoopLayer - One recorded pass of a loop (an overdub layer)
+ *
+ * Whoever writes the buffer refreshes the matching range of `peaks`.
+ *
+ * Once `hasContent` is set and `revision` is even the audio is final. While
+ * it is recorded, samples from `recordStart` up to `recorded` past it are
+ * written and stay put until the layer is finalized, which rewrites the
+ * seams with `revision` odd.
+ *
+ * `serial` tells layers apart across every looper; a layer keeps it for as
+ * long as it is in one, through resampling too.
+ */
+struct LoopLayer : public Retirable {
+  LoopLayer(std::shared_ptr<LoopPagePool> pool, int numChannels, int capacity)
+      : buffer(std::move(pool), numChannels, capacity), peaks(buffer) {}
+
+  LoopBuffer buffer;
+  PeakPyramid peaks;
+  std::atomic<int> length{0};
+  std::atomic<bool> hasContent{false};
+  double sampleRate = 0.0; // set before the layer is shared
+  juce::uint32 serial = 0; // likewise
+
+  std::atomic<int> recordStart{0};
+  std::atomic<int> recorded{0};
+  std::atomic<juce::uint32> revision{0};
+};
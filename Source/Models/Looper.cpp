@@ -17,40 +17,65 @@
  */
 
 #include "Looper.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace {
+// Shared by every looper, so no two layers ever have the same serial
+std::atomic<juce::uint32> nextLayerSerial{1};
+} // namespace
+
+Looper::Looper() {
+  mixBus.setSize(numChannels, mixChunkSize);
+  fadeScratch.resize(
+      static_cast<size_t>(currentSampleRate * crossfadeSeconds) + 1);
+  layerPool.prepare(currentSampleRate, maxLoopLength);
+  layerSum.reset(maxLoopLength);
+}
 
-Looper::Looper() {}
-
-Looper::~Looper() {}
+Looper::~Looper() { clearAll(); }
 
 void Looper::prepare(double sampleRate) {
   currentSampleRate = sampleRate;
-  maxLoopLength = static_cast<int>(sampleRate * 60.0);
-
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  loops.clear();
-  recordingLoopIndex = -1;
-  playing = false;
+  maxLoopLength = static_cast<int>(sampleRate * maxLoopSeconds);
+
+  fadeScratch.resize(static_cast<size_t>(sampleRate * crossfadeSeconds) + 1);
+  meter.prepare(sampleRate);
+  layerPool.prepare(sampleRate, maxLoopLength);
+  layerSum.reset(maxLoopLength);
+
+  // Keep the loops; any recorded at another rate are converted in the
+  // background and play again once they have all been swapped in
+  if (hasLoops()) {
+    ++layerGeneration;
+    layerSum.invalidate();
+    resampler.start(sampleRate);
+  }
 }
 
 void Looper::startRecording(int currentReadPosition, int loopLength) {
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  addNewLoop();
-  recordingLoopIndex = static_cast<int>(loops.size()) - 1;
+  layerPool.setExpectedLength(loopLength);
+  const int index = appendLoop(takeLayer(loopLength));
+  if (index == -1)
+    return;
+
   currentLoopSamples = 0;
+  recordingLoopIndex = index;
+  ++layerGeneration;
 }
 
 void Looper::stopRecording(int loopLength) {
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  if (recordingLoopIndex != -1) {
-    auto &loop = loops[static_cast<size_t>(recordingLoopIndex)];
-
-    if (currentLoopSamples > 0) {
-      loop->hasContent = true;
-      loop->length = loopLength > 0 ? loopLength : currentLoopSamples;
-      applyFadeOut(recordingLoopIndex);
-      applyCrossfade(recordingLoopIndex);
-    }
+  const int index = recordingLoopIndex.load();
+  if (index != -1) {
+    auto &loop = *loopAt(index);
+
+    if (currentLoopSamples > 0)
+      finalizeLayer(loop,
+                    loopLength > 0 ? loopLength : currentLoopSamples.load(),
+                    true);
+    ++layerGeneration;
   }
   recordingLoopIndex = -1;
 }
@@ -59,42 +84,80 @@ void Looper::startPlayback() { playing = true; }
 
 void Looper::stopPlayback() { playing = false; }
 
-void Looper::addNewLoop() {
-  auto newLoop = std::make_unique<Loop>();
-  newLoop->buffer.setSize(numChannels, maxLoopLength);
-  newLoop->buffer.clear();
-  newLoop->length = 0;
-  newLoop->hasContent = false;
-  loops.push_back(std::move(newLoop));
+void Looper::addNewLoop(int loopLength) { appendLoop(createLayer(loopLength)); }
+
+std::unique_ptr<Looper::Loop> Looper::takeLayer(int loopLength) {
+  if (auto layer = layerPool.pop()) {
+    layer->sampleRate = currentSampleRate;
+    return layer;
+  }
+  return createLayer(loopLength);
 }
 
-void Looper::removeLastLoop() {
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  removeLastLoopInternal();
+std::unique_ptr<Looper::Loop> Looper::createLayer(int loopLength) {
+  const int capacity =
+      loopLength > 0 ? juce::jmin(loopLength, maxLoopLength) : maxLoopLength;
+
+  // Stock enough pages for one full pass of the loop. The first recording has
+  // no length yet, so start with a few seconds and let the pool grow.
+  const int expectedLength =
+      loopLength > 0 ? capacity
+                     : static_cast<int>(currentSampleRate * initialPageSeconds);
+  pagePool->reserve(LoopPagePool::pagesForSamples(expectedLength) *
+                    numChannels);
+
+  auto layer = std::make_unique<Loop>(pagePool, numChannels, capacity);
+  layer->sampleRate = currentSampleRate;
+  return layer;
 }
 
-void Looper::clearAll() {
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  clearAllInternal();
+int Looper::appendLoop(std::unique_ptr<Loop> loop) {
+  const int index = numLoops.load();
+  if (index >= maxLayers) {
+    reclaimer.retire(std::move(loop));
+    return -1;
+  }
+
+  loop->serial = nextLayerSerial.fetch_add(1, std::memory_order_relaxed);
+  loops[static_cast<size_t>(index)].store(loop.release(),
+                                          std::memory_order_release);
+  numLoops.store(index + 1, std::memory_order_release);
+  return index;
 }
 
-void Looper::removeLastLoopInternal() {
-  if (!loops.empty()) {
-    if (recordingLoopIndex == static_cast<int>(loops.size()) - 1) {
-      recordingLoopIndex = -1;
-    }
-    loops.pop_back();
+void Looper::removeLastLoop() {
+  const int count = numLoops.load();
+  if (count == 0)
+    return;
+
+  if (recordingLoopIndex.load() == count - 1) {
+    recordingLoopIndex = -1;
   }
+  numLoops.store(count - 1, std::memory_order_release);
+  std::unique_ptr<Loop> loop(loops[static_cast<size_t>(count - 1)].exchange(
+      nullptr, std::memory_order_acq_rel));
+  ++layerGeneration;
+
+  // Never free the layer here, which may be the audio thread: the layer sum
+  // takes it and subtracts it in the background
+  layerSum.removeLayer(std::move(loop), layerGeneration.load());
 }
 
-void Looper::clearAllInternal() {
-  loops.clear();
+void Looper::clearAll() {
   recordingLoopIndex = -1;
+  const int count = numLoops.exchange(0);
+  for (int i = 0; i < count; ++i) {
+    reclaimer.retire(std::unique_ptr<Loop>(
+        loops[static_cast<size_t>(i)].exchange(nullptr)));
+  }
+  ++layerGeneration;
+  layerSum.invalidate();
+  resampler.cancel();
+  importer.cancel();
 }
 
 void Looper::processRecording(const juce::AudioBuffer<float> &inputBuffer,
                               int maxRecordLength, int currentPosition) {
-  std::lock_guard<std::mutex> lock(loopsMutex);
   if (recordingLoopIndex == -1) {
     return;
   }
@@ -104,8 +167,7 @@ void Looper::processRecording(const juce::AudioBuffer<float> &inputBuffer,
   int remaining = numSamples;
 
   while (remaining > 0 && recordingLoopIndex != -1) {
-    int idx = recordingLoopIndex;
-    auto &loop = loops[static_cast<size_t>(idx)];
+    auto *loop = loopAt(recordingLoopIndex);
 
     int space = maxRecordLength - currentLoopSamples;
     int toWrite = juce::jmin(remaining, space);
@@ -114,32 +176,47 @@ void Looper::processRecording(const juce::AudioBuffer<float> &inputBuffer,
       int writePos = (currentPosition + offset) % maxRecordLength;
       int firstLen = juce::jmin(toWrite, maxRecordLength - writePos);
 
+      if (currentLoopSamples == 0)
+        loop->recordStart.store(writePos);
+
+      auto *sum = layerSum.get();
       for (int channel = 0; channel < numChannels; ++channel) {
-        loop->buffer.copyFrom(channel, writePos, inputBuffer, channel, offset,
-                              firstLen);
+        const float *input = inputBuffer.getReadPointer(channel, offset);
+        loop->buffer.copyFrom(channel, writePos, input, firstLen);
+        if (sum != nullptr)
+          sum->buffer.addFrom(channel, writePos, input, firstLen);
       }
+      refreshPeaks(*loop, writePos, firstLen);
       currentLoopSamples += firstLen;
+      loop->recorded.store(currentLoopSamples, std::memory_order_release);
       offset += firstLen;
       remaining -= firstLen;
 
       if (writePos + firstLen >= maxRecordLength) {
         // Reached cycle boundary (position 0) — finalize and start a new loop
-        loop->hasContent = true;
-        loop->length = maxRecordLength;
-        applyCrossfade(idx);
-
-        addNewLoop();
-        recordingLoopIndex = static_cast<int>(loops.size()) - 1;
+        finalizeLayer(*loop, maxRecordLength, false);
+
+        // Take a ready-made layer; only fall back to building one here
+        // (which allocates) if the pool has run dry. Out of layer slots,
+        // recording simply stops.
+        layerPool.setExpectedLength(maxRecordLength);
+        const int next = appendLoop(takeLayer(maxRecordLength));
+        recordingLoopIndex = next;
         currentLoopSamples = 0;
+        ++layerGeneration;
 
-        if (firstLen < toWrite) {
+        if (next != -1 && firstLen < toWrite) {
           int secondLen = toWrite - firstLen;
-          auto &newLoop = loops[static_cast<size_t>(recordingLoopIndex)];
+          auto *newLoop = loopAt(next);
           for (int channel = 0; channel < numChannels; ++channel) {
-            newLoop->buffer.copyFrom(channel, 0, inputBuffer, channel, offset,
-                                     secondLen);
+            const float *input = inputBuffer.getReadPointer(channel, offset);
+            newLoop->buffer.copyFrom(channel, 0, input, secondLen);
+            if (sum != nullptr)
+              sum->buffer.addFrom(channel, 0, input, secondLen);
           }
+          refreshPeaks(*newLoop, 0, secondLen);
           currentLoopSamples = secondLen;
+          newLoop->recorded.store(secondLen, std::memory_order_release);
           offset += secondLen;
           remaining -= secondLen;
         }
@@ -150,143 +227,533 @@ void Looper::processRecording(const juce::AudioBuffer<float> &inputBuffer,
 
 void Looper::processPlayback(juce::AudioBuffer<float> &outputBuffer,
                              float volume, int readPosition, int loopLength) {
-  if (!playing || loopLength <= 0)
+  if (!playing || loopLength <= 0 || resampler.isBusy())
     return;
 
   const int numSamples = outputBuffer.getNumSamples();
+  const int channelsToMix =
+      juce::jmin(numChannels, outputBuffer.getNumChannels());
 
-  std::lock_guard<std::mutex> lock(loopsMutex);
-
-  if (loops.empty())
+  const int count = numLoops.load(std::memory_order_acquire);
+  const int recordingIndex = recordingLoopIndex.load();
+  if (count == 0)
     return;
 
-  for (int sample = 0; sample < numSamples; ++sample) {
-    int pos = readPosition + sample;
-    if (pos >= loopLength)
-      pos = pos % loopLength;
-
-    for (int channel = 0; channel < numChannels; ++channel) {
-      float mixedSample = 0.0f;
-
-      for (size_t li = 0; li < loops.size(); ++li) {
-        auto &loop = loops[li];
-        bool isRecordingLoop = (static_cast<int>(li) == recordingLoopIndex);
-        if (!loop->hasContent && !isRecordingLoop)
-          continue;
+  // The running sum already holds every layer, the live one included. While
+  // it is being rebuilt after an undo or clear, mix the layers directly.
+  const auto *sum = layerSum.get();
 
-        mixedSample += loop->buffer.getSample(channel, pos);
+  // Walk the block as contiguous runs of the loop: at most two per block
+  // (before and after the wrap point) unless the loop is shorter than the
+  // block, and each run is capped to the scratch bus size.
+  int offset = 0;
+  int pos = readPosition % loopLength;
+  while (offset < numSamples) {
+    const int len = juce::jmin(numSamples - offset, loopLength - pos,
+                               mixChunkSize);
+
+    for (int channel = 0; channel < channelsToMix; ++channel) {
+      float *bus = mixBus.getWritePointer(channel);
+      juce::FloatVectorOperations::clear(bus, len);
+
+      if (sum != nullptr) {
+        sum->buffer.addTo(channel, pos, bus, len);
+      } else {
+        for (int li = 0; li < count; ++li) {
+          auto *loop = loopAt(li);
+          if (loop == nullptr || (!loop->hasContent && li != recordingIndex))
+            continue;
+
+          loop->buffer.addTo(channel, pos, bus, len);
+        }
       }
 
-      outputBuffer.addSample(channel, sample, std::tanh(mixedSample) * volume);
+      for (int i = 0; i < len; ++i)
+        bus[i] = std::tanh(bus[i]);
+      meter.measure(channel, bus, len, volume);
+
+      juce::FloatVectorOperations::addWithMultiply(
+          outputBuffer.getWritePointer(channel, offset), bus, volume, len);
     }
+
+    offset += len;
+    pos += len;
+    if (pos >= loopLength)
+      pos = 0;
   }
 }
 
-void Looper::applyCrossfade(int loopIndex) {
-  if (loopIndex < 0 || loopIndex >= static_cast<int>(loops.size()))
-    return;
-
-  auto &loop = loops[static_cast<size_t>(loopIndex)];
+void Looper::finalizeLayer(Loop &loop, int length, bool fadeOutGap) {
+  loop.revision.fetch_add(1);
+  loop.hasContent = true;
+  loop.length = length;
+  if (fadeOutGap)
+    applyFadeOut(loop);
+  applyCrossfade(loop);
+  loop.revision.fetch_add(1);
+}
 
-  int fadeSamples = juce::jmin(loop->length, (int)(currentSampleRate * 0.01));
+void Looper::applyCrossfade(Loop &loop) {
+  const int length = loop.length;
+  int fadeSamples =
+      juce::jmin(length, static_cast<int>(currentSampleRate * crossfadeSeconds));
 
   if (fadeSamples > 0) {
-    for (int channel = 0; channel < loop->buffer.getNumChannels(); ++channel) {
-      auto *channelData = loop->buffer.getWritePointer(channel);
-
+    auto &buffer = loop.buffer;
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
       // Copy the fade-in region before writing — the read/write ranges may
-      // overlap when loop->length < 2*fadeSamples, corrupting the source.
-      std::vector<float> fadeIn(channelData, channelData + fadeSamples);
+      // overlap when loop.length < 2*fadeSamples, corrupting the source.
+      float *fadeIn = fadeScratch.data();
+      buffer.copyTo(channel, 0, fadeIn, fadeSamples);
 
       for (int i = 0; i < fadeSamples; ++i) {
         float alpha = static_cast<float>(i) / static_cast<float>(fadeSamples);
-        int endSampleIdx = loop->length - fadeSamples + i;
-        channelData[endSampleIdx] =
-            channelData[endSampleIdx] * (1.0f - alpha) + fadeIn[i] * alpha;
+        int endSampleIdx = length - fadeSamples + i;
+        replaceSample(loop, channel, endSampleIdx,
+                      buffer.getSample(channel, endSampleIdx) *
+                              (1.0f - alpha) +
+                          fadeIn[i] * alpha);
       }
     }
+    refreshPeaks(loop, length - fadeSamples, fadeSamples);
   }
 }
 
-void Looper::applyFadeOut(int loopIndex) {
-  if (loopIndex < 0 || loopIndex >= static_cast<int>(loops.size()))
-    return;
-
-  auto &loop = loops[static_cast<size_t>(loopIndex)];
-
+void Looper::applyFadeOut(Loop &loop) {
   int actualSamples = currentLoopSamples;
-  if (actualSamples >= loop->length)
+  if (actualSamples >= loop.length)
     return;
 
-  int fadeSamples =
-      juce::jmin(actualSamples, (int)(currentSampleRate * 0.01));
+  int fadeSamples = juce::jmin(
+      actualSamples, static_cast<int>(currentSampleRate * crossfadeSeconds));
 
   if (fadeSamples > 0) {
-    for (int channel = 0; channel < loop->buffer.getNumChannels(); ++channel) {
-      auto *channelData = loop->buffer.getWritePointer(channel);
-      int fadeStart = actualSamples - fadeSamples;
+    auto &buffer = loop.buffer;
+    int fadeStart = actualSamples - fadeSamples;
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
       for (int i = 0; i < fadeSamples; ++i) {
         float alpha = static_cast<float>(i) / static_cast<float>(fadeSamples);
-        channelData[fadeStart + i] *= (1.0f - alpha);
+        replaceSample(loop, channel, fadeStart + i,
+                      buffer.getSample(channel, fadeStart + i) *
+                          (1.0f - alpha));
       }
     }
+    refreshPeaks(loop, fadeStart, fadeSamples);
   }
 }
 
+void Looper::replaceSample(Loop &loop, int channel, int position,
+                           float value) {
+  const float delta = value - loop.buffer.getSample(channel, position);
+  loop.buffer.setSample(channel, position, value);
+
+  if (auto *sum = layerSum.get())
+    sum->buffer.setSample(channel, position,
+                          sum->buffer.getSample(channel, position) + delta);
+}
+
+void Looper::refreshPeaks(Loop &loop, int position, int numSamples) {
+  auto *sum = layerSum.get();
+  for (int channel = 0; channel < numChannels; ++channel) {
+    loop.peaks.refresh(channel, position, numSamples);
+    if (sum != nullptr)
+      sum->peaks.refresh(channel, position, numSamples);
+  }
+  peaksGeneration.fetch_add(1, std::memory_order_release);
+}
+
 void Looper::requestClearAll() { requestClear.store(true); }
 
 void Looper::requestUndoLast() { requestUndo.store(true); }
 
-void Looper::handlePendingRequests() {
+void Looper::importLayer(const juce::File &file, int loopLength) {
+  importer.start(file, currentSampleRate, loopLength, maxLoopLength);
+}
+
+int Looper::handlePendingRequests() {
   if (requestClear.exchange(false)) {
-    std::lock_guard<std::mutex> lock(loopsMutex);
-    clearAllInternal();
+    clearAll();
   }
 
   if (requestUndo.exchange(false)) {
-    std::lock_guard<std::mutex> lock(loopsMutex);
-    removeLastLoopInternal();
+    removeLastLoop();
+  }
+
+  if (auto batch = resampler.takeFinished())
+    adoptResampled(std::move(batch));
+
+  int importedLength = 0;
+  if (auto result = importer.takeFinished())
+    importedLength = adoptImported(std::move(result));
+
+  if (layerSum.adoptPending(layerGeneration.load()))
+    peaksGeneration.fetch_add(1, std::memory_order_release);
+  return importedLength;
+}
+
+int Looper::adoptImported(std::unique_ptr<LayerImporter::Result> result) {
+  const int length = result->layer->length;
+  const double layerRate = result->layer->sampleRate;
+  if (appendLoop(std::move(result->layer)) < 0) {
+    reclaimer.retire(std::move(result));
+    return 0;
   }
+
+  ++layerGeneration;
+  layerSum.invalidate();
+  peaksGeneration.fetch_add(1, std::memory_order_release);
+  reclaimer.retire(std::move(result));
+
+  // The rate changed while it was decoded: convert it with the rest
+  if (layerRate != currentSampleRate)
+    resampler.start(currentSampleRate);
+  return length;
 }
 
-void Looper::getState(juce::ValueTree &state, double sampleRate) const {
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  juce::ignoreUnused(sampleRate);
+void Looper::adoptResampled(std::unique_ptr<LayerResampler::Batch> batch) {
+  for (auto &entry : batch->entries) {
+    // Skip layers undone, cleared or re-recorded since the snapshot
+    auto *current = loopAt(entry.index);
+    if (current != entry.source || current->sampleRate == batch->sampleRate ||
+        entry.index == recordingLoopIndex.load())
+      continue;
 
-  state.setProperty("loopCount", static_cast<int>(loops.size()), nullptr);
+    entry.layer->serial = current->serial;
+    loops[static_cast<size_t>(entry.index)].store(entry.layer.release(),
+                                                  std::memory_order_release);
+    reclaimer.retire(std::unique_ptr<Loop>(current));
+  }
 
-  // Save each loop's audio data
-  for (size_t i = 0; i < loops.size(); ++i) {
-    juce::String loopKey = "loop_" + juce::String(i);
-    auto &loop = loops[i];
+  ++layerGeneration;
+  layerSum.invalidate();
+  // Layers that weren't swapped in go with the batch
+  reclaimer.retire(std::move(batch));
+}
 
-    juce::MemoryBlock loopData;
-    juce::MemoryOutputStream loopStream(loopData, true);
+bool Looper::snapshotLayers(std::vector<const LoopLayer *> &layers,
+                            juce::uint32 &generation) const {
+  generation = layerGeneration.load();
 
-    loopStream.writeInt(loop->length);
-    loopStream.writeBool(loop->hasContent);
+  // The live layer is still changing; rebuild once recording stops
+  if (recordingLoopIndex != -1)
+    return false;
 
-    // Write audio data
-    if (loop->hasContent && loop->length > 0) {
-      for (int channel = 0; channel < loop->buffer.getNumChannels();
-           ++channel) {
-        loopStream.write(loop->buffer.getReadPointer(channel),
-                         sizeof(float) * static_cast<size_t>(loop->length));
+  const int count = numLoops.load(std::memory_order_acquire);
+  for (int i = 0; i < count; ++i) {
+    if (const auto *loop = loopAt(i))
+      layers.push_back(loop);
+  }
+
+  // Layers changed while we looked; try again later
+  return layerGeneration.load() == generation;
+}
+
+bool Looper::captureLayer(int index, double sampleRate, int loopLength,
+                          SavedLayer &saved) const {
+  const auto *loop = index < numLoops.load(std::memory_order_acquire)
+                         ? loopAt(index)
+                         : nullptr;
+  if (loop == nullptr)
+    return false;
+
+  saved.loop = loop;
+  // Layers still waiting to be resampled keep their own rate
+  saved.sampleRate = loop->sampleRate > 0.0 ? loop->sampleRate : sampleRate;
+  saved.numChannels = loop->buffer.getNumChannels();
+
+  for (;;) {
+    // In this order: content set with an even revision means the seams have
+    // been rewritten, and the audio won't change again
+    const bool finalized = loop->hasContent.load();
+    const auto revision = loop->revision.load(std::memory_order_acquire);
+    if ((revision & 1u) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    if (finalized) {
+      saved.length = loop->length;
+      saved.hasContent = saved.length > 0;
+      saved.copied = false;
+      return true;
+    }
+
+    // Still being recorded: copy what is written so far, which stays put
+    // unless the layer is finalized meanwhile
+    const int recorded = loop->recorded.load(std::memory_order_acquire);
+    const int start = loop->recordStart.load(std::memory_order_relaxed);
+    const int end = juce::jmin(start + recorded, loopLength);
+    saved.hasContent = end > start;
+    saved.length = saved.hasContent ? loopLength : 0;
+    saved.copied = true;
+    saved.copyStart = start;
+    saved.copy.setSize(saved.numChannels, juce::jmax(0, end - start), false,
+                       false, true);
+    for (int channel = 0; saved.hasContent && channel < saved.numChannels;
+         ++channel)
+      loop->buffer.copyTo(channel, start, saved.copy.getWritePointer(channel),
+                          end - start);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (loop->revision.load(std::memory_order_relaxed) == revision)
+      return true;
+  }
+}
+
+const float *Looper::SavedLayer::read(int channel, int position,
+                                      int numSamples, float *scratch) const {
+  if (!copied)
+    return loop->buffer.getReadPointer(channel, position);
+
+  const int from = juce::jmax(position, copyStart);
+  const int to = juce::jmin(position + numSamples,
+                            copyStart + copy.getNumSamples());
+  if (from >= to)
+    return nullptr;
+
+  std::fill(scratch, scratch + numSamples, 0.0f);
+  std::copy(copy.getReadPointer(channel, from - copyStart),
+            copy.getReadPointer(channel, to - copyStart),
+            scratch + (from - position));
+  return scratch;
+}
+
+void Looper::writeLayers(SessionWriter &writer, double sampleRate,
+                         int loopLength) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  std::vector<float> scratch(LoopPagePool::pageSize);
+  SavedLayer saved;
+
+  const int count = numLoops.load(std::memory_order_acquire);
+  for (int i = 0; i < count; ++i) {
+    if (!captureLayer(i, sampleRate, loopLength, saved))
+      continue;
+
+    writer.beginChunk(SessionFormat::layerId);
+    writer.writeInt(saved.length);
+    writer.writeBool(saved.hasContent);
+    writer.writeDouble(saved.sampleRate);
+    writer.writeInt(saved.numChannels);
+
+    // Straight from the pages; pages never written are silence
+    if (saved.hasContent) {
+      for (int channel = 0; channel < saved.numChannels; ++channel) {
+        for (int pos = 0; pos < saved.length;) {
+          const int len = juce::jmin(saved.length - pos,
+                                     LoopBuffer::getContiguousLength(pos));
+          if (const auto *data =
+                  saved.read(channel, pos, len, scratch.data()))
+            writer.writeFloats(data, len);
+          else
+            writer.writeSilence(len);
+          pos += len;
+        }
+      }
+    }
+
+    writer.endChunk();
+  }
+}
+
+bool Looper::encodeLayer(int index, double sampleRate, int loopLength,
+                         LayerCodec &codec, juce::MemoryBlock &payload,
+                         juce::uint32 serial) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  SavedLayer saved;
+  if (!captureLayer(index, sampleRate, loopLength, saved) ||
+      (serial != 0 && saved.loop->serial != serial))
+    return false;
+
+  payload.reset();
+  juce::MemoryOutputStream output(payload, false);
+  output.writeInt(saved.length);
+  output.writeBool(saved.hasContent);
+  output.writeDouble(saved.sampleRate);
+  output.writeInt(saved.numChannels);
+
+  // One frame per page; pages never written are silent frames
+  if (saved.hasContent) {
+    std::vector<float> scratch(LoopPagePool::pageSize);
+    for (int channel = 0; channel < saved.numChannels; ++channel) {
+      for (int pos = 0; pos < saved.length;) {
+        const int len = juce::jmin(saved.length - pos,
+                                   LoopBuffer::getContiguousLength(pos));
+        codec.encodeFrame(saved.read(channel, pos, len, scratch.data()), len,
+                          output);
+        pos += len;
       }
     }
+  }
 
-    state.setProperty(loopKey, loopData.toBase64Encoding(), nullptr);
+  output.flush();
+  return true;
+}
+
+void Looper::getFinishedLayers(std::vector<juce::uint32> &serials) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  const int count = numLoops.load(std::memory_order_acquire);
+  const int recordingIndex = recordingLoopIndex.load();
+  for (int i = 0; i < count; ++i) {
+    // In this order, as for saving: content set with an even revision means
+    // the audio won't change again
+    const auto *loop = loopAt(i);
+    if (loop != nullptr && i != recordingIndex && loop->hasContent.load() &&
+        (loop->revision.load(std::memory_order_acquire) & 1u) == 0)
+      serials.push_back(loop->serial);
+  }
+}
+
+int Looper::findLayer(juce::uint32 serial) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  const int count = numLoops.load(std::memory_order_acquire);
+  for (int i = 0; i < count; ++i) {
+    const auto *loop = loopAt(i);
+    if (loop != nullptr && loop->serial == serial)
+      return i;
   }
+  return -1;
+}
+
+float Looper::getLayerSample(int index, int channel, int position) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  if (index < 0 || index >= numLoops.load(std::memory_order_acquire))
+    return 0.0f;
+  const auto *loop = loopAt(index);
+  if (loop == nullptr || channel < 0 ||
+      channel >= loop->buffer.getNumChannels() || position < 0 ||
+      position >= loop->buffer.getCapacity())
+    return 0.0f;
+  return loop->buffer.getSample(channel, position);
+}
+
+bool Looper::readLayer(juce::MemoryInputStream &payload, bool compressed) {
+  const int length = payload.readInt();
+  const bool hasContent = payload.readBool();
+  const double layerRate = payload.readDouble();
+  const int savedChannels = payload.readInt();
+
+  // Refuse layers whose samples don't add up to the payload; compressed
+  // ones are checked frame by frame as they are decoded
+  const auto sampleBytes =
+      hasContent ? sizeof(float) * static_cast<size_t>(juce::jmax(0, length)) *
+                       static_cast<size_t>(juce::jmax(0, savedChannels))
+                 : 0;
+  if (length < 0 || savedChannels < 0 || layerRate <= 0.0 ||
+      length > static_cast<int>(layerRate * maxLoopSeconds) ||
+      (!compressed &&
+       static_cast<juce::uint64>(payload.getNumBytesRemaining()) !=
+           sampleBytes))
+    return false;
+
+  if (!compressed)
+    return restoreLayer(length, hasContent, layerRate, savedChannels,
+                        payload);
+
+  LayerCodec codec;
+  return restoreLayer(length, hasContent, layerRate, savedChannels, payload,
+                      &codec);
+}
+
+float *Looper::restorePage(LoopBuffer &buffer, int channel, int position) {
+  // Grow the pool here rather than have acquire() count an emergency
+  if (buffer.getReadPointer(channel, position) == nullptr &&
+      pagePool->getNumFreePages() == 0)
+    pagePool->reserve(1);
+  return buffer.getWritePointer(channel, position);
+}
+
+bool Looper::restoreLayer(int length, bool hasContent, double layerRate,
+                          int savedChannels, juce::MemoryInputStream &samples,
+                          LayerCodec *codec) {
+  // Only the pages that hold sound are taken from the pool
+  auto newLoop = std::make_unique<Loop>(pagePool, numChannels,
+                                        length > 0 ? length : maxLoopLength);
+  newLoop->length = length;
+  newLoop->hasContent = hasContent;
+  newLoop->sampleRate = layerRate;
+
+  if (hasContent && length > 0) {
+    auto &buffer = newLoop->buffer;
+    for (int channel = 0; channel < savedChannels; ++channel) {
+      // Channels this looper doesn't have are skipped
+      const bool kept = channel < buffer.getNumChannels();
+      if (!kept && codec == nullptr) {
+        samples.skipNextBytes(static_cast<juce::int64>(sizeof(float)) *
+                              length);
+        continue;
+      }
+
+      for (int pos = 0; pos < length;) {
+        const int len =
+            juce::jmin(length - pos, LoopBuffer::getContiguousLength(pos));
+        if (codec != nullptr) {
+          // Decoded straight into the page; silent frames leave it
+          // unallocated
+          const bool silent = LayerCodec::peekFrameType(samples) ==
+                              LayerCodec::FrameType::silent;
+          auto *dest = kept && !silent ? restorePage(buffer, channel, pos)
+                                       : nullptr;
+          if (!codec->decodeFrame(samples, len, dest))
+            return false;
+        } else {
+          // Copied from the payload in place; all-zero runs stay silent
+          const auto numBytes = sizeof(float) * static_cast<size_t>(len);
+          if (samples.getNumBytesRemaining() <
+              static_cast<juce::int64>(numBytes))
+            return false;
+          const auto *source = static_cast<const char *>(samples.getData()) +
+                               samples.getPosition();
+          if (!std::all_of(source, source + numBytes,
+                           [](char byte) { return byte == 0; })) {
+            if (auto *dest = restorePage(buffer, channel, pos)) {
+              std::memcpy(dest, source, numBytes);
+#if JUCE_BIG_ENDIAN
+              for (int i = 0; i < len; ++i)
+                dest[i] = juce::ByteOrder::swapIfBigEndian(dest[i]);
+#endif
+            }
+          }
+          samples.skipNextBytes(static_cast<juce::int64>(numBytes));
+        }
+        pos += len;
+      }
+    }
+    newLoop->peaks.refreshAll();
+  }
+
+  appendLoop(std::move(newLoop));
+  return true;
+}
+
+void Looper::finishRestore() {
+  // A rebuild may have caught the layers half restored
+  ++layerGeneration;
+  layerSum.invalidate();
+
+  // Layers saved at another rate are converted in the background
+  bool needsResampling = false;
+  const int count = numLoops.load();
+  for (int i = 0; i < count; ++i) {
+    if (const auto *loop = loopAt(i))
+      needsResampling =
+          needsResampling || loop->sampleRate != currentSampleRate;
+  }
+
+  if (needsResampling)
+    resampler.start(currentSampleRate);
 }
 
 void Looper::setState(const juce::ValueTree &state, double sampleRate) {
-  std::lock_guard<std::mutex> lock(loopsMutex);
   int loopCount = state.getProperty("loopCount", 0);
 
+  // Sessions from before rates were saved are taken to match the current one
+  const double savedRate = state.getProperty("sampleRate", sampleRate);
+
   currentSampleRate = sampleRate;
-  maxLoopLength = static_cast<int>(sampleRate * 60.0);
+  maxLoopLength = static_cast<int>(sampleRate * maxLoopSeconds);
+  fadeScratch.resize(static_cast<size_t>(sampleRate * crossfadeSeconds) + 1);
 
-  loops.clear();
+  clearAll();
 
   for (int i = 0; i < loopCount; ++i) {
     juce::String loopKey = "loop_" + juce::String(i);
@@ -297,83 +764,141 @@ void Looper::setState(const juce::ValueTree &state, double sampleRate) {
       loopData.fromBase64Encoding(loopDataBase64);
       juce::MemoryInputStream loopStream(loopData, false);
 
-      auto newLoop = std::make_unique<Loop>();
-      newLoop->buffer.setSize(numChannels, maxLoopLength);
-      newLoop->buffer.clear();
-
-      newLoop->length = loopStream.readInt();
-      newLoop->hasContent = loopStream.readBool();
-
-      if (newLoop->hasContent && newLoop->length > 0) {
-        for (int channel = 0; channel < newLoop->buffer.getNumChannels();
-             ++channel) {
-          loopStream.read(
-              newLoop->buffer.getWritePointer(channel),
-              static_cast<int>(sizeof(float) *
-                               static_cast<size_t>(newLoop->length)));
-        }
-      }
-
-      loops.push_back(std::move(newLoop));
+      const int length = loopStream.readInt();
+      const bool hasContent = loopStream.readBool();
+      restoreLayer(length, hasContent,
+                   state.getProperty(loopKey + "_rate", savedRate),
+                   numChannels, loopStream);
     }
   }
-}
 
-bool Looper::hasLoops() const {
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  return !loops.empty();
+  finishRestore();
 }
 
+bool Looper::hasLoops() const { return numLoops.load() > 0; }
+
 size_t Looper::getNumLoops() const {
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  return loops.size();
+  return static_cast<size_t>(numLoops.load());
+}
+
+bool Looper::hasLayerSum() const { return layerSum.isAvailable(); }
+
+size_t Looper::getAllocatedBytes() const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  size_t numPages = 0;
+  const int count = numLoops.load(std::memory_order_acquire);
+  for (int i = 0; i < count; ++i) {
+    if (const auto *loop = loopAt(i))
+      numPages += static_cast<size_t>(loop->buffer.getNumAllocatedPages());
+  }
+  return numPages * sizeof(float) * LoopPagePool::pageSize;
 }
 
 int Looper::getRecordingLength() const {
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  if (recordingLoopIndex >= 0 &&
-      recordingLoopIndex < static_cast<int>(loops.size())) {
+  if (recordingLoopIndex.load() >= 0) {
     return currentLoopSamples;
   }
   return 0;
 }
 
-std::vector<float> Looper::getWaveformPeaks(int numBins, int channel,
-                                            int effectiveLength) const {
-  std::lock_guard<std::mutex> lock(loopsMutex);
-  std::vector<float> peaks(numBins, 0.0f);
+bool Looper::renderMix(juce::AudioBuffer<float> &dest, int position,
+                       int loopLength,
+                       const std::vector<juce::uint32> &serials) const {
+  dest.clear();
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  if (resampler.isBusy())
+    return false;
+  if (loopLength <= 0)
+    return true;
+
+  std::vector<const Loop *> finished;
+  for (const auto serial : serials) {
+    const int index = findLayer(serial);
+    if (index < 0)
+      return false;
+    finished.push_back(loopAt(index));
+  }
 
-  if (loops.empty()) {
-    return peaks;
+  const int numSamples = dest.getNumSamples();
+  const int channelsToMix = juce::jmin(numChannels, dest.getNumChannels());
+  int pos = position % loopLength;
+  for (int offset = 0; offset < numSamples;) {
+    const int len = juce::jmin(numSamples - offset, loopLength - pos);
+    for (int channel = 0; channel < channelsToMix; ++channel) {
+      float *out = dest.getWritePointer(channel, offset);
+      for (const auto *loop : finished)
+        loop->buffer.addTo(channel, pos, out, len);
+      for (int i = 0; i < len; ++i)
+        out[i] = std::tanh(out[i]);
+    }
+
+    offset += len;
+    pos += len;
+    if (pos >= loopLength)
+      pos = 0;
   }
+  return true;
+}
 
-  if (effectiveLength <= 0) {
+std::vector<PeakPyramid::Range>
+Looper::getWaveformPeaks(int numBins, int channel, int effectiveLength) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  std::vector<PeakPyramid::Range> peaks(static_cast<size_t>(numBins));
+
+  const int count = numLoops.load(std::memory_order_acquire);
+  if (count == 0 || effectiveLength <= 0 || numBins <= 0)
     return peaks;
-  }
-  int effectiveLen = effectiveLength;
 
-  for (size_t i = 0; i < loops.size(); ++i) {
-    auto &loop = loops[i];
-    bool isRecordingLoop = (static_cast<int>(i) == recordingLoopIndex);
-    if (!loop->hasContent && !isRecordingLoop) {
+  // Prefer the layer sum, which is what plays; while it is being rebuilt,
+  // add up each layer's range instead, which bounds the sum
+  const auto *sum = layerSum.getShared();
+  const int recordingIndex = recordingLoopIndex.load();
+  const int safeChannel = juce::jmin(channel, numChannels - 1);
+
+  const double samplesPerBin =
+      static_cast<double>(effectiveLength) / static_cast<double>(numBins);
+  const int level = PeakPyramid::getLevelFor(samplesPerBin);
+
+  auto rangeOf = [&](const LoopLayer &layer, int start, int end) {
+    if (level >= 0)
+      return layer.peaks.getRange(safeChannel, level, start, end);
+
+    // Zoomed in past the finest level: a handful of samples per bin
+    PeakPyramid::Range range;
+    const int last = juce::jmin(end, layer.buffer.getCapacity());
+    for (int pos = start; pos < last; ++pos) {
+      const float sample = layer.buffer.getSample(safeChannel, pos);
+      range.min = juce::jmin(range.min, sample);
+      range.max = juce::jmax(range.max, sample);
+    }
+    return range;
+  };
+
+  for (int bin = 0; bin < numBins; ++bin) {
+    const int start = static_cast<int>(
+        (static_cast<int64_t>(bin) * effectiveLength) / numBins);
+    const int end = juce::jmax(
+        start + 1, static_cast<int>((static_cast<int64_t>(bin + 1) *
+                                     effectiveLength) /
+                                    numBins));
+    auto &peak = peaks[static_cast<size_t>(bin)];
+
+    if (sum != nullptr) {
+      peak = rangeOf(*sum, start, end);
       continue;
     }
 
-    int safeChannel = juce::jmin(channel, loop->buffer.getNumChannels() - 1);
-
-    for (int bin = 0; bin < numBins; ++bin) {
-      int globalPos = static_cast<int>(
-          (static_cast<int64_t>(bin) * effectiveLen) / numBins);
-      int readPos = globalPos % effectiveLen;
-
-      // Recording loop: unwritten positions are zero (buffer was cleared).
-      // Finalized loops: only valid up to loop->length.
-      if (loop->hasContent && readPos >= loop->length) {
+    for (int i = 0; i < count; ++i) {
+      const auto *loop = loopAt(i);
+      // Finalized loops are only valid up to their length; the recording
+      // loop reads back silence where nothing has been written yet
+      if (loop == nullptr || (!loop->hasContent && i != recordingIndex) ||
+          (loop->hasContent && start >= loop->length))
         continue;
-      }
 
-      float samp = loop->buffer.getSample(safeChannel, readPos);
-      peaks[bin] = juce::jmax(peaks[bin], std::abs(samp));
+      const auto range = rangeOf(*loop, start, end);
+      peak.min += range.min;
+      peak.max += range.max;
     }
   }
 
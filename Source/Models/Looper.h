@@ -18,10 +18,18 @@
 
 #pragma once
 
+#include "LayerCodec.h"
+#include "LayerImporter.h"
+#include "LayerPool.h"
+#include "LayerResampler.h"
+#include "LayerSum.h"
+#include "LevelMeter.h"
+#include "LoopStorage.h"
+#include "SessionFormat.h"
+#include <array>
 #include <atomic>
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <memory>
-#include <mutex>
 #include <vector>
 
 /**
@@ -29,24 +37,26 @@
  *
  * Handles recording multiple loops, synchronizing them to a base length,
  * and mixing them together for playback.
+ *
+ * Layers are only added and removed by the thread driving the looper: the
+ * audio thread while audio is running, otherwise whoever owns it. Readers on
+ * other threads never block it; they see the layers through atomics and hold
+ * the reclaimer's readers lock while touching layer audio.
  */
 class Looper {
 public:
-  struct Loop {
-    juce::AudioBuffer<float> buffer;
-    int length = 0;
-    bool hasContent = false;
-  };
+  using Loop = LoopLayer;
 
   Looper();
   ~Looper();
 
-  // Initialize the looper with sample rate
+  // Initialize the looper with sample rate. Existing loops are kept and
+  // resampled to the new rate in the background.
   void prepare(double sampleRate);
 
   void startRecording(int currentReadPosition, int loopLength);
   void stopRecording(int loopLength);
-  bool isRecording() const { return recordingLoopIndex != -1; }
+  bool isRecording() const { return recordingLoopIndex.load() != -1; }
 
   // Playback control
   void startPlayback();
@@ -54,7 +64,9 @@ public:
   bool isPlaying() const { return playing; }
 
   // Loop management
-  void addNewLoop();
+  // Layers are sized to `loopLength` when it is known, else to the maximum.
+  // Allocates; the recording paths use ready-made layers instead.
+  void addNewLoop(int loopLength = 0);
   void removeLastLoop();
   void clearAll();
 
@@ -63,50 +75,239 @@ public:
   void processPlayback(juce::AudioBuffer<float> &outputBuffer, float volume,
                        int readPosition, int loopLength);
 
+  // Level of what processPlayback() has written, volume included. Close
+  // each block with updateMeter() from the thread driving the looper.
+  const MeterReading &updateMeter(int numSamples) {
+    return meter.update(numSamples);
+  }
+
   // Thread-safe actions (to be called from non-audio thread)
   void requestClearAll();
   void requestUndoLast();
-  void handlePendingRequests();
+
+  // Carries out the requests above and adopts background work. Returns the
+  // length of a layer imported in this call, or 0.
+  int handlePendingRequests();
+
+  // Import an audio file as a new layer of `loopLength` samples, decoded
+  // and resampled in the background and trimmed or padded to fit; with no
+  // loop length it is as long as the file, up to the maximum. The layer is
+  // added by handlePendingRequests() once it is ready. Call from any thread
+  // but the audio thread; clearing the looper drops an import in progress.
+  void importLayer(const juce::File &file, int loopLength);
+  bool isImporting() const { return importer.isBusy(); }
+  const LayerImporter &getImporter() const { return importer; }
 
   bool hasLoops() const;
   size_t getNumLoops() const;
   double getSampleRate() const { return currentSampleRate; }
 
+  // Ready-made layers for rollover (exposes pool depth and miss counters)
+  const LayerPool &getLayerPool() const { return layerPool; }
+
+  // True while playback reads the running layer sum rather than mixing each
+  // layer (false briefly after an undo or clear, until it is rebuilt)
+  bool hasLayerSum() const;
+
+  // True while layers are being converted to a new sample rate; playback is
+  // silent until they have all been swapped in
+  bool isResampling() const { return resampler.isBusy(); }
+
+  // Memory currently held by recorded audio across all layers
+  size_t getAllocatedBytes() const;
+
   // Total length recorded in the currently-recording loop
   int getRecordingLength() const;
 
-  // Thread-safe waveform peak extraction for visualization
-  // Fills `numBins` peak values from the combined loop audio
-  // If effectiveLength > 0, it overrides the base loop length for display
-  std::vector<float> getWaveformPeaks(int numBins, int channel = 0,
-                                      int effectiveLength = 0) const;
+  // Changes whenever anything drawn from the layers may have changed:
+  // layers added, removed or finalized, audio written, or the layer sum
+  // swapped in. Safe from any thread.
+  juce::uint32 getContentGeneration() const {
+    return layerGeneration.load() + peaksGeneration.load();
+  }
+
+  // Thread-safe waveform peaks for visualization: the min and max of the
+  // mixed layers across `numBins` equal slices of `effectiveLength`. Reads
+  // a few pyramid bins per slice, whatever the loop length or layer count.
+  std::vector<PeakPyramid::Range>
+  getWaveformPeaks(int numBins, int channel = 0,
+                   int effectiveLength = 0) const;
 
-  // State serialization
-  void getState(juce::ValueTree &state, double sampleRate) const;
+  // Thread-safe render of the layers with the given serials (as from
+  // getFinishedLayers()), mixed and saturated as playback hears them but
+  // before volume, into `dest` (replacing what it held):
+  // `dest.getNumSamples()` samples from `position` of a loop of
+  // `loopLength`, wrapping round. Layers finished since the serials were
+  // taken are left out. False, with `dest` silent, if any of the layers has
+  // since been removed or the looper is resampling.
+  bool renderMix(juce::AudioBuffer<float> &dest, int position, int loopLength,
+                 const std::vector<juce::uint32> &serials) const;
+
+  // State serialization: one layer chunk per layer, written straight from
+  // the pages. readLayer() takes a layer chunk's payload and returns false if
+  // it doesn't hold a valid layer; call finishRestore() after the last one.
+  // Layers are restored straight into pages, taking only those that aren't
+  // silent. Until finishRestore(), a looper not yet playing may be restored
+  // on any one thread.
+  //
+  // Saving never blocks the audio thread, which may go on recording. A layer
+  // being recorded is saved with what it holds so far, as a layer of
+  // `loopLength` samples.
+  void writeLayers(SessionWriter &writer, double sampleRate,
+                   int loopLength) const;
+  bool readLayer(juce::MemoryInputStream &payload, bool compressed = false);
+  void finishRestore();
+
+  // The payload of a compressed layer chunk for the layer at `index`, or
+  // false if there is no such layer, or it isn't the one with `serial` when
+  // given. Safe from any thread, and for several layers at once.
+  bool encodeLayer(int index, double sampleRate, int loopLength,
+                   LayerCodec &codec, juce::MemoryBlock &payload,
+                   juce::uint32 serial = 0) const;
+
+  // Appends the serials of the finished layers, in order, leaving out the
+  // one being recorded; findLayer() gives the index of a layer by serial,
+  // or -1. Safe from any thread.
+  void getFinishedLayers(std::vector<juce::uint32> &serials) const;
+  int findLayer(juce::uint32 serial) const;
+
+  // One sample of the layer at `index`, or 0 if there is no such layer.
+  // Safe from any thread; for tests and diagnostics.
+  float getLayerSample(int index, int channel, int position) const;
+
+  // Restores sessions saved before the binary format, which kept each layer
+  // base64-encoded in a ValueTree property
   void setState(const juce::ValueTree &state, double sampleRate);
 
 private:
-  mutable std::mutex loopsMutex;
-  std::vector<std::unique_ptr<Loop>> loops;
-  int recordingLoopIndex = -1;
-  bool playing = false;
+  std::shared_ptr<LoopPagePool> pagePool = std::make_shared<LoopPagePool>();
+
+  // Fixed layer slots, so adding a layer never reallocates under a reader.
+  // Recording stops at a cycle boundary once they are all taken.
+  static constexpr int maxLayers = 1024;
+  std::array<std::atomic<Loop *>, maxLayers> loops{};
+  std::atomic<int> numLoops{0};
+  std::atomic<int> recordingLoopIndex{-1};
+  std::atomic<bool> playing{false};
 
-  int currentLoopSamples =
-      0; // Total samples written to the current recording loop
+  std::atomic<int> currentLoopSamples{
+      0}; // Total samples written to the current recording loop
 
   double currentSampleRate = 44100.0;
+  static constexpr double maxLoopSeconds = 60.0;
   int maxLoopLength = 44100 * 60;
   int numChannels = 2;
 
-  // Unlocked helpers (caller must hold loopsMutex)
-  void removeLastLoopInternal();
-  void clearAllInternal();
+  // Pages stocked for a first recording, before its length is known
+  static constexpr double initialPageSeconds = 8.0;
+
+  // Scratch bus the layers are summed into before saturation and gain
+  static constexpr int mixChunkSize = 1024;
+  juce::AudioBuffer<float> mixBus;
+
+  LevelMeter meter;
+
+  // Seam crossfade length, and scratch for the fade-in it blends from
+  static constexpr double crossfadeSeconds = 0.01;
+  std::vector<float> fadeScratch;
+
+  LayerPool layerPool{pagePool, numChannels};
+
+  // Frees retired layers on the housekeeping thread
+  Reclaimer reclaimer;
+
+  // Bumped whenever layers are added, removed or finalized, so background
+  // sums built from an older set of layers are not adopted
+  std::atomic<juce::uint32> layerGeneration{0};
+
+  // Bumped when audio is written or the sum is swapped in, for displays
+  std::atomic<juce::uint32> peaksGeneration{0};
+
+  LayerSum layerSum{pagePool, numChannels, reclaimer,
+                    [this](std::vector<const LoopLayer *> &layers,
+                           juce::uint32 &generation) {
+                      return snapshotLayers(layers, generation);
+                    }};
+
+  Loop *loopAt(int index) const {
+    return loops[static_cast<size_t>(index)].load(std::memory_order_acquire);
+  }
+
+  // Put a layer in the next free slot; returns its index, or -1 (retiring
+  // the layer) if every slot is taken
+  int appendLoop(std::unique_ptr<Loop> loop);
+
+  // A ready-made layer from the pool, or a freshly built one if it ran dry
+  std::unique_ptr<Loop> takeLayer(int loopLength);
+  std::unique_ptr<Loop> createLayer(int loopLength);
+
+  LayerResampler resampler{pagePool, numChannels, reclaimer,
+                           [this](int index) -> const LoopLayer * {
+                             return index < numLoops.load() ? loopAt(index)
+                                                            : nullptr;
+                           }};
+
+  // Swap converted layers into the slots they were made from
+  void adoptResampled(std::unique_ptr<LayerResampler::Batch> batch);
+
+  LayerImporter importer{pagePool, numChannels, reclaimer};
+
+  // Add an imported layer; returns its length, or 0 if there was no room
+  int adoptImported(std::unique_ptr<LayerImporter::Result> result);
+
+  // Called by layerSum on the housekeeping thread
+  bool snapshotLayers(std::vector<const LoopLayer *> &layers,
+                      juce::uint32 &generation) const;
+
+  // Bring the peaks of a layer and of the sum up to date after a write
+  void refreshPeaks(Loop &loop, int position, int numSamples);
+
+  // Rewrite one sample of a layer, keeping the layer sum in step
+  void replaceSample(Loop &loop, int channel, int position, float value);
+
+  // A layer as it is saved: a finalized one straight from its pages, and
+  // one still being recorded from a copy of what it holds so far
+  struct SavedLayer {
+    const Loop *loop = nullptr;
+    int length = 0;
+    bool hasContent = false;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+
+    bool copied = false;
+    int copyStart = 0;
+    juce::AudioBuffer<float> copy;
+
+    // `numSamples` samples of `channel` from `position`, within one page,
+    // or null where they are silent. May fill `scratch` and point there.
+    const float *read(int channel, int position, int numSamples,
+                      float *scratch) const;
+  };
+
+  // A consistent view of the layer at `index`, or false if there is none.
+  // Retries, without blocking the audio thread, if the layer is finalized
+  // while it is copied. Call with the readers lock held.
+  bool captureLayer(int index, double sampleRate, int loopLength,
+                    SavedLayer &saved) const;
+
+  // Set a layer's length and content and rewrite its seams, flagging the
+  // rewrite for captureLayer()
+  void finalizeLayer(Loop &loop, int length, bool fadeOutGap);
+
+  // Add a restored layer, reading its samples channel by channel as raw
+  // floats, or as frames when given a codec. False if they run short.
+  bool restoreLayer(int length, bool hasContent, double layerRate,
+                    int savedChannels, juce::MemoryInputStream &samples,
+                    LayerCodec *codec = nullptr);
+
+  // The page of `buffer` holding `position`, taken for a restore
+  float *restorePage(LoopBuffer &buffer, int channel, int position);
 
   // Crossfade helper
-  void applyCrossfade(int loopIndex);
+  void applyCrossfade(Loop &loop);
 
   // Fade out the tail of a partial recording to avoid a pop at the gap
-  void applyFadeOut(int loopIndex);
+  void applyFadeOut(Loop &loop);
 
   // Thread-safe request flags
   std::atomic<bool> requestClear{false};
@@ -0,0 +1,140 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PeakPyramid.h"
+#include "LoopStorage.h"
+
+// Bins never straddle a page, so each one is read with a single pointer
+static_assert((LoopPagePool::pageSize &
+               ((1 << PeakPyramid::getBinSizeLog2(
+                     PeakPyramid::numLevels - 1)) -
+                1)) == 0,
+              "Peak bins must divide a page");
+
+PeakPyramid::PeakPyramid(const LoopBuffer &bufferToSummarise)
+    : buffer(bufferToSummarise) {
+  for (int level = 0; level < numLevels; ++level) {
+    const int binSize = 1 << getBinSizeLog2(level);
+    numBins[level] = (buffer.getCapacity() + binSize - 1) / binSize;
+  }
+}
+
+int PeakPyramid::getLevelFor(double samplesPerPixel) {
+  for (int level = numLevels - 1; level >= 0; --level) {
+    if (samplesPerPixel >= static_cast<double>(1 << getBinSizeLog2(level)))
+      return level;
+  }
+  return -1;
+}
+
+void PeakPyramid::refresh(int channel, int position, int numSamples) {
+  const int capacity = buffer.getCapacity();
+  const int start = juce::jmax(0, position);
+  const int end = juce::jmin(capacity, position + numSamples);
+  if (start >= end)
+    return;
+
+  // Rescan the base bins from the audio; pages never written are silence
+  int first = start >> baseBinSizeLog2;
+  int last = (end - 1) >> baseBinSizeLog2;
+  for (int bin = first; bin <= last; ++bin) {
+    const int binStart = bin << baseBinSizeLog2;
+    const int length =
+        juce::jmin(1 << baseBinSizeLog2, capacity - binStart);
+
+    Range range;
+    if (const float *data = buffer.getReadPointer(channel, binStart)) {
+      const auto found =
+          juce::FloatVectorOperations::findMinAndMax(data, length);
+      range = {found.getStart(), found.getEnd()};
+    }
+    store(channel, 0, bin, range);
+  }
+
+  // Then each coarser level from the one below
+  for (int level = 1; level < numLevels; ++level) {
+    first >>= levelStepLog2;
+    last >>= levelStepLog2;
+    for (int bin = first; bin <= last; ++bin) {
+      const int childStart = bin << levelStepLog2;
+      const int childEnd = juce::jmin(childStart + (1 << levelStepLog2),
+                                      numBins[level - 1]);
+
+      Range range = load(channel, level - 1, childStart);
+      for (int child = childStart + 1; child < childEnd; ++child) {
+        const auto childRange = load(channel, level - 1, child);
+        range.min = juce::jmin(range.min, childRange.min);
+        range.max = juce::jmax(range.max, childRange.max);
+      }
+      store(channel, level, bin, range);
+    }
+  }
+}
+
+void PeakPyramid::refreshAll() {
+  for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    refresh(channel, 0, buffer.getCapacity());
+}
+
+PeakPyramid::Range PeakPyramid::getRange(int channel, int level, int start,
+                                         int end) const {
+  const int shift = getBinSizeLog2(level);
+  const int first = juce::jmax(0, start) >> shift;
+  const int last = juce::jmin(numBins[level], ((end - 1) >> shift) + 1);
+  if (channel >= buffer.getNumChannels() || first >= last)
+    return {};
+
+  Range range = load(channel, level, first);
+  for (int bin = first + 1; bin < last; ++bin) {
+    const auto binRange = load(channel, level, bin);
+    range.min = juce::jmin(range.min, binRange.min);
+    range.max = juce::jmax(range.max, binRange.max);
+  }
+  return range;
+}
+
+std::atomic<float> *PeakPyramid::binAt(int channel, int level,
+                                        int bin) const {
+  // Within its page's bins, each level follows the finer ones
+  constexpr int pageLog2 = LoopPagePool::pageSizeLog2;
+  const int shift = getBinSizeLog2(level);
+  auto *bins = buffer.getPeakBins(channel, bin << shift);
+  if (bins == nullptr)
+    return nullptr;
+
+  int offset = bin & ((1 << (pageLog2 - shift)) - 1);
+  for (int finer = 0; finer < level; ++finer)
+    offset += 1 << (pageLog2 - getBinSizeLog2(finer));
+  return bins + 2 * offset;
+}
+
+void PeakPyramid::store(int channel, int level, int bin, Range range) {
+  // Nothing to keep for a page never written: it reads back as silence
+  if (auto *entry = binAt(channel, level, bin)) {
+    entry[0].store(range.min, std::memory_order_relaxed);
+    entry[1].store(range.max, std::memory_order_relaxed);
+  }
+}
+
+PeakPyramid::Range PeakPyramid::load(int channel, int level, int bin) const {
+  const auto *entry = binAt(channel, level, bin);
+  if (entry == nullptr)
+    return {};
+  return {entry[0].load(std::memory_order_relaxed),
+          entry[1].load(std::memory_order_relaxed)};
+}
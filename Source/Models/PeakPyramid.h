@@ -0,0 +1,92 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+class LoopBuffer;
+
+/**
+ * PeakPyramid - Min/max summary of a layer's audio at several resolutions
+ *
+ * Level 0 holds the min and max of every 64 samples, and each level above
+ * covers 8 times as many (512, then 4096). The writer refreshes the bins it
+ * touches as it writes, so a display of any width reads a few bins per pixel
+ * instead of scanning the audio. Bins are atomics: readers on other threads
+ * may see a range mid-update but never block the writer.
+ *
+ * The bins live with the audio: every page of a LoopBuffer carries the bins
+ * that cover it, so the pyramid takes memory only for pages that have been
+ * written, and a silent page needs none.
+ */
+class PeakPyramid {
+public:
+  static constexpr int numLevels = 3;
+  static constexpr int baseBinSizeLog2 = 6;
+  static constexpr int levelStepLog2 = 3;
+
+  struct Range {
+    float min = 0.0f;
+    float max = 0.0f;
+  };
+
+  explicit PeakPyramid(const LoopBuffer &buffer);
+
+  static constexpr int getBinSizeLog2(int level) {
+    return baseBinSizeLog2 + level * levelStepLog2;
+  }
+
+  // Bins at every level covering `numSamples`, a whole number of the
+  // coarsest bins; a page holds this many
+  static constexpr int getNumBins(int numSamples) {
+    int total = 0;
+    for (int level = 0; level < numLevels; ++level)
+      total += numSamples >> getBinSizeLog2(level);
+    return total;
+  }
+
+  // The coarsest level whose bins fit within `samplesPerPixel`, or -1 if even
+  // level 0 is too coarse and the audio should be read directly
+  static int getLevelFor(double samplesPerPixel);
+
+  // Recompute the bins covering [position, position + numSamples) from the
+  // layer's audio. Doesn't allocate; call from the thread writing the layer.
+  void refresh(int channel, int position, int numSamples);
+
+  // Refresh every bin, for a layer filled in one go
+  void refreshAll();
+
+  // Min and max over [start, end) at the given level, widened to whole bins
+  Range getRange(int channel, int level, int start, int end) const;
+
+private:
+  const LoopBuffer &buffer;
+  std::array<int, numLevels> numBins{};
+
+  // The min and max of a bin, in the bins of the page it covers, or nullptr
+  // while that page is silent
+  std::atomic<float> *binAt(int channel, int level, int bin) const;
+
+  void store(int channel, int level, int bin, Range range);
+  Range load(int channel, int level, int bin) const;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PeakPyramid)
+};
@@ -0,0 +1,83 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Reclaimer.h"
+
+namespace {
+constexpr int reclaimIntervalMs = 50;
+} // namespace
+
+Reclaimer::Reclaimer(const AudioEpoch *epoch) : audioEpoch(epoch) {
+  housekeeping->addTimeSliceClient(this);
+}
+
+Reclaimer::~Reclaimer() {
+  housekeeping->removeTimeSliceClient(this);
+  reclaimNow();
+}
+
+void Reclaimer::push(Retirable *object) {
+  object->retiredAt = audioEpoch != nullptr ? audioEpoch->now() : 0;
+  numPending.fetch_add(1);
+  link(object);
+}
+
+void Reclaimer::link(Retirable *object) {
+  auto *first = head.load(std::memory_order_relaxed);
+  do {
+    object->nextRetired = first;
+  } while (!head.compare_exchange_weak(first, object,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed));
+}
+
+void Reclaimer::reclaimNow() {
+  auto *object = head.exchange(nullptr, std::memory_order_acquire);
+  if (object == nullptr)
+    return;
+
+  // Wait out readers that may have reached these objects before they were
+  // retired. Later readers can't reach them, so the lock isn't held while
+  // deleting (destructors may need locks of their own).
+  { const juce::ScopedWriteLock barrier(readersLock); }
+
+  Retirable *stillVisible = nullptr;
+  while (object != nullptr) {
+    auto *next = object->nextRetired;
+    if (audioEpoch == nullptr || audioEpoch->hasPassed(object->retiredAt)) {
+      delete object;
+      numPending.fetch_sub(1);
+    } else {
+      object->nextRetired = stillVisible;
+      stillVisible = object;
+    }
+    object = next;
+  }
+
+  // Try again next time round
+  while (stillVisible != nullptr) {
+    auto *next = stillVisible->nextRetired;
+    link(stillVisible);
+    stillVisible = next;
+  }
+}
+
+int Reclaimer::useTimeSlice() {
+  reclaimNow();
+  return reclaimIntervalMs;
+}
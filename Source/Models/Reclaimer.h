@@ -0,0 +1,84 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "AudioEpoch.h"
+#include "Housekeeping.h"
+#include <atomic>
+#include <memory>
+
+/**
+ * Retirable - Base for objects that may be handed to a Reclaimer
+ */
+class Retirable {
+public:
+  virtual ~Retirable() = default;
+
+private:
+  friend class Reclaimer;
+  Retirable *nextRetired = nullptr;
+  juce::uint64 retiredAt = 0;
+};
+
+/**
+ * Reclaimer - Frees retired objects on the housekeeping thread
+ *
+ * retire() is a lock-free push that never allocates, so the audio thread can
+ * drop layers (undo, clear) at constant cost no matter how much audio they
+ * hold. The actual destruction, including returning pages to their pool,
+ * happens later on the low-priority HousekeepingThread.
+ *
+ * Other threads that read retirable objects without owning them hold the
+ * readers lock while they do; nothing is freed while it is held. When given
+ * an AudioEpoch, objects are also kept until the audio thread has finished
+ * the block it may have been reading them in.
+ */
+class Reclaimer : private juce::TimeSliceClient {
+public:
+  explicit Reclaimer(const AudioEpoch *audioEpoch = nullptr);
+  ~Reclaimer() override;
+
+  // Call only once the object is unreachable for new readers
+  template <typename ObjectType>
+  void retire(std::unique_ptr<ObjectType> object) {
+    if (object != nullptr)
+      push(object.release());
+  }
+
+  // Free everything retired so far that no reader can still be using
+  void reclaimNow();
+
+  int getNumPending() const { return numPending.load(); }
+
+  const juce::ReadWriteLock &getReadersLock() const { return readersLock; }
+
+private:
+  const AudioEpoch *audioEpoch;
+  std::atomic<Retirable *> head{nullptr};
+  std::atomic<int> numPending{0};
+  juce::ReadWriteLock readersLock;
+
+  juce::SharedResourcePointer<HousekeepingThread> housekeeping;
+
+  void push(Retirable *object);
+  void link(Retirable *object);
+  int useTimeSlice() override;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Reclaimer)
+};
@@ -0,0 +1,260 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RenderPool.h"
+
+#if JUCE_MAC || JUCE_IOS
+#include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+#include <windows.h>
+#else
+#include <cerrno>
+#include <ctime>
+#include <semaphore.h>
+#endif
+
+#if JUCE_INTEL
+#include <immintrin.h>
+#endif
+
+namespace {
+constexpr int spinIterations = 4096;
+constexpr int parkTimeoutMs = 100;
+
+// Tell the core we are spinning, so a sibling hyperthread gets the pipeline
+inline void pauseCpu() {
+#if JUCE_INTEL
+  _mm_pause();
+#elif JUCE_ARM && (defined(__GNUC__) || defined(__clang__))
+  __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * WakeSignal - A semaphore the audio thread can post without locking
+ *
+ * juce::WaitableEvent::signal() takes a mutex, so parked workers wait on the
+ * platform's own semaphore instead, which posts with an atomic and at most a
+ * system call to wake the waiter.
+ */
+class WakeSignal {
+public:
+#if JUCE_MAC || JUCE_IOS
+  WakeSignal() : semaphore(dispatch_semaphore_create(0)) {}
+  ~WakeSignal() { dispatch_release(semaphore); }
+  void post() { dispatch_semaphore_signal(semaphore); }
+  void wait(int timeoutMs) {
+    dispatch_semaphore_wait(
+        semaphore, dispatch_time(DISPATCH_TIME_NOW,
+                                 static_cast<int64_t>(timeoutMs) * 1000000));
+  }
+
+private:
+  dispatch_semaphore_t semaphore;
+#elif JUCE_WINDOWS
+  WakeSignal() : semaphore(CreateSemaphoreW(nullptr, 0, 1 << 30, nullptr)) {}
+  ~WakeSignal() { CloseHandle(semaphore); }
+  void post() { ReleaseSemaphore(semaphore, 1, nullptr); }
+  void wait(int timeoutMs) {
+    WaitForSingleObject(semaphore, static_cast<DWORD>(timeoutMs));
+  }
+
+private:
+  HANDLE semaphore;
+#else
+  WakeSignal() { sem_init(&semaphore, 0, 0); }
+  ~WakeSignal() { sem_destroy(&semaphore); }
+  void post() { sem_post(&semaphore); }
+  void wait(int timeoutMs) {
+    timespec deadline{};
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += static_cast<long>(timeoutMs % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+      ++deadline.tv_sec;
+      deadline.tv_nsec -= 1000000000;
+    }
+    while (sem_timedwait(&semaphore, &deadline) != 0 && errno == EINTR) {
+    }
+  }
+
+private:
+  sem_t semaphore;
+#endif
+
+  JUCE_DECLARE_NON_COPYABLE(WakeSignal)
+};
+} // namespace
+
+class RenderPool::Worker : public juce::Thread {
+public:
+  Worker(RenderPool &p, int participantIndex)
+      : juce::Thread("Looper Render " + juce::String(participantIndex)),
+        pool(p), participant(participantIndex) {}
+
+  ~Worker() override {
+    signalThreadShouldExit();
+    wake.post();
+    stopThread(2000);
+  }
+
+  void run() override {
+    // Leave the first core to the audio thread
+    const int core =
+        participant % juce::jmax(1, juce::SystemStats::getNumCpus());
+    if (core < 32)
+      juce::Thread::setCurrentThreadAffinityMask(juce::uint32(1) << core);
+
+    juce::uint32 seen = pool.round.load(std::memory_order_acquire);
+    while (!threadShouldExit()) {
+      const auto current = pool.waitForRound(seen, *this);
+      if (current == seen)
+        continue;
+
+      seen = current;
+      if (auto *job = pool.currentJob.load(std::memory_order_acquire))
+        pool.work(participant, current, *job);
+    }
+  }
+
+  WakeSignal wake;
+  std::atomic<bool> parked{false}; // set while waiting on `wake`
+
+private:
+  RenderPool &pool;
+  const int participant;
+};
+
+RenderPool::RenderPool(int numWorkers) {
+  numWorkers = juce::jlimit(0, maxParticipants - 1, numWorkers);
+  numParticipants = numWorkers + 1;
+
+  for (int i = 0; i < numWorkers; ++i) {
+    workers.push_back(std::make_unique<Worker>(*this, i + 1));
+  }
+  // Spinning on workers that can be preempted would stall the audio
+  // thread, so without realtime threads everything runs on the caller
+  for (auto &worker : workers) {
+    if (!worker->startRealtimeThread(
+            juce::Thread::RealtimeOptions{}.withPriority(9))) {
+      workers.clear();
+      numParticipants = 1;
+      break;
+    }
+  }
+}
+
+RenderPool::~RenderPool() { workers.clear(); }
+
+void RenderPool::run(Job &job, int numTasks) {
+  if (numTasks <= 0)
+    return;
+
+  const auto forRound = round.load(std::memory_order_relaxed) + 1;
+  currentJob.store(&job, std::memory_order_relaxed);
+  pendingTasks.store(numTasks, std::memory_order_relaxed);
+
+  for (int p = 0; p < numParticipants; ++p) {
+    const int start = numTasks * p / numParticipants;
+    const int end = numTasks * (p + 1) / numParticipants;
+    auto &range = ranges[static_cast<size_t>(p)];
+    range.end.store(end, std::memory_order_relaxed);
+    range.next.store((static_cast<juce::uint64>(forRound) << 32) |
+                         static_cast<juce::uint32>(start),
+                     std::memory_order_release);
+  }
+
+  round.store(forRound);
+
+  // Only pay for a wake-up if a worker has given up spinning
+  if (numParked.load() > 0) {
+    for (auto &worker : workers) {
+      if (worker->parked.exchange(false))
+        worker->wake.post();
+    }
+  }
+
+  work(0, forRound, job);
+
+  // Tasks already claimed by workers still have to finish. They run on
+  // realtime threads, so this is bounded by the longest task.
+  while (pendingTasks.load(std::memory_order_acquire) > 0) {
+    pauseCpu();
+  }
+}
+
+bool RenderPool::claimTask(int participant, juce::uint32 forRound,
+                           int &index) {
+  auto &range = ranges[static_cast<size_t>(participant)];
+  auto current = range.next.load(std::memory_order_acquire);
+
+  while (static_cast<juce::uint32>(current >> 32) == forRound) {
+    const int next = static_cast<int>(static_cast<juce::uint32>(current));
+    if (next >= range.end.load(std::memory_order_relaxed))
+      return false;
+
+    if (range.next.compare_exchange_weak(current, current + 1,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+      index = next;
+      return true;
+    }
+  }
+  return false;
+}
+
+void RenderPool::work(int self, juce::uint32 forRound, Job &job) {
+  int numDone = 0;
+
+  // Own range first, then steal from the others in turn
+  for (int offset = 0; offset < numParticipants; ++offset) {
+    const int victim = (self + offset) % numParticipants;
+    int index = 0;
+    while (claimTask(victim, forRound, index)) {
+      job.runTask(index);
+      ++numDone;
+    }
+  }
+
+  if (numDone > 0)
+    pendingTasks.fetch_sub(numDone, std::memory_order_acq_rel);
+}
+
+juce::uint32 RenderPool::waitForRound(juce::uint32 seen, Worker &worker) {
+  for (int spin = 0; spin < spinIterations; ++spin) {
+    const auto current = round.load(std::memory_order_acquire);
+    if (current != seen)
+      return current;
+    if ((spin & 63) == 63)
+      juce::Thread::yield();
+    else
+      pauseCpu();
+  }
+
+  // Announce the park before the last check, so run() either sees us parked
+  // or we see its new round. A post that lands after a timeout only makes
+  // the next park return early.
+  numParked.fetch_add(1);
+  worker.parked.store(true);
+  if (round.load() == seen)
+    worker.wake.wait(parkTimeoutMs);
+  worker.parked.store(false);
+  numParked.fetch_sub(1);
+
+  return round.load(std::memory_order_acquire);
+}
@@ -0,0 +1,89 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Reclaimer.h"
+#include <array>
+#include <atomic>
+#include <juce_core/juce_core.h>
+#include <memory>
+#include <vector>
+
+/**
+ * RenderPool - Worker threads that share out per-track rendering in a block
+ *
+ * run() deals a job's tasks out in one contiguous range per participant (the
+ * workers plus the calling thread), and anyone who finishes their own range
+ * steals from the others. It neither locks nor allocates while the workers
+ * are awake. Workers are pinned to a core each and spin for a short while
+ * after every job before parking, so back-to-back blocks don't pay for a
+ * wake-up; waking a parked worker posts a semaphore rather than taking a
+ * lock. The workers run as realtime threads, since the caller spins while
+ * they finish; if they can't be started that way the pool has no workers
+ * and run() does every task itself.
+ *
+ * Only one thread may call run() at a time.
+ */
+class RenderPool : public Retirable {
+public:
+  class Job {
+  public:
+    virtual ~Job() = default;
+    virtual void runTask(int index) = 0;
+  };
+
+  explicit RenderPool(int numWorkers);
+  ~RenderPool() override;
+
+  int getNumWorkers() const { return static_cast<int>(workers.size()); }
+
+  // Run job.runTask(i) for every i in [0, numTasks) and return once they
+  // have all finished
+  void run(Job &job, int numTasks);
+
+private:
+  class Worker;
+
+  static constexpr int maxParticipants = 64;
+
+  // A participant's share of the current round. `next` holds the round in
+  // its high 32 bits, so a worker still finishing an earlier round can't
+  // claim tasks from this one.
+  struct alignas(64) Range {
+    std::atomic<juce::uint64> next{0};
+    std::atomic<int> end{0};
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::array<Range, maxParticipants> ranges;
+  int numParticipants = 1;
+
+  std::atomic<Job *> currentJob{nullptr};
+  std::atomic<juce::uint32> round{0};
+  std::atomic<int> pendingTasks{0};
+  std::atomic<int> numParked{0};
+
+  bool claimTask(int participant, juce::uint32 forRound, int &index);
+  void work(int self, juce::uint32 forRound, Job &job);
+
+  // Worker side: wait for a round after `seen`, spinning then parking
+  juce::uint32 waitForRound(juce::uint32 seen, Worker &worker);
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderPool)
+};
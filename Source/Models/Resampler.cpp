@@ -0,0 +1,108 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Resampler.h"
+#include <cmath>
+
+namespace {
+double blackmanHarris(double x) {
+  // x in [-1, 1]
+  const double phase = juce::MathConstants<double>::pi * x;
+  return 0.35875 + 0.48829 * std::cos(phase) + 0.14128 * std::cos(2.0 * phase) +
+         0.01168 * std::cos(3.0 * phase);
+}
+
+double sinc(double x) {
+  if (std::abs(x) < 1.0e-9)
+    return 1.0;
+  const double phase = juce::MathConstants<double>::pi * x;
+  return std::sin(phase) / phase;
+}
+
+// Four independent sums, so the compiler can keep this in vector registers
+float dotProduct(const float *a, const float *b, int numSamples) {
+  float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+  int i = 0;
+  for (; i + 4 <= numSamples; i += 4) {
+    sum0 += a[i] * b[i];
+    sum1 += a[i + 1] * b[i + 1];
+    sum2 += a[i + 2] * b[i + 2];
+    sum3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < numSamples; ++i)
+    sum0 += a[i] * b[i];
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+} // namespace
+
+Resampler::Resampler(double source, double target)
+    : sourceRate(source), targetRate(target) {
+  // Cutoff relative to the source Nyquist frequency; the kernel widens as
+  // the cutoff drops so the transition band stays as steep
+  const double cutoff = juce::jmin(1.0, targetRate / sourceRate) * passband;
+  halfTaps = static_cast<int>(std::ceil(zeroCrossings / cutoff));
+  numTaps = 2 * halfTaps;
+
+  table.resize(static_cast<size_t>((numPhases + 1) * numTaps));
+  for (int phase = 0; phase <= numPhases; ++phase) {
+    const double fraction = static_cast<double>(phase) / numPhases;
+    for (int tap = 0; tap < numTaps; ++tap) {
+      const double x = (tap - halfTaps + 1) - fraction;
+      table[static_cast<size_t>(phase * numTaps + tap)] =
+          static_cast<float>(cutoff * sinc(cutoff * x) *
+                             blackmanHarris(x / halfTaps));
+    }
+  }
+}
+
+int Resampler::convertLength(int length, double fromRate, double toRate) {
+  if (length <= 0 || fromRate <= 0.0 || toRate <= 0.0)
+    return 0;
+  return juce::jmax(1, juce::roundToInt(length * toRate / fromRate));
+}
+
+void Resampler::processLoop(const float *input, int inputLength,
+                            float *output, int outputLength) {
+  if (inputLength <= 0 || outputLength <= 0)
+    return;
+
+  // Wrap the loop around both ends so every kernel window is contiguous
+  padded.resize(static_cast<size_t>(inputLength + 2 * halfTaps));
+  for (int i = 0; i < inputLength + 2 * halfTaps; ++i) {
+    const int source = (i - halfTaps) % inputLength;
+    padded[static_cast<size_t>(i)] =
+        input[source < 0 ? source + inputLength : source];
+  }
+
+  const double step = static_cast<double>(inputLength) / outputLength;
+  for (int i = 0; i < outputLength; ++i) {
+    const double position = i * step;
+    const int base = static_cast<int>(position);
+    const double phasePosition = (position - base) * numPhases;
+    const int phase =
+        juce::jmin(numPhases - 1, static_cast<int>(phasePosition));
+    const auto mix = static_cast<float>(phasePosition - phase);
+
+    // Window covers input[base - halfTaps + 1, base + halfTaps]
+    const float *window = padded.data() + base + 1;
+    const float *row = table.data() + phase * numTaps;
+    const float a = dotProduct(window, row, numTaps);
+    const float b = dotProduct(window, row + numTaps, numTaps);
+    output[i] = a + (b - a) * mix;
+  }
+}
@@ -0,0 +1,63 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+
+/**
+ * Resampler - Offline windowed-sinc sample rate conversion for loop audio
+ *
+ * Uses a Blackman-Harris windowed sinc kernel stored as a polyphase table,
+ * interpolating linearly between neighbouring phases. When converting down,
+ * the cutoff follows the target rate's Nyquist frequency. Input is treated
+ * as one period of a loop, so the kernel wraps around the ends and the seam
+ * stays continuous.
+ */
+class Resampler {
+public:
+  Resampler(double sourceRate, double targetRate);
+
+  double getSourceRate() const { return sourceRate; }
+  double getTargetRate() const { return targetRate; }
+
+  // Length of `length` samples at `fromRate` once converted to `toRate`
+  static int convertLength(int length, double fromRate, double toRate);
+
+  // Resample one channel of a loop: `outputLength` samples spanning exactly
+  // the `inputLength` samples of input
+  void processLoop(const float *input, int inputLength, float *output,
+                   int outputLength);
+
+private:
+  static constexpr int zeroCrossings = 32;
+  static constexpr int numPhases = 256;
+  static constexpr double passband = 0.97;
+
+  double sourceRate;
+  double targetRate;
+  int halfTaps = 0;
+  int numTaps = 0;
+
+  // numPhases + 1 rows of numTaps coefficients
+  std::vector<float> table;
+  std::vector<float> padded;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Resampler)
+};
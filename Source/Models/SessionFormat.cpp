@@ -0,0 +1,215 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SessionFormat.h"
+#include <array>
+#include <cstring>
+
+namespace {
+// Slicing-by-8 tables: table 0 is the usual byte-at-a-time table, and table
+// k advances a byte through k more zero bytes
+using CrcTables = std::array<std::array<juce::uint32, 256>, 8>;
+
+constexpr CrcTables makeCrcTables() {
+  CrcTables tables{};
+  for (juce::uint32 i = 0; i < 256; ++i) {
+    juce::uint32 crc = i;
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xedb88320u : crc >> 1;
+    tables[0][i] = crc;
+  }
+  for (size_t k = 1; k < tables.size(); ++k)
+    for (size_t i = 0; i < 256; ++i)
+      tables[k][i] = (tables[k - 1][i] >> 8) ^
+                     tables[0][tables[k - 1][i] & 0xff];
+  return tables;
+}
+
+constexpr auto crcTables = makeCrcTables();
+
+juce::uint32 readUint32(const char *bytes) {
+  juce::uint32 value = 0;
+  for (int i = 3; i >= 0; --i)
+    value = (value << 8) | static_cast<juce::uint8>(bytes[i]);
+  return value;
+}
+} // namespace
+
+bool SessionFormat::hasMagic(const void *data, size_t numBytes) {
+  return data != nullptr && numBytes >= headerSize &&
+         std::memcmp(data, magic, sizeof(magic)) == 0;
+}
+
+juce::uint32 SessionFormat::updateCrc(juce::uint32 crc, const void *data,
+                                      size_t numBytes) {
+  const auto *bytes = static_cast<const char *>(data);
+  const auto &t = crcTables;
+  crc = ~crc;
+
+  // Eight bytes per step
+  for (; numBytes >= 8; bytes += 8, numBytes -= 8) {
+    const juce::uint32 low = readUint32(bytes) ^ crc;
+    const juce::uint32 high = readUint32(bytes + 4);
+    crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^
+          t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^ t[3][high & 0xff] ^
+          t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^
+          t[0][high >> 24];
+  }
+
+  for (; numBytes > 0; ++bytes, --numBytes)
+    crc = t[0][(crc ^ static_cast<juce::uint8>(*bytes)) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+
+SessionWriter::SessionWriter(juce::OutputStream &s) : stream(s) {
+  ok = stream.write(SessionFormat::magic, sizeof(SessionFormat::magic)) &&
+       stream.writeInt(SessionFormat::version);
+}
+
+void SessionWriter::beginChunk(juce::uint32 id) {
+  jassert(chunkStart < 0);
+  ok = stream.writeInt(static_cast<int>(id)) && stream.writeInt(0) && ok;
+  chunkStart = stream.getPosition();
+  crc = 0;
+}
+
+void SessionWriter::endChunk() {
+  jassert(chunkStart >= 0);
+  const auto end = stream.getPosition();
+  const auto size = end - chunkStart;
+  jassert(size <= static_cast<juce::int64>(0xffffffffu));
+
+  ok = stream.writeInt(static_cast<int>(crc)) && ok;
+  const auto next = stream.getPosition();
+
+  // Go back and fill in the payload size
+  ok = stream.setPosition(chunkStart - 4) &&
+       stream.writeInt(static_cast<int>(static_cast<juce::uint32>(size))) &&
+       stream.setPosition(next) && ok;
+  jassert(ok);
+  chunkStart = -1;
+}
+
+void SessionWriter::write(const void *data, size_t numBytes) {
+  jassert(chunkStart >= 0);
+  crc = SessionFormat::updateCrc(crc, data, numBytes);
+  ok = stream.write(data, numBytes) && ok;
+}
+
+void SessionWriter::writeInt(int value) {
+  const auto bits = static_cast<juce::uint32>(value);
+  const char bytes[4] = {static_cast<char>(bits), static_cast<char>(bits >> 8),
+                         static_cast<char>(bits >> 16),
+                         static_cast<char>(bits >> 24)};
+  write(bytes, sizeof(bytes));
+}
+
+void SessionWriter::writeFloat(float value) {
+  juce::uint32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  writeInt(static_cast<int>(bits));
+}
+
+void SessionWriter::writeDouble(double value) {
+  juce::uint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  writeInt(static_cast<int>(static_cast<juce::uint32>(bits)));
+  writeInt(static_cast<int>(static_cast<juce::uint32>(bits >> 32)));
+}
+
+void SessionWriter::writeBool(bool value) {
+  const char byte = value ? 1 : 0;
+  write(&byte, 1);
+}
+
+void SessionWriter::writeFloats(const float *samples, int numSamples) {
+#if JUCE_BIG_ENDIAN
+  for (int i = 0; i < numSamples; ++i)
+    writeFloat(samples[i]);
+#else
+  write(samples, sizeof(float) * static_cast<size_t>(numSamples));
+#endif
+}
+
+void SessionWriter::writeSilence(int numSamples) {
+  static const float zeros[256] = {};
+  while (numSamples > 0) {
+    const int count = juce::jmin(numSamples, 256);
+    write(zeros, sizeof(float) * static_cast<size_t>(count));
+    numSamples -= count;
+  }
+}
+
+void SessionWriter::finish() {
+  beginChunk(SessionFormat::endId);
+  endChunk();
+  stream.flush();
+}
+
+bool SessionReader::Chunk::isIntact() const {
+  return SessionFormat::updateCrc(0, data, size) == crc;
+}
+
+SessionReader::SessionReader(const void *d, size_t n)
+    : data(static_cast<const char *>(d)), numBytes(n) {
+  if (SessionFormat::hasMagic(data, numBytes)) {
+    const auto version =
+        static_cast<int>(readUint32(data + sizeof(SessionFormat::magic)));
+    valid = version >= 1 && version <= SessionFormat::version;
+  }
+}
+
+bool SessionReader::readChunkAt(size_t offset, Chunk &chunk,
+                                size_t &nextOffset) const {
+  if (!valid || offset > numBytes ||
+      numBytes - offset < SessionFormat::chunkOverhead)
+    return false;
+
+  chunk.id = readUint32(data + offset);
+  chunk.size = readUint32(data + offset + 4);
+  if (chunk.size > numBytes - offset - SessionFormat::chunkOverhead)
+    return false;
+
+  chunk.data = data + offset + 8;
+  chunk.crc = readUint32(chunk.data + chunk.size);
+  nextOffset = offset + SessionFormat::chunkOverhead + chunk.size;
+  return true;
+}
+
+bool SessionReader::next(Chunk &chunk) {
+  size_t nextOffset = 0;
+  if (ended || !readChunkAt(position, chunk, nextOffset))
+    return false;
+
+  position = nextOffset;
+  ended = chunk.id == SessionFormat::endId;
+  return !ended;
+}
+
+bool SessionReader::find(juce::uint32 id, Chunk &chunk) const {
+  size_t offset = SessionFormat::headerSize;
+  size_t nextOffset = 0;
+  while (readChunkAt(offset, chunk, nextOffset)) {
+    if (chunk.id == id)
+      return true;
+    if (chunk.id == SessionFormat::endId)
+      return false;
+    offset = nextOffset;
+  }
+  return false;
+}
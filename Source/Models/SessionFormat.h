@@ -0,0 +1,161 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/**
+ * SessionFormat - Binary container for saved sessions
+ *
+ * A session starts with an 8-byte magic and a format version, followed by
+ * chunks laid out as
+ *
+ *   id (4 bytes) | payload size (uint32) | payload | CRC-32 of the payload
+ *
+ * Integers are little-endian and samples little-endian float32. Readers skip
+ * chunks they don't know, so new chunks can be added without a new version;
+ * the version only changes when an existing chunk's layout does.
+ *
+ * Chunks, in order:
+ *   PARM  the processor's parameters, as a binary ValueTree
+ *   JRNL  the name of the instance's crash journal, as UTF-8
+ *   SESS  sample rate, base loop length and track count
+ *   TRAK  a track's id, volume and solo state
+ *   LAYR  one per layer of the track before it: length, whether it has
+ *         content, its sample rate and channel count, then its samples
+ *         channel by channel
+ *   LAYC  a LAYR whose samples are LayerCodec frames, one per page of
+ *         each channel, instead of raw floats
+ *   END   the end of the session
+ */
+namespace SessionFormat {
+constexpr juce::uint32 makeId(const char (&name)[5]) {
+  return static_cast<juce::uint32>(static_cast<juce::uint8>(name[0])) |
+         static_cast<juce::uint32>(static_cast<juce::uint8>(name[1])) << 8 |
+         static_cast<juce::uint32>(static_cast<juce::uint8>(name[2])) << 16 |
+         static_cast<juce::uint32>(static_cast<juce::uint8>(name[3])) << 24;
+}
+
+constexpr char magic[8] = {'L', 'O', 'O', 'P', 'S', 'E', 'S', 'S'};
+constexpr int version = 1;
+
+constexpr juce::uint32 parametersId = makeId("PARM");
+constexpr juce::uint32 journalId = makeId("JRNL");
+constexpr juce::uint32 sessionId = makeId("SESS");
+constexpr juce::uint32 trackId = makeId("TRAK");
+constexpr juce::uint32 layerId = makeId("LAYR");
+constexpr juce::uint32 compressedLayerId = makeId("LAYC");
+constexpr juce::uint32 endId = makeId("END ");
+
+// Bytes before the first chunk, and around each chunk's payload
+constexpr size_t headerSize = sizeof(magic) + 4;
+constexpr size_t chunkOverhead = 12;
+
+// True if `data` starts with a session header, of any version
+bool hasMagic(const void *data, size_t numBytes);
+
+// CRC-32 (IEEE) of `numBytes` bytes, continuing from `crc`
+juce::uint32 updateCrc(juce::uint32 crc, const void *data, size_t numBytes);
+} // namespace SessionFormat
+
+/**
+ * SessionWriter - Writes a session to a stream chunk by chunk
+ *
+ * Payloads are written straight to the stream between beginChunk() and
+ * endChunk(), which then goes back to fill in the size, so the stream must
+ * support setPosition(). Nothing is buffered.
+ */
+class SessionWriter {
+public:
+  // Writes the header
+  explicit SessionWriter(juce::OutputStream &stream);
+
+  void beginChunk(juce::uint32 id);
+  void endChunk();
+
+  // Payload, little-endian
+  void write(const void *data, size_t numBytes);
+  void writeInt(int value);
+  void writeFloat(float value);
+  void writeDouble(double value);
+  void writeBool(bool value);
+  void writeFloats(const float *samples, int numSamples);
+  void writeSilence(int numSamples);
+
+  // Writes the end chunk
+  void finish();
+
+  // False if any write failed
+  bool wasSuccessful() const { return ok; }
+
+private:
+  juce::OutputStream &stream;
+  juce::int64 chunkStart = -1;
+  juce::uint32 crc = 0;
+  bool ok = true;
+
+  JUCE_DECLARE_NON_COPYABLE(SessionWriter)
+};
+
+/**
+ * SessionReader - Walks the chunks of a session held in memory
+ *
+ * Chunks point into the caller's data, which must outlive the reader.
+ * Checksums are only computed when asked for, so skipping over chunks is
+ * cheap.
+ */
+class SessionReader {
+public:
+  struct Chunk {
+    juce::uint32 id = 0;
+    const char *data = nullptr;
+    size_t size = 0;
+    juce::uint32 crc = 0;
+
+    // True if the payload matches its checksum
+    bool isIntact() const;
+  };
+
+  SessionReader(const void *data, size_t numBytes);
+
+  // False unless the data holds a session header of a version this build
+  // can read
+  bool isValid() const { return valid; }
+
+  // Step to the next chunk. False at the end chunk, or where the data runs
+  // out or a chunk overruns it.
+  bool next(Chunk &chunk);
+
+  // True once next() has reached the end chunk
+  bool reachedEnd() const { return ended; }
+
+  // Find the first chunk with the given id, independently of next()
+  bool find(juce::uint32 id, Chunk &chunk) const;
+
+private:
+  const char *data;
+  size_t numBytes;
+  size_t position = SessionFormat::headerSize;
+  bool valid = false;
+  bool ended = false;
+
+  bool readChunkAt(size_t offset, Chunk &chunk, size_t &nextOffset) const;
+
+  JUCE_DECLARE_NON_COPYABLE(SessionReader)
+};
@@ -0,0 +1,336 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SessionJournal.h"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+std::mutex openFilesMutex;
+std::vector<juce::File> openFiles;
+} // namespace
+
+SessionJournal::SessionJournal(const juce::File &journalFile,
+                               Capture captureSession, Encode encodeLayer)
+    : juce::Thread("Looper Journal"), file(journalFile),
+      capture(std::move(captureSession)), encode(std::move(encodeLayer)) {
+  const std::lock_guard<std::mutex> lock(openFilesMutex);
+  openFiles.push_back(file);
+}
+
+SessionJournal::~SessionJournal() {
+  // Never cut short: the last pass leaves the file complete
+  stopThread(-1);
+
+  const std::lock_guard<std::mutex> lock(openFilesMutex);
+  const auto found = std::find(openFiles.begin(), openFiles.end(), file);
+  if (found != openFiles.end())
+    openFiles.erase(found);
+}
+
+bool SessionJournal::isOpen(const juce::File &file) {
+  const std::lock_guard<std::mutex> lock(openFilesMutex);
+  return std::find(openFiles.cbegin(), openFiles.cend(), file) !=
+         openFiles.cend();
+}
+
+void SessionJournal::start() {
+  if (!isThreadRunning())
+    startThread(juce::Thread::Priority::low);
+}
+
+bool SessionJournal::sync(int timeoutMs) {
+  const auto request = ++syncRequested;
+  notify();
+
+  const auto deadline = juce::Time::getMillisecondCounter() +
+                        static_cast<juce::uint32>(juce::jmax(0, timeoutMs));
+  while (static_cast<juce::int32>(synced.load() - request) < 0) {
+    const auto now = juce::Time::getMillisecondCounter();
+    if (failed.load() || !isThreadRunning() ||
+        static_cast<juce::int32>(deadline - now) <= 0)
+      return false;
+    syncedEvent.wait(static_cast<int>(
+        juce::jmin(deadline - now, static_cast<juce::uint32>(scanIntervalMs))));
+  }
+  return !failed.load();
+}
+
+void SessionJournal::run() {
+  // Nothing from an earlier file is trusted: start from the live session
+  bool ok = file.getParentDirectory().createDirectory() && rewrite();
+
+  while (ok && !threadShouldExit()) {
+    const auto requested = syncRequested.load();
+    ok = update();
+    if (ok && fileBytes > 2 * liveBytes + rewriteSlack)
+      ok = rewrite();
+
+    const auto now = juce::Time::getMillisecondCounter();
+    if (ok && (requested != synced.load() ||
+               (unsynced && now - lastSync >= syncIntervalMs))) {
+      ok = syncFile();
+      synced = requested;
+      syncedEvent.signal();
+    }
+
+    if (ok)
+      wait(scanIntervalMs);
+  }
+
+  if (ok)
+    ok = update() && syncFile();
+  stream.reset();
+  failed = !ok;
+  syncedEvent.signal();
+}
+
+bool SessionJournal::update() {
+  Snapshot snapshot;
+  capture(snapshot);
+
+  const int trackCount = static_cast<int>(snapshot.tracks.size());
+  if (snapshot.sampleRate != writtenRate ||
+      snapshot.loopLength != writtenLoopLength ||
+      trackCount != writtenTrackCount) {
+    payload.reset();
+    payload.writeDouble(snapshot.sampleRate);
+    payload.writeInt(snapshot.loopLength);
+    payload.writeInt(trackCount);
+    if (!writeRecord(SessionFormat::sessionId))
+      return false;
+    writtenRate = snapshot.sampleRate;
+    writtenLoopLength = snapshot.loopLength;
+    writtenTrackCount = trackCount;
+  }
+
+  // Tracks removed
+  for (auto it = written.begin(); it != written.end();) {
+    const int id = it->first;
+    if (std::any_of(snapshot.tracks.cbegin(), snapshot.tracks.cend(),
+                    [id](const Track &track) { return track.id == id; })) {
+      ++it;
+      continue;
+    }
+
+    payload.reset();
+    payload.writeInt(id);
+    if (!writeRecord(removeId))
+      return false;
+    for (const auto &layer : it->second.layers)
+      liveBytes -= layer.second;
+    it = written.erase(it);
+  }
+
+  for (const auto &track : snapshot.tracks) {
+    auto found = written.find(track.id);
+    if (found == written.end() || found->second.volume != track.volume ||
+        found->second.soloed != track.soloed) {
+      payload.reset();
+      payload.writeInt(track.id);
+      payload.writeFloat(track.volume);
+      payload.writeBool(track.soloed);
+      if (!writeRecord(SessionFormat::trackId))
+        return false;
+      found = written.emplace(track.id, Written{}).first;
+      found->second.volume = track.volume;
+      found->second.soloed = track.soloed;
+    }
+
+    // Usually nothing has changed
+    auto &layers = found->second.layers;
+    if (layers.size() == track.layers.size() &&
+        std::equal(layers.cbegin(), layers.cend(), track.layers.cbegin(),
+                   [](const auto &layer, juce::uint32 serial) {
+                     return layer.first == serial;
+                   }))
+      continue;
+
+    // Layers undone or cleared
+    for (auto it = layers.begin(); it != layers.end();) {
+      if (std::find(track.layers.cbegin(), track.layers.cend(), it->first) !=
+          track.layers.cend()) {
+        ++it;
+        continue;
+      }
+
+      payload.reset();
+      payload.writeInt(track.id);
+      payload.writeInt(static_cast<int>(it->first));
+      if (!writeRecord(dropId))
+        return false;
+      liveBytes -= it->second;
+      it = layers.erase(it);
+    }
+
+    // Layers finished since the last pass; one gone meanwhile is dropped
+    // from the next snapshot anyway
+    for (const auto serial : track.layers) {
+      if (std::any_of(layers.cbegin(), layers.cend(),
+                      [serial](const auto &layer) {
+                        return layer.first == serial;
+                      }) ||
+          !encode(track.id, serial, layerData))
+        continue;
+
+      payload.reset();
+      payload.writeInt(track.id);
+      payload.writeInt(static_cast<int>(serial));
+      payload.write(layerData.getData(), layerData.getSize());
+      if (!writeRecord(layerId))
+        return false;
+
+      const auto bytes = static_cast<juce::int64>(payload.getDataSize());
+      layers.emplace_back(serial, bytes);
+      liveBytes += bytes;
+    }
+  }
+  return true;
+}
+
+bool SessionJournal::rewrite() {
+  // Written beside the old file, which stays whole until the new one is
+  // complete and on disk
+  stream.reset();
+  const auto temp = file.getSiblingFile(file.getFileName() + ".new");
+  temp.deleteFile();
+  stream = std::make_unique<juce::FileOutputStream>(temp, 0);
+  if (stream->failedToOpen())
+    return false;
+
+  written.clear();
+  writtenRate = 0.0;
+  writtenLoopLength = -1;
+  writtenTrackCount = -1;
+  liveBytes = 0;
+
+  record.reset();
+  record.write(SessionFormat::magic, sizeof(SessionFormat::magic));
+  record.writeInt(SessionFormat::version);
+  if (!stream->write(record.getData(), record.getDataSize()))
+    return false;
+  fileBytes = static_cast<juce::int64>(record.getDataSize());
+
+  if (!update() || !syncFile())
+    return false;
+  stream.reset();
+  if (!temp.replaceFileIn(file))
+    return false;
+
+  // Unbuffered, so each record goes to the file in the write that makes it
+  stream = std::make_unique<juce::FileOutputStream>(file, 0);
+  return stream->openedOk();
+}
+
+bool SessionJournal::writeRecord(juce::uint32 id) {
+  const auto size = payload.getDataSize();
+  record.reset();
+  record.writeInt(static_cast<int>(id));
+  record.writeInt(static_cast<int>(static_cast<juce::uint32>(size)));
+  record.write(payload.getData(), size);
+  record.writeInt(static_cast<int>(
+      SessionFormat::updateCrc(0, payload.getData(), size)));
+  if (!stream->write(record.getData(), record.getDataSize()))
+    return false;
+
+  fileBytes += static_cast<juce::int64>(record.getDataSize());
+  unsynced = true;
+  return true;
+}
+
+bool SessionJournal::syncFile() {
+  stream->flush();
+  lastSync = juce::Time::getMillisecondCounter();
+  unsynced = false;
+  return stream->getStatus().wasOk();
+}
+
+bool SessionJournal::read(const void *data, size_t numBytes,
+                          Contents &contents) {
+  SessionReader reader(data, numBytes);
+  if (!reader.isValid())
+    return false;
+
+  struct Replayed {
+    Contents::Track track;
+    std::vector<juce::uint32> serials;
+  };
+  std::vector<Replayed> tracks;
+  const auto findTrack = [&tracks](int id) {
+    return std::find_if(tracks.begin(), tracks.end(),
+                        [id](const Replayed &t) { return t.track.id == id; });
+  };
+
+  // A damaged record was cut short by a crash; nothing after it was written
+  // whole, so stop there
+  bool hasSession = false;
+  SessionReader::Chunk chunk;
+  while (reader.next(chunk) && chunk.isIntact()) {
+    juce::MemoryInputStream input(chunk.data, chunk.size, false);
+    if (chunk.id == SessionFormat::sessionId) {
+      contents.sampleRate = input.readDouble();
+      contents.loopLength = input.readInt();
+      hasSession = true;
+    } else if (chunk.id == SessionFormat::trackId) {
+      const int id = input.readInt();
+      auto found = findTrack(id);
+      if (found == tracks.end()) {
+        tracks.emplace_back();
+        found = std::prev(tracks.end());
+        found->track.id = id;
+      }
+      found->track.volume = input.readFloat();
+      found->track.soloed = input.readBool();
+    } else if (chunk.id == removeId) {
+      const auto found = findTrack(input.readInt());
+      if (found != tracks.end())
+        tracks.erase(found);
+    } else if ((chunk.id == layerId || chunk.id == dropId) &&
+               chunk.size >= 8) {
+      const auto found = findTrack(input.readInt());
+      const auto serial = static_cast<juce::uint32>(input.readInt());
+      if (found == tracks.end())
+        continue;
+
+      auto &serials = found->serials;
+      auto &layers = found->track.layers;
+      if (chunk.id == layerId) {
+        SessionReader::Chunk layer;
+        layer.id = SessionFormat::compressedLayerId;
+        layer.data = chunk.data + 8;
+        layer.size = chunk.size - 8;
+        layers.push_back(layer);
+        serials.push_back(serial);
+      } else {
+        const auto at = std::find(serials.begin(), serials.end(), serial);
+        if (at != serials.end()) {
+          layers.erase(layers.begin() + (at - serials.begin()));
+          serials.erase(at);
+        }
+      }
+    }
+  }
+
+  if (!hasSession || contents.sampleRate <= 0.0)
+    return false;
+
+  contents.tracks.clear();
+  for (auto &replayed : tracks)
+    contents.tracks.push_back(std::move(replayed.track));
+  return true;
+}
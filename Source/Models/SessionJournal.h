@@ -0,0 +1,170 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SessionFormat.h"
+#include <atomic>
+#include <functional>
+#include <juce_core/juce_core.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * SessionJournal - Crash-safe, append-only record of a session on disk
+ *
+ * A low-priority thread looks at the session a few times a second and
+ * appends whatever changed since it last looked: each layer once, when it
+ * is finished, and a note when a layer or track goes away. Records are
+ * SessionFormat chunks after a session header, so a record cut short by a
+ * crash fails its checksum and everything before it still reads back.
+ *
+ * Chunks, in the order things happened:
+ *   SESS  as in a session: sample rate, base loop length and track count
+ *   TRAK  as in a session, when a track appears or its controls change
+ *   JLAY  a finished layer: track id, serial, then a LAYC payload
+ *   JDRP  a layer undone or cleared: track id and serial
+ *   JDEL  a track removed: its id
+ *
+ * Each record reaches the file in a single write, so it survives the host
+ * crashing as soon as it is written. The file is only synced to disk every
+ * few seconds, when asked to, and when it is rewritten. Once most of the
+ * file is layers that have gone, it is rewritten from the live session and
+ * swapped in.
+ */
+class SessionJournal : private juce::Thread {
+public:
+  // The session as it stands, listing only finished layers, by serial
+  struct Track {
+    int id = 0;
+    float volume = 1.0f;
+    bool soloed = false;
+    std::vector<juce::uint32> layers;
+  };
+
+  struct Snapshot {
+    double sampleRate = 0.0;
+    int loopLength = 0;
+    std::vector<Track> tracks;
+  };
+
+  // Fills an empty snapshot; called on the journal's thread
+  using Capture = std::function<void(Snapshot &snapshot)>;
+
+  // The LAYC payload of a layer, or false if it has gone since the capture
+  using Encode = std::function<bool(int trackId, juce::uint32 serial,
+                                    juce::MemoryBlock &payload)>;
+
+  SessionJournal(const juce::File &file, Capture capture, Encode encode);
+
+  // Brings the file up to date, syncs it and closes it; the file stays
+  ~SessionJournal() override;
+
+  // Replace the file with the session as it stands, then keep it up to
+  // date. The directory is created if need be.
+  void start();
+
+  // Wait until everything finished before the call is in the file and
+  // synced to disk. False on a timeout or once writing has failed.
+  bool sync(int timeoutMs);
+
+  // True once a write has failed; the journal stops there
+  bool hasFailed() const { return failed.load(); }
+
+  const juce::File &getFile() const { return file; }
+
+  // True while a journal in this process is writing `file`
+  static bool isOpen(const juce::File &file);
+
+  // What a journal holds: the session as of its last intact record, with
+  // each track's layers as LAYC chunks pointing into the journal's data.
+  // Their records were checked, so their checksums are left unset.
+  struct Contents {
+    struct Track {
+      int id = 0;
+      float volume = 1.0f;
+      bool soloed = false;
+      std::vector<SessionReader::Chunk> layers;
+    };
+
+    double sampleRate = 0.0;
+    int loopLength = 0;
+    std::vector<Track> tracks;
+  };
+
+  // Replay a journal held in memory. False if it isn't one or holds no
+  // session yet.
+  static bool read(const void *data, size_t numBytes, Contents &contents);
+
+  static constexpr juce::uint32 layerId = SessionFormat::makeId("JLAY");
+  static constexpr juce::uint32 dropId = SessionFormat::makeId("JDRP");
+  static constexpr juce::uint32 removeId = SessionFormat::makeId("JDEL");
+
+private:
+  static constexpr int scanIntervalMs = 100;
+  static constexpr juce::uint32 syncIntervalMs = 5000;
+
+  // Rewrite once the file holds this much more than twice the live layers
+  static constexpr juce::int64 rewriteSlack = 64 * 1024 * 1024;
+
+  juce::File file;
+  Capture capture;
+  Encode encode;
+
+  // What the file holds, as last written (journal thread)
+  struct Written {
+    float volume = 1.0f;
+    bool soloed = false;
+    std::vector<std::pair<juce::uint32, juce::int64>> layers; // serial, bytes
+  };
+  std::map<int, Written> written;
+  double writtenRate = 0.0;
+  int writtenLoopLength = -1;
+  int writtenTrackCount = -1;
+
+  std::unique_ptr<juce::FileOutputStream> stream;
+  juce::int64 fileBytes = 0;
+  juce::int64 liveBytes = 0;
+  bool unsynced = false;
+  juce::uint32 lastSync = 0;
+
+  juce::MemoryOutputStream payload;
+  juce::MemoryOutputStream record;
+  juce::MemoryBlock layerData;
+
+  std::atomic<bool> failed{false};
+  std::atomic<juce::uint32> syncRequested{0};
+  std::atomic<juce::uint32> synced{0};
+  juce::WaitableEvent syncedEvent;
+
+  void run() override;
+
+  // Append records for whatever changed since the last pass
+  bool update();
+
+  // Write the live session to a new file and swap it in for the old one
+  bool rewrite();
+
+  // Frame `payload` as a chunk and append it in one write
+  bool writeRecord(juce::uint32 id);
+
+  bool syncFile();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SessionJournal)
+};
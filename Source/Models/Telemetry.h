@@ -0,0 +1,87 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "LevelMeter.h"
+#include "TrackHandle.h"
+#include <array>
+#include <juce_core/juce_core.h>
+
+/**
+ * TrackTelemetry - One track's state as of the end of an audio block
+ */
+struct TrackTelemetry {
+  int trackId = -1;
+  TrackHandle handle;
+
+  // Controls as last requested, which is what the UI shows, and a version
+  // that changes whenever any of them do
+  juce::uint32 version = 0;
+  float volume = 0.0f;
+  bool soloed = false;
+  bool recording = false;
+  bool playing = false;
+
+  int numLoops = 0;
+  int recordingLength = 0;
+  juce::uint32 contentGeneration = 0;
+
+  // Playback level after volume
+  MeterReading meter;
+};
+
+/**
+ * TelemetrySnapshot - Everything the UI polls, published once per block
+ *
+ * The audio thread fills one at the end of every processBlock() (or the
+ * thread applying commands does, while audio is stopped), so the UI never
+ * has to touch the tracks or their loopers to redraw. TrackManager holds no
+ * more than maxTracks tracks, so every one is reported, and the entries are
+ * indexed by the tracks' handles.
+ */
+struct TelemetrySnapshot {
+  static constexpr int maxTracks = 128;
+
+  int numTracks = 0; // entries filled in `tracks`, in track order
+  std::array<TrackTelemetry, maxTracks> tracks{};
+
+  // Index in `tracks` by handle slot, or -1
+  std::array<int, maxTracks> bySlot{};
+
+  int baseLoopLength = 0;
+  int readPosition = 0;
+  bool anyPlaying = false;
+  bool anyRecording = false;
+
+  // Level of the output, monitored input included
+  MeterReading master;
+
+  // Bumped with every snapshot published
+  juce::uint64 sequence = 0;
+
+  // The entry for the track a handle names, or nullptr if it has gone
+  const TrackTelemetry *findTrack(TrackHandle handle) const {
+    if (handle.isNull() || handle.slot >= maxTracks)
+      return nullptr;
+    const int index = bySlot[handle.slot];
+    if (index < 0 || tracks[static_cast<size_t>(index)].handle != handle)
+      return nullptr;
+    return &tracks[static_cast<size_t>(index)];
+  }
+};
@@ -23,44 +23,99 @@ Track::Track(int id, TrackManager &tm) : trackId(id), trackManager(tm) {}
 
 Track::~Track() {}
 
-void Track::prepare(double sampleRate) {
+void Track::prepare(double sampleRate, int maxBlockSize) {
   currentSampleRate = sampleRate;
   looper.prepare(sampleRate);
+  renderBus.setSize(2, juce::jmax(1, maxBlockSize));
 }
 
 void Track::startRecording() {
-  if (!recording.load()) {
-    recording.store(true);
-    looper.startRecording(trackManager.getReadPosition(),
-                          trackManager.getBaseLoopLength());
-  }
+  show(recording, true);
+  trackManager.postCommand({TrackCommand::Type::startRecording, trackId});
 }
 
 void Track::stopRecording() {
-  if (recording.load()) {
-    int recordedLength = looper.getRecordingLength();
-    recording.store(false);
-    looper.stopRecording(trackManager.getBaseLoopLength());
-
-    if (recordedLength > 0 && trackManager.getBaseLoopLength() == 0) {
-      trackManager.setBaseLoopLength(recordedLength);
-    }
-  }
+  show(recording, false);
+  trackManager.postCommand({TrackCommand::Type::stopRecording, trackId});
 }
 
 void Track::startPlayback() {
-  playing.store(true);
-  looper.startPlayback();
+  show(playing, true);
+  trackManager.postCommand({TrackCommand::Type::startPlayback, trackId});
 }
 
 void Track::stopPlayback() {
-  playing.store(false);
+  show(playing, false);
+  trackManager.postCommand({TrackCommand::Type::stopPlayback, trackId});
+}
+
+void Track::setVolume(float vol) {
+  vol = juce::jlimit(0.0f, 1.0f, vol);
+  show(volume, vol);
+  trackManager.postCommand({TrackCommand::Type::setVolume, trackId, vol});
+}
+
+void Track::setSoloed(bool solo) {
+  show(soloed, solo);
+  trackManager.postCommand(
+      {TrackCommand::Type::setSolo, trackId, solo ? 1.0f : 0.0f});
+}
+
+void Track::restoreControls(float vol, bool solo) {
+  show(volume, juce::jlimit(0.0f, 1.0f, vol));
+  show(soloed, solo);
+  appliedVolume = volume.load();
+  appliedSoloed = solo;
+}
+
+void Track::clearAll() {
+  show(recording, false);
+  trackManager.postCommand({TrackCommand::Type::clear, trackId});
+}
+
+void Track::undoLast() {
+  show(recording, false);
+  trackManager.postCommand({TrackCommand::Type::undo, trackId});
+}
+
+void Track::beginRecording() {
+  show(recording, true);
+  looper.startRecording(trackManager.getReadPosition(),
+                        trackManager.getBaseLoopLength());
+}
+
+void Track::finishRecording() {
+  show(recording, false);
+  if (!looper.isRecording())
+    return;
+
+  int recordedLength = looper.getRecordingLength();
+  looper.stopRecording(trackManager.getBaseLoopLength());
+
+  if (recordedLength > 0 && trackManager.getBaseLoopLength() == 0) {
+    trackManager.setBaseLoopLength(recordedLength);
+  }
+}
+
+void Track::beginPlayback() {
+  show(playing, true);
+  looper.startPlayback();
+}
+
+void Track::endPlayback() {
+  show(playing, false);
   looper.stopPlayback();
 }
 
-void Track::clearAll() { looper.clearAll(); }
+void Track::applyVolume(float vol) {
+  appliedVolume = vol;
+  show(volume, vol);
+}
 
-void Track::undoLast() { looper.removeLastLoop(); }
+void Track::applySolo(bool solo) {
+  appliedSoloed = solo;
+  show(soloed, solo);
+}
 
 int Track::getReadPosition() const {
   return trackManager.getWrappedReadPosition();
@@ -69,15 +124,3 @@ int Track::getReadPosition() const {
 int Track::getBaseLoopLength() const {
   return trackManager.getBaseLoopLength();
 }
-
-bool Track::shouldOutput(bool anyTrackSoloed) const {
-  if (anyTrackSoloed)
-    return soloed.load();
-  return true;
-}
-
-float Track::getEffectiveVolume(bool anyTrackSoloed) const {
-  if (!shouldOutput(anyTrackSoloed))
-    return 0.0f;
-  return volume.load();
-}
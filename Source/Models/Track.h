@@ -19,6 +19,7 @@
 #pragma once
 
 #include "Looper.h"
+#include "TrackHandle.h"
 #include <atomic>
 
 class TrackManager;
@@ -31,14 +32,18 @@ class TrackManager;
  * - Mute
  * - Solo
  * - Record (only one track can record at a time)
+ *
+ * The public controls can be called from any thread without locking: they
+ * update the state shown to the UI and post a command to the TrackManager,
+ * which carries it out on the audio thread at a known point in the block.
  */
-class Track {
+class Track : public Retirable {
 public:
   Track(int trackId, TrackManager &trackManager);
-  ~Track();
+  ~Track() override;
 
-  // Initialize the track
-  void prepare(double sampleRate);
+  // Initialize the track; maxBlockSize sizes its parallel render bus
+  void prepare(double sampleRate, int maxBlockSize);
 
   // Track controls
   void startRecording();
@@ -50,13 +55,19 @@ public:
   bool isPlaying() const { return playing; }
 
   // Volume control (0.0 to 1.0)
-  void setVolume(float vol) { volume.store(juce::jlimit(0.0f, 1.0f, vol)); }
+  void setVolume(float vol);
   float getVolume() const { return volume.load(); }
 
   // Solo control
-  void setSoloed(bool solo) { soloed.store(solo); }
+  void setSoloed(bool solo);
   bool isSoloed() const { return soloed.load(); }
 
+  // Set volume and solo before the track is added, without posting commands
+  void restoreControls(float vol, bool solo);
+
+  // Changes whenever any of the displayed controls above change
+  juce::uint32 getStateVersion() const { return stateVersion.load(); }
+
   // Access the underlying looper
   Looper &getLooper() { return looper; }
   const Looper &getLooper() const { return looper; }
@@ -65,30 +76,54 @@ public:
   int getId() const { return trackId; }
   juce::String getName() const { return "Track " + juce::String(trackId + 1); }
 
+  // Stable reference to this track; null until it is added to a manager
+  TrackHandle getHandle() const { return handle; }
+
   int getReadPosition() const;
   int getBaseLoopLength() const;
 
-  // Clear and undo
+  // Clear and undo (both stop recording first)
   void clearAll();
   void undoLast();
-  void requestClearAll() { looper.requestClearAll(); }
-  void requestUndoLast() { looper.requestUndoLast(); }
-  // Process audio for this track
-  // Returns true if this track should contribute to output
-  bool shouldOutput(bool anyTrackSoloed) const;
-
-  // Get effective volume considering mute/solo state
-  float getEffectiveVolume(bool anyTrackSoloed) const;
 
 private:
+  friend class TrackManager;
+
   int trackId;
+  TrackHandle handle; // set by TrackManager before the track is published
   TrackManager &trackManager;
   Looper looper;
 
+  // State as last requested, for display and host parameters
   std::atomic<float> volume{0.7f};
   std::atomic<bool> soloed{false};
   std::atomic<bool> recording{false};
   std::atomic<bool> playing{false};
+  std::atomic<juce::uint32> stateVersion{0};
+
+  // Update a displayed value, bumping the version if it changed
+  template <typename ValueType>
+  void show(std::atomic<ValueType> &field, ValueType value) {
+    if (field.exchange(value) != value)
+      stateVersion.fetch_add(1);
+  }
+
+  // State the audio is rendered with, changed only by applied commands.
+  // TrackManager keeps a copy in its TrackControls for the mix.
+  float appliedVolume = 0.7f;
+  bool appliedSoloed = false;
+
+  // Applied by TrackManager on the audio thread (or any one thread while
+  // audio is stopped)
+  void beginRecording();
+  void finishRecording();
+  void beginPlayback();
+  void endPlayback();
+  void applyVolume(float vol);
+  void applySolo(bool solo);
+
+  // Playback rendered on a worker thread, summed by the audio thread
+  juce::AudioBuffer<float> renderBus;
 
   double currentSampleRate = 44100.0;
 
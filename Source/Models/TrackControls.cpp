@@ -0,0 +1,72 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TrackControls.h"
+
+void TrackControls::resize(int newNumTracks) {
+  numTracks = juce::jmax(0, newNumTracks);
+  const auto numWords =
+      static_cast<size_t>((numTracks + bitsPerWord - 1) / bitsPerWord);
+
+  volumes.assign(static_cast<size_t>(numTracks), 0.0f);
+  playingBits.assign(numWords, 0);
+  soloedBits.assign(numWords, 0);
+  recordingBits.assign(numWords, 0);
+  audibleBits.assign(numWords, 0);
+  audible.assign(static_cast<size_t>(numTracks), 0);
+  numSoloed = 0;
+  numPlaying = 0;
+  numRecording = 0;
+}
+
+void TrackControls::set(int index, float volume, bool soloed, bool playing,
+                        bool recording) {
+  jassert(index >= 0 && index < numTracks);
+  volumes[static_cast<size_t>(index)] = volume;
+  numSoloed += assign(soloedBits, index, soloed);
+  numPlaying += assign(playingBits, index, playing);
+  numRecording += assign(recordingBits, index, recording);
+  assign(audibleBits, index, playing && volume > 0.0f);
+}
+
+int TrackControls::collectAudible() {
+  // With anything soloed, only soloed tracks are heard
+  const bool anySoloed = isAnySoloed();
+  int count = 0;
+  for (size_t word = 0; word < audibleBits.size(); ++word) {
+    auto bits = audibleBits[word];
+    if (anySoloed)
+      bits &= soloedBits[word];
+    for (; bits != 0; bits &= bits - 1)
+      audible[static_cast<size_t>(count++)] =
+          static_cast<int>(word) * bitsPerWord + lowestBit(bits);
+  }
+  return count;
+}
+
+int TrackControls::assign(std::vector<juce::uint64> &bits, int index,
+                          bool value) {
+  auto &word = bits[static_cast<size_t>(index / bitsPerWord)];
+  const auto mask = juce::uint64{1} << (index % bitsPerWord);
+  const bool wasSet = (word & mask) != 0;
+  if (value)
+    word |= mask;
+  else
+    word &= ~mask;
+  return static_cast<int>(value) - static_cast<int>(wasSet);
+}
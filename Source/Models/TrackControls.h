@@ -0,0 +1,100 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+
+/**
+ * TrackControls - The tracks' mix controls as the audio thread applies them
+ *
+ * Holds the volume of every track in one array and whether each is playing,
+ * soloed, recording and audible (playing with some volume) in bitmaps, all
+ * by the track's position in the list, along with how many are soloed,
+ * playing and recording. The mix reads these instead of visiting every
+ * Track, so finding which tracks to record and play is a scan over a few
+ * words per 64 tracks.
+ *
+ * resize() allocates; everything else is real-time safe.
+ */
+class TrackControls {
+public:
+  // Room for numTracks tracks, all silent, stopped and unsoloed
+  void resize(int numTracks);
+  int size() const { return numTracks; }
+
+  // Set one track's controls, keeping the bitmaps and counts up to date
+  void set(int index, float volume, bool soloed, bool playing,
+           bool recording);
+
+  float getVolume(int index) const {
+    return volumes[static_cast<size_t>(index)];
+  }
+  bool isSoloed(int index) const { return test(soloedBits, index); }
+  bool isPlaying(int index) const { return test(playingBits, index); }
+  bool isRecording(int index) const { return test(recordingBits, index); }
+
+  bool isAnySoloed() const { return numSoloed > 0; }
+  bool isAnyPlaying() const { return numPlaying > 0; }
+  bool isAnyRecording() const { return numRecording > 0; }
+
+  // List the tracks that would be heard, in order, and return how many.
+  // getAudible() reads the list until the next call.
+  int collectAudible();
+  int getAudible(int position) const {
+    return audible[static_cast<size_t>(position)];
+  }
+
+  // Call function(index) for each recording track, in order. It may change
+  // the controls of the track it is given.
+  template <typename Function> void forEachRecording(Function &&function) {
+    for (size_t word = 0; word < recordingBits.size(); ++word) {
+      for (auto bits = recordingBits[word]; bits != 0; bits &= bits - 1)
+        function(static_cast<int>(word) * bitsPerWord + lowestBit(bits));
+    }
+  }
+
+private:
+  static constexpr int bitsPerWord = 64;
+
+  static bool test(const std::vector<juce::uint64> &bits, int index) {
+    return (bits[static_cast<size_t>(index / bitsPerWord)] >>
+            (index % bitsPerWord)) &
+           1u;
+  }
+
+  // Set or clear a bit, returning +1, -1 or 0 for the change in the count
+  static int assign(std::vector<juce::uint64> &bits, int index, bool value);
+
+  static int lowestBit(juce::uint64 bits) {
+    return juce::countNumberOfBits((bits & (0 - bits)) - 1);
+  }
+
+  int numTracks = 0;
+  std::vector<float> volumes;
+  std::vector<juce::uint64> playingBits;
+  std::vector<juce::uint64> soloedBits;
+  std::vector<juce::uint64> recordingBits;
+  std::vector<juce::uint64> audibleBits; // playing with a volume above 0
+  int numSoloed = 0;
+  int numPlaying = 0;
+  int numRecording = 0;
+
+  std::vector<int> audible; // filled by collectAudible()
+};
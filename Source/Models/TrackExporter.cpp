@@ -0,0 +1,147 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TrackExporter.h"
+
+namespace {
+std::unique_ptr<juce::AudioFormat> createFormat(TrackExporter::Format format) {
+  if (format == TrackExporter::Format::flac)
+    return std::make_unique<juce::FlacAudioFormat>();
+  return std::make_unique<juce::WavAudioFormat>();
+}
+} // namespace
+
+TrackExporter::TrackExporter(const Options &exportOptions,
+                             std::vector<Stem> stemsToWrite,
+                             int samplesToWrite, double rate,
+                             Render renderBlock)
+    : juce::Thread("Looper Export"), options(exportOptions),
+      stems(std::move(stemsToWrite)), numSamples(samplesToWrite),
+      sampleRate(rate), render(std::move(renderBlock)) {}
+
+TrackExporter::~TrackExporter() {
+  // Never cut short: the writers still have to close their files
+  stopThread(-1);
+  writerThread.stopThread(-1);
+}
+
+bool TrackExporter::start() {
+  if (running.load() || numSamples <= 0 ||
+      !options.folder.createDirectory())
+    return false;
+
+  const auto format = createFormat(options.format);
+  // FLAC stops at 24 bits
+  const int bits = options.format == Format::flac
+                       ? juce::jmin(options.bitsPerSample, 24)
+                       : options.bitsPerSample;
+  const auto extension =
+      options.format == Format::flac ? juce::String(".flac") : ".wav";
+
+  std::vector<juce::String> names;
+  for (const auto &stem : stems)
+    names.push_back(stem.name);
+  if (options.includeMaster)
+    names.push_back("Master");
+
+  for (const auto &name : names) {
+    auto file = options.folder.getChildFile(
+        juce::File::createLegalFileName(name) + extension);
+    // Output streams append to an existing file
+    file.deleteFile();
+
+    auto stream = file.createOutputStream();
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (stream != nullptr)
+      writer.reset(format->createWriterFor(
+          stream.get(), sampleRate, static_cast<unsigned int>(numChannels),
+          bits, {}, 0));
+    if (writer == nullptr) {
+      file.deleteFile();
+      writers.clear();
+      deleteFiles();
+      return false;
+    }
+
+    // The writer owns the stream now
+    stream.release();
+    files.push_back(file);
+    writers.push_back(
+        std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(
+            writer.release(), writerThread, writerBufferSize));
+  }
+
+  running = true;
+  writerThread.startThread(juce::Thread::Priority::low);
+  startThread(juce::Thread::Priority::low);
+  return true;
+}
+
+void TrackExporter::run() {
+  std::vector<juce::AudioBuffer<float>> stemBlocks(
+      stems.size(), juce::AudioBuffer<float>(numChannels, blockSize));
+  juce::AudioBuffer<float> master(numChannels, blockSize);
+
+  bool complete = true;
+  for (int done = 0; done < numSamples;) {
+    const int len = juce::jmin(blockSize, numSamples - done);
+    for (auto &block : stemBlocks)
+      block.setSize(numChannels, len, false, false, true);
+    master.setSize(numChannels, len, false, false, true);
+    complete = render(done, stemBlocks, master);
+
+    for (size_t i = 0; i < stemBlocks.size() && complete; ++i)
+      complete = write(*writers[i], stemBlocks[i]);
+    if (options.includeMaster && complete)
+      complete = write(*writers.back(), master);
+    if (!complete || threadShouldExit()) {
+      complete = false;
+      break;
+    }
+
+    done += len;
+    progress = static_cast<float>(done) / static_cast<float>(numSamples);
+  }
+
+  // Writes out whatever is still buffered and closes the files
+  writers.clear();
+  if (!complete)
+    deleteFiles();
+
+  succeeded = complete;
+  progress = 1.0f;
+  running = false;
+}
+
+bool TrackExporter::write(juce::AudioFormatWriter::ThreadedWriter &writer,
+                          const juce::AudioBuffer<float> &block) {
+  while (!writer.write(block.getArrayOfReadPointers(),
+                       block.getNumSamples())) {
+    // The disk is behind; the writer thread drains the buffer meanwhile
+    if (threadShouldExit())
+      return false;
+    wait(5);
+  }
+  return true;
+}
+
+void TrackExporter::deleteFiles() {
+  for (const auto &file : files)
+    file.deleteFile();
+  files.clear();
+}
@@ -0,0 +1,116 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_core/juce_core.h>
+#include <memory>
+#include <vector>
+
+/**
+ * TrackExporter - Writes tracks and a master mix to audio files in the
+ * background
+ *
+ * One export per instance. A low-priority thread renders the audio a block
+ * at a time through a callback from the owner and hands it to
+ * juce::AudioFormatWriter::ThreadedWriter, which encodes and writes it on a
+ * second thread, so the export runs as fast as the disk allows and never
+ * waits on the audio thread.
+ */
+class TrackExporter : private juce::Thread {
+public:
+  enum class Format { wav, flac };
+
+  struct Options {
+    juce::File folder; // created if it doesn't exist
+    Format format = Format::wav;
+    int bitsPerSample = 24;
+    int numCycles = 1; // times round the loop
+    bool includeMaster = true;
+  };
+
+  // One file per stem, named after it
+  struct Stem {
+    int trackId = 0;
+    juce::String name;
+  };
+
+  // Fills one buffer per stem, in order, and the master with the audio
+  // from `position`; every buffer is already sized to the block. Returns
+  // false if the audio can no longer be rendered as it began, which
+  // abandons the export.
+  using Render =
+      std::function<bool(int position,
+                         std::vector<juce::AudioBuffer<float>> &stems,
+                         juce::AudioBuffer<float> &master)>;
+
+  TrackExporter(const Options &options, std::vector<Stem> stems,
+                int numSamples, double sampleRate, Render render);
+
+  // Cancels an export still running and waits for its files to be closed
+  ~TrackExporter() override;
+
+  // Create the files and start writing. False, leaving nothing behind, if
+  // any of them can't be created.
+  bool start();
+
+  // Stop early and delete the files written so far
+  void cancel() { signalThreadShouldExit(); }
+
+  bool isRunning() const { return running.load(); }
+
+  // Share of the audio written, from 0 to 1
+  float getProgress() const { return progress.load(); }
+
+  // True once an export has written every file in full
+  bool hasSucceeded() const { return succeeded.load(); }
+
+  static constexpr int numChannels = 2;
+
+private:
+  static constexpr int blockSize = 8192;
+  static constexpr int writerBufferSize = 8 * blockSize;
+
+  Options options;
+  std::vector<Stem> stems;
+  int numSamples;
+  double sampleRate;
+  Render render;
+
+  std::vector<juce::File> files;
+  std::vector<std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter>>
+      writers;
+  juce::TimeSliceThread writerThread{"Looper Export Writer"};
+
+  std::atomic<bool> running{false};
+  std::atomic<bool> succeeded{false};
+  std::atomic<float> progress{0.0f};
+
+  void run() override;
+
+  // Queue a block on a writer, waiting while its buffer is full
+  bool write(juce::AudioFormatWriter::ThreadedWriter &writer,
+             const juce::AudioBuffer<float> &block);
+
+  void deleteFiles();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackExporter)
+};
@@ -0,0 +1,43 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/**
+ * TrackHandle - A stable reference to a track
+ *
+ * Names a slot in TrackManager's track table and the generation of the
+ * track that took it. A slot freed by a removal is reused, but with a new
+ * generation, so a handle to a removed track never resolves to another
+ * one. The default handle names no track.
+ */
+struct TrackHandle {
+  juce::uint32 slot = 0;
+  juce::uint32 generation = 0; // never 0 for a live track
+
+  bool isNull() const { return generation == 0; }
+
+  bool operator==(const TrackHandle &other) const {
+    return slot == other.slot && generation == other.generation;
+  }
+  bool operator!=(const TrackHandle &other) const {
+    return !(*this == other);
+  }
+};
@@ -17,22 +17,142 @@
  */
 
 #include "TrackManager.h"
+#include "Resampler.h"
 #include "Track.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+// Threads encoding or restoring layers alongside the calling thread
+constexpr int maxSessionThreads = 7;
+
+// Run task(0) to task(numTasks - 1) across the calling thread and a few
+// low-priority helpers, returning once all of them have
+void runInParallel(int numTasks, const std::function<void(int)> &task) {
+  std::atomic<int> nextTask{0};
+  auto work = [&] {
+    for (int i; (i = nextTask.fetch_add(1)) < numTasks;)
+      task(i);
+  };
+
+  const int numHelpers = juce::jlimit(
+      0, maxSessionThreads,
+      juce::jmin(numTasks, juce::SystemStats::getNumCpus()) - 1);
+  if (numHelpers == 0) {
+    work();
+    return;
+  }
 
-TrackManager::TrackManager() {}
+  // Outlive the pool, which may still be returning from the last job
+  std::atomic<int> running{numHelpers};
+  juce::WaitableEvent finished;
+  juce::ThreadPool pool(juce::ThreadPoolOptions{}
+                            .withThreadName("Looper Session")
+                            .withNumberOfThreads(numHelpers)
+                            .withDesiredThreadPriority(
+                                juce::Thread::Priority::low));
+  for (int i = 0; i < numHelpers; ++i) {
+    pool.addJob([&] {
+      work();
+      if (--running == 0)
+        finished.signal();
+    });
+  }
 
-TrackManager::~TrackManager() {}
+  work();
+  finished.wait();
+}
+} // namespace
 
-void TrackManager::prepare(double sampleRate) {
+TrackManager::TrackManager() { publishTracks(); }
+
+TrackManager::~TrackManager() {
+  journal.reset();
+  exporter.reset();
+  delete renderPool.exchange(nullptr);
+  delete trackList.exchange(nullptr);
+}
+
+void TrackManager::prepare(double sampleRate, int maximumBlockSize) {
   const std::lock_guard<std::mutex> lock(tracksMutex);
+  const double previousRate = currentSampleRate;
   currentSampleRate = sampleRate;
   maxLoopLength = static_cast<int>(sampleRate * 60.0);
-  baseLoopLength.store(0);
-  readPosition.store(0);
+  maxBlockSize = juce::jmax(1, maximumBlockSize);
+
+  // Audio is stopped, so nothing else is driving the tracks
+  for (auto &track : tracks) {
+    track->finishRecording();
+  }
+  fillControls();
+
+  // Loops survive a rate change; convert the shared timing the same way the
+  // tracks convert their layers
+  if (!hasAnyLoopsInternal()) {
+    baseLoopLength.store(0);
+    readPosition.store(0);
+  } else if (previousRate != sampleRate) {
+    const int base = Resampler::convertLength(baseLoopLength.load(),
+                                              previousRate, sampleRate);
+    baseLoopLength.store(base);
+    readPosition.store(base > 0 ? Resampler::convertLength(
+                                      readPosition.load(), previousRate,
+                                      sampleRate) % base
+                                : 0);
+  }
 
   for (auto &track : tracks) {
-    track->prepare(sampleRate);
+    track->prepare(sampleRate, maxBlockSize);
+  }
+  masterMeter.prepare(sampleRate);
+  publishTelemetry(0);
+  audioActive.store(true);
+}
+
+void TrackManager::release() {
+  const std::lock_guard<std::mutex> lock(tracksMutex);
+  audioActive.store(false);
+  drainCommands();
+}
+
+bool TrackManager::postCommand(const TrackCommand &command) {
+  if (!commands.push(command)) {
+    numDroppedCommands.fetch_add(1);
+    return false;
+  }
+
+  // With no audio thread to pick it up, apply it here. Check again under
+  // the lock: prepare() may have started audio in the meantime.
+  if (!audioActive.load()) {
+    const std::lock_guard<std::mutex> lock(tracksMutex);
+    if (!audioActive.load())
+      drainCommands();
   }
+  return true;
+}
+
+void TrackManager::setParallelRendering(int numWorkers, int minTracks) {
+  parallelThreshold.store(juce::jmax(1, minTracks));
+
+  // Starting threads allocates, so build the pool here; the audio thread may
+  // still be using the old one until its next block
+  std::unique_ptr<RenderPool> pool;
+  if (numWorkers > 0)
+    pool = std::make_unique<RenderPool>(numWorkers);
+
+  // Without realtime workers the pool is no faster than mixing serially
+  if (pool != nullptr && pool->getNumWorkers() == 0)
+    pool.reset();
+
+  std::unique_ptr<RenderPool> previous(
+      renderPool.exchange(pool.release(), std::memory_order_acq_rel));
+  reclaimer.retire(std::move(previous));
+}
+
+int TrackManager::getNumRenderWorkers() const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  const auto *pool = renderPool.load(std::memory_order_acquire);
+  return pool != nullptr ? pool->getNumWorkers() : 0;
 }
 
 void TrackManager::setBaseLoopLength(int length) {
@@ -68,320 +188,622 @@ int TrackManager::getWrappedReadPosition() const {
 
 Track *TrackManager::addTrack() {
   const std::lock_guard<std::mutex> lock(tracksMutex);
+  if (tracks.size() >= maxTracks)
+    return nullptr;
+
   auto track = std::make_unique<Track>(nextTrackId++, *this);
-  track->prepare(currentSampleRate);
+  track->prepare(currentSampleRate, maxBlockSize);
+  takeSlot(*track);
 
   Track *trackPtr = track.get();
   tracks.push_back(std::move(track));
+  publishTracks();
   return trackPtr;
 }
 
 void TrackManager::removeTrack(int trackId) {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  auto it = std::find_if(tracks.begin(), tracks.end(),
-                         [trackId](const std::unique_ptr<Track> &t) {
-                           return t->getId() == trackId;
-                         });
-
-  if (it != tracks.end()) {
-    if ((*it)->isRecording())
-      (*it)->stopRecording();
-    if ((*it)->isPlaying())
-      (*it)->stopPlayback();
+  bool anyLoopsLeft = true;
+  {
+    const std::lock_guard<std::mutex> lock(tracksMutex);
+    auto it = std::find_if(tracks.begin(), tracks.end(),
+                           [trackId](const std::unique_ptr<Track> &t) {
+                             return t->getId() == trackId;
+                           });
+    if (it == tracks.end())
+      return;
 
+    // The audio thread may still be using the track until its next block
+    auto removed = std::move(*it);
     tracks.erase(it);
+    releaseSlot(*removed);
+    publishTracks();
+    reclaimer.retire(std::move(removed));
+    anyLoopsLeft = hasAnyLoopsInternal();
+  }
 
-    // Check if any tracks still have content
-    bool hasContent = false;
-    for (const auto &track : tracks) {
-      if (track->getLooper().hasLoops()) {
-        hasContent = true;
-        break;
-      }
-    }
-
-    if (!hasContent) {
-      resetBaseLoopLength();
-      stopAllPlaybackInternal();
-    }
+  // Check if any tracks still have content
+  if (!anyLoopsLeft) {
+    resetBaseLoopLength();
+    postCommand({TrackCommand::Type::stopAll});
   }
 }
 
 void TrackManager::removeAllTracks() {
   const std::lock_guard<std::mutex> lock(tracksMutex);
+  auto removed = std::move(tracks);
   tracks.clear();
+  for (const auto &track : removed)
+    releaseSlot(*track);
+  publishTracks();
+  for (auto &track : removed) {
+    reclaimer.retire(std::move(track));
+  }
   resetBaseLoopLength();
   nextTrackId = 0;
 }
 
 std::vector<Track *> TrackManager::getTracks() const {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  std::vector<Track *> copies;
-  copies.reserve(tracks.size());
-  for (auto &track : tracks) {
-    copies.push_back(track.get());
-  }
-  return copies;
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  return currentTracks();
 }
 
 int TrackManager::getTrackCount() const {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  return static_cast<int>(tracks.size());
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  return static_cast<int>(currentTracks().size());
 }
 
 Track *TrackManager::findTrack(int trackId) {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
   return findTrackInternal(trackId);
 }
 
 Track *TrackManager::findTrackInternal(int trackId) const {
-  auto it = std::find_if(tracks.begin(), tracks.end(),
-                         [trackId](const std::unique_ptr<Track> &t) {
-                           return t->getId() == trackId;
-                         });
+  const int index = findTrackIndexInternal(trackId);
+  return index >= 0 ? currentTracks()[static_cast<size_t>(index)] : nullptr;
+}
 
-  return (it != tracks.end()) ? it->get() : nullptr;
+int TrackManager::findTrackIndexInternal(int trackId) const {
+  const auto &byId = currentList().byId;
+  const auto found = byId.find(trackId);
+  return found != byId.end() ? found->second : -1;
 }
 
-// Track Controls
+TrackHandle TrackManager::getTrackHandle(int trackId) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  const auto *track = findTrackInternal(trackId);
+  return track != nullptr ? track->getHandle() : TrackHandle{};
+}
 
-bool TrackManager::startRecordingTrack(int trackId) {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  Track *track = findTrackInternal(trackId);
-  if (track != nullptr) {
-    // Stop any other track that's recording (only one at a time)
-    stopAllRecordingInternal();
+std::vector<TrackHandle> TrackManager::getTrackHandles() const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  std::vector<TrackHandle> handles;
+  for (const auto *track : currentTracks())
+    handles.push_back(track->getHandle());
+  return handles;
+}
 
-    track->startRecording();
+Track *TrackManager::resolve(TrackHandle handle) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  return resolveInternal(handle);
+}
 
-    if (!track->isPlaying()) {
-      startPlaybackTrackInternal(trackId);
-      return true;
-    }
-  }
-  return false;
+bool TrackManager::withTrack(TrackHandle handle,
+                             const std::function<void(Track &)> &use) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  auto *track = resolveInternal(handle);
+  if (track == nullptr)
+    return false;
+
+  use(*track);
+  return true;
 }
 
-void TrackManager::stopRecordingTrack(int trackId) {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  Track *track = findTrackInternal(trackId);
-  if (track != nullptr) {
-    track->stopRecording();
+Track *TrackManager::resolveInternal(TrackHandle handle) const {
+  const auto &list = currentList().slots;
+  if (handle.isNull() || handle.slot >= list.size())
+    return nullptr;
+
+  auto *track = list[handle.slot];
+  return track != nullptr && track->getHandle() == handle ? track : nullptr;
+}
+
+void TrackManager::takeSlot(Track &track) {
+  juce::uint32 index = 0;
+  if (!freeSlots.empty()) {
+    index = freeSlots.back();
+    freeSlots.pop_back();
+  } else {
+    index = static_cast<juce::uint32>(slots.size());
+    slots.emplace_back();
   }
+
+  auto &slot = slots[index];
+  slot.track = &track;
+  if (++slot.generation == 0)
+    slot.generation = 1;
+  track.handle = {index, slot.generation};
 }
 
-void TrackManager::stopAllRecording() {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  stopAllRecordingInternal();
+void TrackManager::releaseSlot(const Track &track) {
+  const auto index = track.getHandle().slot;
+  if (track.getHandle().isNull() || slots[index].track != &track)
+    return;
+
+  slots[index].track = nullptr;
+  freeSlots.push_back(index);
 }
 
-void TrackManager::stopAllRecordingInternal() {
+void TrackManager::publishTracks() {
+  auto list = std::make_unique<TrackList>();
+  list->tracks.reserve(tracks.size());
+  list->byId.reserve(tracks.size());
   for (auto &track : tracks) {
-    if (track->isRecording()) {
-      track->stopRecording();
-    }
+    list->byId.emplace(track->getId(), static_cast<int>(list->tracks.size()));
+    list->tracks.push_back(track.get());
   }
+  list->controls.resize(static_cast<int>(tracks.size()));
+
+  list->slots.reserve(slots.size());
+  for (const auto &slot : slots)
+    list->slots.push_back(slot.track);
+
+  std::unique_ptr<TrackList> previous(
+      trackList.exchange(list.release(), std::memory_order_acq_rel));
+  reclaimer.retire(std::move(previous));
+
+  // Otherwise the audio thread picks the new list up next block
+  if (!audioActive.load())
+    publishTelemetry(0);
 }
 
-void TrackManager::stopAllPlaybackInternal() {
-  for (auto &track : tracks) {
-    track->stopPlayback();
+int TrackManager::collectBlockCommands(int numSamples) {
+  int numCommands = 0;
+  TrackCommand command;
+  while (numCommands < commandQueueSize && commands.pop(command)) {
+    command.sampleOffset = juce::jlimit(0, numSamples, command.sampleOffset);
+
+    // Insertion sort; commands at the same offset keep their posting order
+    int index = numCommands++;
+    while (index > 0 &&
+           blockCommands[static_cast<size_t>(index - 1)].sampleOffset >
+               command.sampleOffset) {
+      blockCommands[static_cast<size_t>(index)] =
+          blockCommands[static_cast<size_t>(index - 1)];
+      --index;
+    }
+    blockCommands[static_cast<size_t>(index)] = command;
   }
+  return numCommands;
 }
 
-void TrackManager::startPlaybackTrack(int trackId) {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  startPlaybackTrackInternal(trackId);
+void TrackManager::drainCommands() {
+  if (!currentList().controlsFilled)
+    fillControls();
+
+  TrackCommand command;
+  while (commands.pop(command)) {
+    applyCommand(command);
+  }
+  publishTelemetry(0);
 }
 
-void TrackManager::startPlaybackTrackInternal(int trackId) {
-  Track *track = findTrackInternal(trackId);
-  if (track != nullptr) {
-    bool wasAnyPlaying = isPlayingInternal();
-    track->startPlayback();
-    if (!wasAnyPlaying) {
-      resetReadPosition();
+void TrackManager::applyCommand(const TrackCommand &command) {
+  using Type = TrackCommand::Type;
+
+  switch (command.type) {
+  case Type::clearAll:
+    // Each track stops recording before it is cleared, so nothing is
+    // written into freshly-emptied loops
+    for (size_t i = 0; i < currentTracks().size(); ++i) {
+      auto *track = currentTracks()[i];
+      track->finishRecording();
+      track->getLooper().clearAll();
+      syncControls(static_cast<int>(i));
+    }
+    resetBaseLoopLength();
+    resetReadPosition();
+    return;
+  case Type::undoLast:
+    if (auto *track = findTrackWithMostRecentLoopInternal()) {
+      stopAllRecordingInternal();
+      track->getLooper().removeLastLoop();
+      resetTimingIfEmpty();
+    }
+    return;
+  case Type::startAll:
+    startAllPlaybackInternal();
+    return;
+  case Type::stopAll:
+    stopAllPlaybackInternal();
+    return;
+  case Type::playAll:
+    if (!isPlayingInternal())
+      startAllPlaybackInternal();
+    return;
+  default:
+    break;
+  }
+
+  const int index = findTrackIndexInternal(command.trackId);
+  if (index < 0)
+    return;
+
+  auto *track = currentTracks()[static_cast<size_t>(index)];
+
+  switch (command.type) {
+  case Type::startRecording:
+    if (track->getLooper().isRecording())
+      return;
+    // Only one track records at a time, and recording starts playback
+    stopAllRecordingInternal();
+    if (!track->getLooper().isPlaying())
+      startPlaybackTrackInternal(*track);
+    track->beginRecording();
+    break;
+  case Type::stopRecording:
+    track->finishRecording();
+    break;
+  case Type::startPlayback:
+    startPlaybackTrackInternal(*track);
+    break;
+  case Type::stopPlayback:
+    track->endPlayback();
+    break;
+  case Type::setSolo:
+    track->applySolo(command.value >= 0.5f);
+    break;
+  case Type::setVolume:
+    track->applyVolume(juce::jlimit(0.0f, 1.0f, command.value));
+    break;
+  case Type::clear:
+    track->finishRecording();
+    track->getLooper().clearAll();
+    resetTimingIfEmpty();
+    break;
+  case Type::undo:
+    track->finishRecording();
+    if (track->getLooper().hasLoops()) {
+      track->getLooper().removeLastLoop();
+      resetTimingIfEmpty();
     }
+    break;
+  default:
+    break;
   }
+  syncControls(index);
 }
 
-void TrackManager::stopPlaybackTrack(int trackId) {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  Track *track = findTrackInternal(trackId);
-  if (track != nullptr) {
-    track->stopPlayback();
+void TrackManager::resetTimingIfEmpty() {
+  if (!hasAnyLoopsInternal()) {
+    resetBaseLoopLength();
+    resetReadPosition();
+    stopAllPlaybackInternal();
   }
 }
 
-void TrackManager::clearTrack(int trackId) {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  Track *track = findTrackInternal(trackId);
-  if (track != nullptr) {
-    if (track->isRecording()) {
-      track->stopRecording();
-    }
+void TrackManager::PlaybackJob::runTask(int index) {
+  const int trackIndex = list->controls.getAudible(index);
+  auto *track = list->tracks[static_cast<size_t>(trackIndex)];
 
-    track->clearAll();
+  juce::AudioBuffer<float> bus(track->renderBus.getArrayOfWritePointers(),
+                               track->renderBus.getNumChannels(), 0,
+                               numSamples);
+  bus.clear();
+  track->getLooper().processPlayback(bus, list->controls.getVolume(trackIndex),
+                                     readPosition, loopLength);
+}
 
-    // Check if any tracks still have content
-    bool hasContent = false;
-    for (const auto &t : tracks) {
-      if (t->getLooper().hasLoops()) {
-        hasContent = true;
-        break;
-      }
+void TrackManager::mixPlayback(juce::AudioBuffer<float> &buffer, int readPos,
+                               int loopLen) {
+  auto &list = currentList();
+  const int numAudible = list.controls.collectAudible();
+  const int numSamples = buffer.getNumSamples();
+  auto *pool = renderPool.load(std::memory_order_acquire);
+
+  if (pool == nullptr || numAudible < parallelThreshold.load() ||
+      numSamples > maxBlockSize) {
+    for (int i = 0; i < numAudible; ++i) {
+      const int index = list.controls.getAudible(i);
+      list.tracks[static_cast<size_t>(index)]->getLooper().processPlayback(
+          buffer, list.controls.getVolume(index), readPos, loopLen);
     }
+    return;
+  }
 
-    if (!hasContent) {
-      resetBaseLoopLength();
-      resetReadPosition();
-      stopAllPlaybackInternal();
+  playbackJob.list = &list;
+  playbackJob.numSamples = numSamples;
+  playbackJob.readPosition = readPos;
+  playbackJob.loopLength = loopLen;
+  pool->run(playbackJob, numAudible);
+
+  // Sum in track order so the result doesn't depend on scheduling
+  const int numChannels = buffer.getNumChannels();
+  for (int i = 0; i < numAudible; ++i) {
+    const auto *track =
+        list.tracks[static_cast<size_t>(list.controls.getAudible(i))];
+    for (int channel = 0;
+         channel < juce::jmin(numChannels, track->renderBus.getNumChannels());
+         ++channel) {
+      buffer.addFrom(channel, 0, track->renderBus, channel, 0, numSamples);
     }
   }
 }
 
-void TrackManager::undoTrack(int trackId) {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  Track *track = findTrackInternal(trackId);
-  if (track != nullptr) {
-    if (track->isRecording()) {
-      track->stopRecording();
-    }
+// Track Controls
+//
+// These run on the message thread. They update the tracks' displayed state
+// straight away and post commands for the audio thread to carry out.
 
-    if (track->getLooper().getNumLoops() == 0) {
-      return;
-    }
+bool TrackManager::startRecordingTrack(int trackId) {
+  Track *track = findTrack(trackId);
+  if (track == nullptr)
+    return false;
+
+  // Stop any other track that's recording (only one at a time)
+  for (auto *other : getTracks()) {
+    if (other != track && other->isRecording())
+      other->stopRecording();
+  }
 
-    track->undoLast();
+  track->startRecording();
+  if (!track->isPlaying()) {
+    track->startPlayback();
+    return true;
+  }
+  return false;
+}
 
-    bool hasContent = false;
-    for (const auto &t : tracks) {
-      if (t->getLooper().hasLoops()) {
-        hasContent = true;
-        break;
-      }
-    }
+void TrackManager::stopRecordingTrack(int trackId) {
+  if (Track *track = findTrack(trackId))
+    track->stopRecording();
+}
 
-    if (!hasContent) {
-      resetBaseLoopLength();
-      resetReadPosition();
-      stopAllPlaybackInternal();
-    }
+void TrackManager::stopAllRecording() {
+  for (auto *track : getTracks()) {
+    if (track->isRecording())
+      track->stopRecording();
   }
 }
 
+void TrackManager::startPlaybackTrack(int trackId) {
+  if (Track *track = findTrack(trackId))
+    track->startPlayback();
+}
+
+void TrackManager::stopPlaybackTrack(int trackId) {
+  if (Track *track = findTrack(trackId))
+    track->stopPlayback();
+}
+
+void TrackManager::clearTrack(int trackId) {
+  if (Track *track = findTrack(trackId))
+    track->clearAll();
+}
+
+void TrackManager::undoTrack(int trackId) {
+  if (Track *track = findTrack(trackId))
+    track->undoLast();
+}
+
 // Global Controls
 
 void TrackManager::requestClearAll() {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  // Stop all recording first so we don't write into freshly-emptied loops
-  stopAllRecordingInternal();
-  for (auto &track : tracks) {
-    track->requestClearAll();
-  }
-  resetBaseLoopLength();
-  resetReadPosition();
+  postCommand({TrackCommand::Type::clearAll});
 }
 
 void TrackManager::requestUndoLast() {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  Track *track = findTrackWithMostRecentLoopInternal();
-  if (track != nullptr) {
-    stopAllRecordingInternal();
+  postCommand({TrackCommand::Type::undoLast});
+}
 
-    if (track->getLooper().getNumLoops() == 0) {
-      return;
-    }
+void TrackManager::startPlayback() {
+  postCommand({TrackCommand::Type::startAll});
+}
 
-    track->undoLast();
+void TrackManager::stopPlayback() {
+  postCommand({TrackCommand::Type::stopAll});
+}
 
-    bool hasContent = false;
-    for (const auto &t : tracks) {
-      if (t->getLooper().hasLoops()) {
-        hasContent = true;
-        break;
-      }
+void TrackManager::playAll() { postCommand({TrackCommand::Type::playAll}); }
+
+bool TrackManager::isPlaying() const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  for (const auto *track : currentTracks()) {
+    if (track->isPlaying()) {
+      return true;
     }
+  }
+  return false;
+}
 
-    if (!hasContent) {
-      resetBaseLoopLength();
-      stopAllPlaybackInternal();
+bool TrackManager::isAnyTrackSoloed() const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  for (const auto *track : currentTracks()) {
+    if (track->isSoloed()) {
+      return true;
     }
   }
+  return false;
 }
 
-void TrackManager::startPlayback() {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
+// Audio-side state
+
+void TrackManager::stopAllRecordingInternal() {
+  const auto &tracksNow = currentTracks();
+  for (size_t i = 0; i < tracksNow.size(); ++i) {
+    tracksNow[i]->finishRecording();
+    syncControls(static_cast<int>(i));
+  }
+}
+
+void TrackManager::stopAllPlaybackInternal() {
+  const auto &tracksNow = currentTracks();
+  for (size_t i = 0; i < tracksNow.size(); ++i) {
+    tracksNow[i]->endPlayback();
+    syncControls(static_cast<int>(i));
+  }
+}
+
+void TrackManager::startAllPlaybackInternal() {
   bool wasAnyPlaying = isPlayingInternal();
-  for (auto &track : tracks) {
-    track->startPlayback();
+  const auto &tracksNow = currentTracks();
+  for (size_t i = 0; i < tracksNow.size(); ++i) {
+    tracksNow[i]->beginPlayback();
+    syncControls(static_cast<int>(i));
   }
   if (!wasAnyPlaying) {
     resetReadPosition();
   }
 }
 
-void TrackManager::stopPlayback() {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  for (auto &track : tracks) {
-    track->stopPlayback();
+void TrackManager::startPlaybackTrackInternal(Track &track) {
+  bool wasAnyPlaying = isPlayingInternal();
+  track.beginPlayback();
+  if (!wasAnyPlaying) {
+    resetReadPosition();
   }
 }
 
-bool TrackManager::isPlaying() const {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  return isPlayingInternal();
+bool TrackManager::isPlayingInternal() const {
+  return currentList().controls.isAnyPlaying();
 }
 
-bool TrackManager::isPlayingInternal() const {
-  for (const auto &track : tracks) {
-    if (track->isPlaying()) {
+bool TrackManager::hasAnyLoopsInternal() const {
+  for (const auto *track : currentTracks()) {
+    if (track->getLooper().hasLoops()) {
       return true;
     }
   }
   return false;
 }
 
-bool TrackManager::isAnyTrackSoloed() const {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
-  return isAnyTrackSoloedInternal();
+void TrackManager::syncControls(int index) {
+  auto &list = currentList();
+  const auto *track = list.tracks[static_cast<size_t>(index)];
+  list.controls.set(index, track->appliedVolume, track->appliedSoloed,
+                    track->getLooper().isPlaying(),
+                    track->getLooper().isRecording());
 }
 
-bool TrackManager::isAnyTrackSoloedInternal() const {
-  for (const auto &track : tracks) {
-    if (track->isSoloed()) {
-      return true;
-    }
-  }
-  return false;
+void TrackManager::fillControls() {
+  auto &list = currentList();
+  for (int i = 0; i < list.controls.size(); ++i)
+    syncControls(i);
+  list.controlsFilled = true;
 }
 
 void TrackManager::processBlock(juce::AudioBuffer<float> &buffer,
                                 bool shouldMonitor) {
-  const std::lock_guard<std::mutex> lock(tracksMutex);
+  const AudioEpoch::Scope audioScope(audioEpoch);
+
+  // A list published since the last block gets its controls filled in here
+  if (!currentList().controlsFilled)
+    fillControls();
+
+  // Handle pending requests for all tracks. A layer imported into an empty
+  // session sets the loop length, as a first recording does.
+  for (auto *track : currentTracks()) {
+    const int importedLength = track->getLooper().handlePendingRequests();
+    if (importedLength > 0 && !hasBaseLoopLength())
+      setBaseLoopLength(importedLength);
+  }
 
-  // Handle pending requests for all tracks
-  for (auto &track : tracks) {
-    track->getLooper().handlePendingRequests();
+  // Split the block wherever a command is due and apply it there
+  const int numSamples = buffer.getNumSamples();
+  const int numCommands = collectBlockCommands(numSamples);
+  int nextCommand = 0;
+  int segmentStart = 0;
+
+  while (segmentStart < numSamples) {
+    while (nextCommand < numCommands &&
+           blockCommands[static_cast<size_t>(nextCommand)].sampleOffset <=
+               segmentStart) {
+      applyCommand(blockCommands[static_cast<size_t>(nextCommand++)]);
+    }
+
+    const int segmentEnd =
+        nextCommand < numCommands
+            ? blockCommands[static_cast<size_t>(nextCommand)].sampleOffset
+            : numSamples;
+    processSegment(buffer, segmentStart, segmentEnd - segmentStart,
+                   shouldMonitor);
+    segmentStart = segmentEnd;
   }
 
-  // Check if any track is soloed
-  bool anySoloed = isAnyTrackSoloedInternal();
+  // Commands due at the very end of the block
+  while (nextCommand < numCommands) {
+    applyCommand(blockCommands[static_cast<size_t>(nextCommand++)]);
+  }
 
-  int loopLen = getBaseLoopLength();
-  int currentPosition = getWrappedReadPosition();
-  bool anyRecording = false;
+  masterMeter.measure(buffer);
+  publishTelemetry(numSamples);
+}
 
-  // First, handle recording for any track that's currently recording
-  for (auto &track : tracks) {
-    if (track->isRecording()) {
-      anyRecording = true;
-      int maxRecordLen = loopLen > 0 ? loopLen : maxLoopLength;
-      track->getLooper().processRecording(buffer, maxRecordLen,
-                                          currentPosition);
-    }
+void TrackManager::publishTelemetry(int numSamples) {
+  auto &snapshot = telemetry.getWriteBuffer();
+  const auto &tracksNow = currentTracks();
+
+  // addTrack() and the restores keep to maxTracks, so every track fits
+  jassert(tracksNow.size() <= maxTracks);
+  snapshot.numTracks = juce::jmin(static_cast<int>(tracksNow.size()),
+                                  TelemetrySnapshot::maxTracks);
+  snapshot.anyPlaying = false;
+  snapshot.anyRecording = false;
+  snapshot.bySlot.fill(-1);
+
+  for (int i = 0; i < snapshot.numTracks; ++i) {
+    auto *track = tracksNow[static_cast<size_t>(i)];
+    auto &looper = track->getLooper();
+    const auto &meter = looper.updateMeter(numSamples);
+    snapshot.anyPlaying = snapshot.anyPlaying || track->isPlaying();
+    snapshot.anyRecording = snapshot.anyRecording || track->isRecording();
+
+    auto &entry = snapshot.tracks[static_cast<size_t>(i)];
+    entry.trackId = track->getId();
+    entry.handle = track->getHandle();
+    if (entry.handle.slot < TelemetrySnapshot::maxTracks)
+      snapshot.bySlot[entry.handle.slot] = i;
+    entry.version = track->getStateVersion();
+    entry.volume = track->getVolume();
+    entry.soloed = track->isSoloed();
+    entry.recording = track->isRecording();
+    entry.playing = track->isPlaying();
+    entry.numLoops = static_cast<int>(looper.getNumLoops());
+    entry.recordingLength = looper.getRecordingLength();
+    entry.contentGeneration = looper.getContentGeneration();
+    entry.meter = meter;
   }
 
+  snapshot.master = masterMeter.update(numSamples);
+
+  snapshot.baseLoopLength = getBaseLoopLength();
+  snapshot.readPosition = getWrappedReadPosition();
+  snapshot.sequence = ++telemetrySequence;
+  telemetry.publish();
+}
+
+void TrackManager::processSegment(juce::AudioBuffer<float> &block,
+                                  int startSample, int numSamples,
+                                  bool shouldMonitor) {
+  // Refers to the block's channels rather than copying them
+  juce::AudioBuffer<float> buffer(block.getArrayOfWritePointers(),
+                                  block.getNumChannels(), startSample,
+                                  numSamples);
+  auto &list = currentList();
+
+  int loopLen = getBaseLoopLength();
+  int currentPosition = getWrappedReadPosition();
+  const bool anyRecording = list.controls.isAnyRecording();
+
+  // First, handle recording for any track that's currently recording. A
+  // track out of layer slots stops by itself.
+  list.controls.forEachRecording([&](int index) {
+    auto &looper = list.tracks[static_cast<size_t>(index)]->getLooper();
+    int maxRecordLen = loopLen > 0 ? loopLen : maxLoopLength;
+    looper.processRecording(buffer, maxRecordLen, currentPosition);
+    if (!looper.isRecording())
+      syncControls(index);
+  });
+
   // If not monitoring, clear the buffer before mixing
   if (!shouldMonitor) {
     buffer.clear();
@@ -389,13 +811,7 @@ void TrackManager::processBlock(juce::AudioBuffer<float> &buffer,
 
   // Mix all track outputs
   int currentReadPos = getWrappedReadPosition();
-  for (auto &track : tracks) {
-    float effectiveVolume = track->getEffectiveVolume(anySoloed);
-    if (effectiveVolume > 0.0f) {
-      track->getLooper().processPlayback(buffer, effectiveVolume,
-                                         currentReadPos, loopLen);
-    }
-  }
+  mixPlayback(buffer, currentReadPos, loopLen);
 
   // Advance the shared read position for synchronized playback/recording
   if (isPlayingInternal() || anyRecording) {
@@ -408,69 +824,429 @@ Track *TrackManager::findTrackWithMostRecentLoopInternal() const {
   Track *result = nullptr;
   size_t maxLoops = 0;
 
-  for (const auto &track : tracks) {
+  for (auto *track : currentTracks()) {
     size_t loopCount = track->getLooper().getNumLoops();
     if (loopCount > maxLoops) {
       maxLoops = loopCount;
-      result = track.get();
+      result = track;
     }
   }
 
   return result;
 }
 
-void TrackManager::getState(juce::ValueTree &state, double sampleRate) const {
+void TrackManager::writeState(SessionWriter &writer, double sampleRate,
+                              bool compressAudio) const {
+  // The published tracks stay alive while the readers lock is held, and
+  // reading them never waits on the audio thread
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  const auto &list = currentTracks();
+
+  // During the first recording, the loop is as long as it has got so far
+  int loopLength = getBaseLoopLength();
+  if (loopLength == 0) {
+    for (const auto *track : list)
+      loopLength =
+          juce::jmax(loopLength, track->getLooper().getRecordingLength());
+  }
+
+  writer.beginChunk(SessionFormat::sessionId);
+  writer.writeDouble(sampleRate);
+  writer.writeInt(loopLength);
+  writer.writeInt(static_cast<int>(list.size()));
+  writer.endChunk();
+
+  // Compressed layers are all encoded up front, then written in order
+  struct EncodedLayer {
+    const Looper *looper;
+    int index;
+    juce::MemoryBlock payload;
+    bool valid = false;
+  };
+  std::vector<EncodedLayer> encoded;
+  if (compressAudio) {
+    for (const auto *track : list) {
+      const auto &looper = track->getLooper();
+      const int count = static_cast<int>(looper.getNumLoops());
+      for (int i = 0; i < count; ++i)
+        encoded.push_back({&looper, i, {}});
+    }
+
+    runInParallel(static_cast<int>(encoded.size()), [&](int i) {
+      auto &layer = encoded[static_cast<size_t>(i)];
+      LayerCodec codec;
+      layer.valid = layer.looper->encodeLayer(layer.index, sampleRate,
+                                              loopLength, codec,
+                                              layer.payload);
+    });
+  }
+
+  auto nextLayer = encoded.cbegin();
+  for (const auto *track : list) {
+    writer.beginChunk(SessionFormat::trackId);
+    writer.writeInt(track->getId());
+    writer.writeFloat(track->getVolume());
+    writer.writeBool(track->isSoloed());
+    writer.endChunk();
+
+    if (!compressAudio) {
+      track->getLooper().writeLayers(writer, sampleRate, loopLength);
+      continue;
+    }
+
+    for (; nextLayer != encoded.cend() &&
+           nextLayer->looper == &track->getLooper();
+         ++nextLayer) {
+      if (!nextLayer->valid)
+        continue;
+      writer.beginChunk(SessionFormat::compressedLayerId);
+      writer.write(nextLayer->payload.getData(),
+                   nextLayer->payload.getSize());
+      writer.endChunk();
+    }
+  }
+}
+
+size_t TrackManager::getStateSizeEstimate() const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  size_t numBytes = 4096;
+  for (const auto *track : currentTracks())
+    numBytes += 256 + track->getLooper().getAllocatedBytes();
+  return numBytes;
+}
+
+bool TrackManager::importLayer(int trackId, const juce::File &file) {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  auto *track = findTrackInternal(trackId);
+  if (track == nullptr)
+    return false;
+
+  track->getLooper().importLayer(file, getBaseLoopLength());
+  return true;
+}
+
+bool TrackManager::isImporting() const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  const auto &list = currentTracks();
+  return std::any_of(list.cbegin(), list.cend(), [](const Track *track) {
+    return track->getLooper().isImporting();
+  });
+}
+
+bool TrackManager::startExport(const TrackExporter::Options &options) {
+  if (isExporting())
+    return false;
+
+  const int loopLength = getBaseLoopLength();
+  const double sampleRate = currentSampleRate;
+  std::vector<TrackExporter::Stem> stems;
+  std::vector<ExportTrack> exportTracks;
+  {
+    // Fix what to render now, so the files don't change partway through
+    const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+    const auto &list = currentTracks();
+    const bool anySoloed =
+        std::any_of(list.cbegin(), list.cend(),
+                    [](const Track *track) { return track->isSoloed(); });
+
+    for (const auto *track : list) {
+      if (track->getLooper().isResampling())
+        return false;
+
+      stems.push_back({track->getId(), track->getName()});
+      ExportTrack exportTrack;
+      exportTrack.trackId = track->getId();
+      exportTrack.volume = track->getVolume();
+      exportTrack.inMaster = !anySoloed || track->isSoloed();
+      track->getLooper().getFinishedLayers(exportTrack.layers);
+      exportTracks.push_back(std::move(exportTrack));
+    }
+  }
+  if (loopLength <= 0 || stems.empty())
+    return false;
+
+  exporter.reset();
+  exporter = std::make_unique<TrackExporter>(
+      options, stems, loopLength * juce::jmax(1, options.numCycles),
+      sampleRate,
+      [this, exportTracks, sampleRate, loopLength](
+          int position, std::vector<juce::AudioBuffer<float>> &stemBlocks,
+          juce::AudioBuffer<float> &master) {
+        return renderExport(exportTracks, sampleRate, position, loopLength,
+                            stemBlocks, master);
+      });
+  return exporter->start();
+}
+
+void TrackManager::cancelExport() {
+  if (exporter != nullptr)
+    exporter->cancel();
+}
+
+bool TrackManager::isExporting() const {
+  return exporter != nullptr && exporter->isRunning();
+}
+
+float TrackManager::getExportProgress() const {
+  return exporter != nullptr ? exporter->getProgress() : 0.0f;
+}
+
+bool TrackManager::hasExportSucceeded() const {
+  return exporter != nullptr && exporter->hasSucceeded();
+}
+
+bool TrackManager::renderExport(
+    const std::vector<ExportTrack> &exportTracks, double sampleRate,
+    int position, int loopLength,
+    std::vector<juce::AudioBuffer<float>> &stemBlocks,
+    juce::AudioBuffer<float> &master) const {
+  // A rate change resamples every layer to another length
+  if (currentSampleRate.load() != sampleRate)
+    return false;
+
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  master.clear();
+  for (size_t i = 0; i < exportTracks.size(); ++i) {
+    const auto &exportTrack = exportTracks[i];
+    const auto *track = findTrackInternal(exportTrack.trackId);
+    auto &block = stemBlocks[i];
+    if (track == nullptr ||
+        !track->getLooper().renderMix(block, position, loopLength,
+                                      exportTrack.layers))
+      return false;
+
+    // The master hears what playback did: soloed tracks only, if any
+    block.applyGain(exportTrack.volume);
+    if (exportTrack.inMaster) {
+      for (int channel = 0; channel < master.getNumChannels(); ++channel)
+        master.addFrom(channel, 0, block, channel, 0, block.getNumSamples());
+    }
+  }
+  return true;
+}
+
+bool TrackManager::readState(SessionReader &reader, double sampleRate,
+                             const std::function<void(double)> &progress) {
   const std::lock_guard<std::mutex> lock(tracksMutex);
-  state.setProperty("baseLoopLength", getBaseLoopLength(), nullptr);
-  state.setProperty("trackCount", static_cast<int>(tracks.size()), nullptr);
+  SessionReader::Chunk chunk;
+
+  // Everything hangs off the session chunk, so give up without it
+  while (reader.next(chunk) && chunk.id != SessionFormat::sessionId)
+    continue;
+  if (chunk.id != SessionFormat::sessionId || !chunk.isIntact())
+    return false;
+
+  juce::MemoryInputStream session(chunk.data, chunk.size, false);
+  const double savedRate = session.readDouble();
+  const int savedBaseLength = session.readInt();
+  if (savedRate <= 0.0)
+    return false;
+
+  // Build the tracks first and gather their layers; a damaged track chunk
+  // drops them, and a damaged layer is left out of its track
+  std::vector<std::unique_ptr<Track>> restored;
+  std::vector<std::vector<SessionReader::Chunk>> layers;
+  Track *current = nullptr;
+  while (reader.next(chunk)) {
+    if (chunk.id == SessionFormat::trackId) {
+      current = nullptr;
+      if (!chunk.isIntact() || restored.size() >= maxTracks)
+        continue;
+
+      juce::MemoryInputStream trackData(chunk.data, chunk.size, false);
+      const int trackId = trackData.readInt();
+      const float volume = trackData.readFloat();
+      const bool soloed = trackData.readBool();
 
-  for (size_t i = 0; i < tracks.size(); ++i) {
-    juce::ValueTree trackState("Track" + juce::String(i));
-    trackState.setProperty("trackId", tracks[i]->getId(), nullptr);
-    trackState.setProperty("volume", tracks[i]->getVolume(), nullptr);
-    trackState.setProperty("soloed", tracks[i]->isSoloed(), nullptr);
+      auto track = std::make_unique<Track>(trackId, *this);
+      track->prepare(sampleRate, maxBlockSize);
+      track->restoreControls(volume, soloed);
+      current = track.get();
+      restored.push_back(std::move(track));
+      layers.emplace_back();
+    } else if ((chunk.id == SessionFormat::layerId ||
+                chunk.id == SessionFormat::compressedLayerId) &&
+               current != nullptr && chunk.isIntact()) {
+      layers.back().push_back(chunk);
+    }
+  }
+
+  restoreTracks(std::move(restored), layers,
+                Resampler::convertLength(savedBaseLength, savedRate,
+                                         sampleRate),
+                progress);
+  return true;
+}
+
+void TrackManager::restoreTracks(
+    std::vector<std::unique_ptr<Track>> restored,
+    const std::vector<std::vector<SessionReader::Chunk>> &layers,
+    int baseLength, const std::function<void(double)> &progress) {
+  size_t totalBytes = 0;
+  for (const auto &trackLayers : layers)
+    for (const auto &layer : trackLayers)
+      totalBytes += layer.size;
+
+  // Fill the tracks in parallel, each on one thread, straight from the
+  // session data
+  std::mutex progressMutex;
+  size_t bytesDone = 0;
+  runInParallel(static_cast<int>(restored.size()), [&](int i) {
+    auto &looper = restored[static_cast<size_t>(i)]->getLooper();
+    for (const auto &layer : layers[static_cast<size_t>(i)]) {
+      juce::MemoryInputStream layerData(layer.data, layer.size, false);
+      looper.readLayer(layerData,
+                       layer.id == SessionFormat::compressedLayerId);
+
+      if (progress) {
+        const std::lock_guard<std::mutex> progressLock(progressMutex);
+        bytesDone += layer.size;
+        progress(static_cast<double>(bytesDone) /
+                 static_cast<double>(totalBytes));
+      }
+    }
+  });
+
+  for (auto &track : restored)
+    track->getLooper().finishRestore();
+
+  if (baseLength > 0)
+    setBaseLoopLength(baseLength);
+
+  adoptRestoredTracks(std::move(restored));
+  if (progress)
+    progress(1.0);
+}
+
+void TrackManager::startJournal(const juce::File &file) {
+  stopJournal();
+  journal = std::make_unique<SessionJournal>(
+      file,
+      [this](SessionJournal::Snapshot &snapshot) {
+        captureJournal(snapshot);
+      },
+      [this](int trackId, juce::uint32 serial, juce::MemoryBlock &payload) {
+        return encodeJournalLayer(trackId, serial, payload);
+      });
+  journal->start();
+}
 
-    tracks[i]->getLooper().getState(trackState, sampleRate);
+void TrackManager::stopJournal() { journal.reset(); }
 
-    state.addChild(trackState, -1, nullptr);
+bool TrackManager::syncJournal(int timeoutMs) {
+  return journal != nullptr && journal->sync(timeoutMs);
+}
+
+bool TrackManager::recoverJournal(
+    const juce::File &file, double sampleRate,
+    const std::function<void(double)> &progress) {
+  juce::MemoryBlock data;
+  SessionJournal::Contents contents;
+  if (!file.loadFileAsData(data) ||
+      !SessionJournal::read(data.getData(), data.getSize(), contents))
+    return false;
+
+  const std::lock_guard<std::mutex> lock(tracksMutex);
+  std::vector<std::unique_ptr<Track>> restored;
+  std::vector<std::vector<SessionReader::Chunk>> layers;
+  for (const auto &saved : contents.tracks) {
+    if (restored.size() >= maxTracks)
+      break;
+    auto track = std::make_unique<Track>(saved.id, *this);
+    track->prepare(sampleRate, maxBlockSize);
+    track->restoreControls(saved.volume, saved.soloed);
+    restored.push_back(std::move(track));
+    layers.push_back(saved.layers);
   }
+
+  restoreTracks(std::move(restored), layers,
+                Resampler::convertLength(contents.loopLength,
+                                         contents.sampleRate, sampleRate),
+                progress);
+  return true;
+}
+
+void TrackManager::captureJournal(SessionJournal::Snapshot &snapshot) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  snapshot.sampleRate = currentSampleRate;
+  snapshot.loopLength = getBaseLoopLength();
+  for (const auto *track : currentTracks()) {
+    snapshot.tracks.emplace_back();
+    auto &saved = snapshot.tracks.back();
+    saved.id = track->getId();
+    saved.volume = track->getVolume();
+    saved.soloed = track->isSoloed();
+    track->getLooper().getFinishedLayers(saved.layers);
+  }
+}
+
+bool TrackManager::encodeJournalLayer(int trackId, juce::uint32 serial,
+                                      juce::MemoryBlock &payload) const {
+  const juce::ScopedReadLock readScope(reclaimer.getReadersLock());
+  const auto *track = findTrackInternal(trackId);
+  if (track == nullptr)
+    return false;
+
+  const auto &looper = track->getLooper();
+  const int index = looper.findLayer(serial);
+  LayerCodec codec;
+  return index >= 0 &&
+         looper.encodeLayer(index, currentSampleRate, getBaseLoopLength(),
+                            codec, payload, serial);
 }
 
 void TrackManager::setState(const juce::ValueTree &state, double sampleRate) {
   const std::lock_guard<std::mutex> lock(tracksMutex);
-  // Restore time manager
-  int baseLength = state.getProperty("baseLoopLength", 0);
+  // Restore time manager, converting from the rate it was saved at
+  const double savedRate = state.getProperty("sampleRate", sampleRate);
+  int baseLength = Resampler::convertLength(
+      state.getProperty("baseLoopLength", 0), savedRate, sampleRate);
   if (baseLength > 0) {
     setBaseLoopLength(baseLength);
   }
 
-  // Clear existing tracks
-  tracks.clear();
-  nextTrackId = 0;
-
   // Restore tracks
+  std::vector<std::unique_ptr<Track>> restored;
   int trackCount = state.getProperty("trackCount", 0);
   for (int i = 0; i < trackCount; ++i) {
     juce::ValueTree trackState =
         state.getChildWithName("Track" + juce::String(i));
-    if (trackState.isValid()) {
+    if (trackState.isValid() && restored.size() < maxTracks) {
       int trackId = trackState.getProperty("trackId", i);
       auto track = std::make_unique<Track>(trackId, *this);
-      track->prepare(sampleRate);
+      track->prepare(sampleRate, maxBlockSize);
 
       // Restore track properties
-      track->setVolume(trackState.getProperty("volume", 0.7f));
-      track->setSoloed(trackState.getProperty("soloed", false));
+      track->restoreControls(trackState.getProperty("volume", 0.7f),
+                             trackState.getProperty("soloed", false));
 
       // Restore looper state
       track->getLooper().setState(trackState, sampleRate);
 
-      tracks.push_back(std::move(track));
-
-      // Update nextTrackId to be higher than any existing track
-      if (trackId >= nextTrackId) {
-        nextTrackId = trackId + 1;
-      }
+      restored.push_back(std::move(track));
     }
   }
+
+  adoptRestoredTracks(std::move(restored));
+}
+
+void TrackManager::adoptRestoredTracks(
+    std::vector<std::unique_ptr<Track>> restored) {
+  // Swap out the existing tracks once the restored ones are published
+  auto previous = std::move(tracks);
+  tracks = std::move(restored);
+  for (const auto &track : previous)
+    releaseSlot(*track);
+  for (const auto &track : tracks)
+    takeSlot(*track);
+
+  // Update nextTrackId to be higher than any existing track
+  nextTrackId = 0;
+  for (const auto &track : tracks)
+    nextTrackId = juce::jmax(nextTrackId, track->getId() + 1);
+
+  publishTracks();
+  for (auto &track : previous) {
+    reclaimer.retire(std::move(track));
+  }
 }
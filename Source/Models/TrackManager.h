@@ -18,16 +18,59 @@
 
 #pragma once
 
+#include "AudioEpoch.h"
+#include "CommandQueue.h"
+#include "Reclaimer.h"
+#include "RenderPool.h"
+#include "SessionFormat.h"
+#include "SessionJournal.h"
+#include "Telemetry.h"
+#include "TrackControls.h"
+#include "TrackExporter.h"
+#include "TrackHandle.h"
+#include "TripleBuffer.h"
+#include <array>
 #include <atomic>
+#include <functional>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_core/juce_core.h>
 #include <juce_data_structures/juce_data_structures.h>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 class Track;
 
+/**
+ * TrackCommand - A control change for the audio thread to carry out
+ *
+ * sampleOffset is the position within the next processed block at which the
+ * command takes effect; commands for unknown tracks are ignored.
+ */
+struct TrackCommand {
+  enum class Type {
+    startRecording,
+    stopRecording,
+    startPlayback,
+    stopPlayback,
+    setSolo,
+    setVolume,
+    clear,
+    undo,
+    clearAll,
+    undoLast,
+    startAll,
+    stopAll,
+    playAll // start every track unless something is already playing
+  };
+
+  Type type = Type::stopAll;
+  int trackId = -1;
+  float value = 0.0f;
+  int sampleOffset = 0;
+};
+
 /**
  * TrackManager - Centralized management for multi-track looper
  *
@@ -36,14 +79,58 @@ class Track;
  * - Track lifecycle (add, remove, find)
  * - Recording/playback controls across all tracks
  * - Audio processing for all tracks
+ *
+ * processBlock() takes no locks. It reads an immutable snapshot of the track
+ * list, which the message thread replaces whenever tracks are added or
+ * removed; replaced lists and removed tracks are freed once the audio thread
+ * is done with them. Besides the tracks in order, each snapshot indexes them
+ * by id and by slot, so finding a track by id or TrackHandle takes constant
+ * time.
+ *
+ * Controls from the editor and host parameters are posted as TrackCommands
+ * to a lock-free queue. processBlock() drains it at the top of each block and
+ * applies every command at its sample offset, splitting the block there.
+ * While audio is stopped, commands are applied as soon as they are posted.
+ *
+ * Each snapshot also carries the tracks' mix controls as the audio thread
+ * has applied them, laid out by TrackControls as arrays by list position.
+ * The audio thread fills them in from the tracks the first time it sees a
+ * list and keeps them up to date as it applies commands, so each block
+ * finds the tracks to record and play by scanning them rather than every
+ * Track.
+ *
+ * At the end of every block the audio thread publishes a TelemetrySnapshot
+ * of the tracks' state, which the UI reads instead of touching the tracks.
+ *
+ * With parallel rendering on and enough tracks, track playback is rendered
+ * on a RenderPool into per-track buses, which are then summed in track order
+ * so the mix doesn't depend on which thread rendered what.
  */
 class TrackManager {
 public:
   TrackManager();
   ~TrackManager();
 
-  // Initialize with sample rate
-  void prepare(double sampleRate);
+  // Initialize with sample rate; audio may start once this returns
+  void prepare(double sampleRate, int maximumBlockSize);
+
+  // Audio has stopped; commands apply immediately again
+  void release();
+
+  // Queue a command for the audio thread (any thread, lock-free while audio
+  // runs). Returns false if the queue is full and the command was dropped.
+  bool postCommand(const TrackCommand &command);
+  int getNumDroppedCommands() const { return numDroppedCommands.load(); }
+
+  // Render playback on `numWorkers` extra realtime threads whenever at
+  // least `minTracks` tracks are audible. With 0 workers, or if realtime
+  // threads can't be started, it all stays on the audio thread. The plugin
+  // turns this on when audio first starts, at the default threshold;
+  // BM_ParallelRender finds where it pays off on a given machine.
+  static constexpr int defaultParallelThreshold = 8;
+  void setParallelRendering(int numWorkers,
+                            int minTracks = defaultParallelThreshold);
+  int getNumRenderWorkers() const;
 
   // Base loop length management (set by first track to record)
   void setBaseLoopLength(int length);
@@ -63,7 +150,12 @@ public:
   // Get max loop duration in samples (e.g., 60 seconds)
   int getMaxLoopLength() const { return maxLoopLength; }
 
-  // Track management
+  // The most tracks a session holds, so the telemetry can report them all
+  static constexpr size_t maxTracks = TelemetrySnapshot::maxTracks;
+
+  // Track management. Track pointers stay valid until the track is removed;
+  // hold a TrackHandle to refer to a track for longer. addTrack() returns
+  // nullptr once there are maxTracks, and restores leave out any past them.
   Track *addTrack();
   void removeTrack(int trackId);
   void removeAllTracks();
@@ -71,6 +163,21 @@ public:
   Track *findTrack(int trackId);
   int getTrackCount() const;
 
+  // The handle of the track with an id, or a null handle, and the handles
+  // of every track in order
+  TrackHandle getTrackHandle(int trackId) const;
+  std::vector<TrackHandle> getTrackHandles() const;
+
+  // The track a handle names, or nullptr once it has been removed or
+  // replaced by a restore. The pointer may only be used on the thread that
+  // removes and restores tracks; anywhere else, call withTrack(), which runs
+  // `use` with the track under the readers lock so it can't be freed
+  // meanwhile, and returns false without calling it if there is no such
+  // track. Keep `use` short: retired objects wait for it.
+  Track *resolve(TrackHandle handle) const;
+  bool withTrack(TrackHandle handle,
+                 const std::function<void(Track &)> &use) const;
+
   // Track controls
   bool startRecordingTrack(int trackId);
   void stopRecordingTrack(int trackId);
@@ -85,6 +192,7 @@ public:
   void requestUndoLast();
   void startPlayback();
   void stopPlayback();
+  void playAll();
   bool isPlaying() const;
 
   // Solo logic
@@ -93,30 +201,233 @@ public:
   // Audio processing
   void processBlock(juce::AudioBuffer<float> &buffer, bool shouldMonitor);
 
-  // State serialization
-  void getState(juce::ValueTree &state, double sampleRate) const;
+  // The latest telemetry published. Call from one thread only (the message
+  // thread); the reference stays valid until the next call.
+  const TelemetrySnapshot &getTelemetry() { return telemetry.read(); }
+
+  // State serialization. writeState() writes the session, track and layer
+  // chunks; readState() restores them, skipping damaged layers, and returns
+  // false (leaving the tracks alone) if the session chunk is missing or
+  // damaged. setState() reads sessions saved as a ValueTree before that.
+  // With `compressAudio`, layers are encoded losslessly by LayerCodec on a
+  // few background threads at once.
+  //
+  // writeState() doesn't take tracksMutex or hold up the audio thread, which
+  // may keep recording: finalized layers are read in place and a layer still
+  // being recorded is saved with what it holds so far.
+  //
+  // readState() restores the tracks in parallel and reports the share of
+  // layer data restored so far to `progress`, which may be called from any
+  // of its threads (one at a time) and is last called with 1.
+  void writeState(SessionWriter &writer, double sampleRate,
+                  bool compressAudio = false) const;
+  bool readState(SessionReader &reader, double sampleRate,
+                 const std::function<void(double)> &progress = {});
   void setState(const juce::ValueTree &state, double sampleRate);
 
+  // Roughly how many bytes writeState() will produce, for preallocating
+  size_t getStateSizeEstimate() const;
+
+  // Import an audio file (WAV, AIFF or FLAC) onto a track as a new layer.
+  // It is decoded and resampled in the background, trimmed or padded to
+  // the loop length, and added at the start of a block once ready. Into an
+  // empty session it keeps the file's length, up to the maximum, and sets
+  // the loop length as a first recording does. False if there is no such
+  // track. Call from any thread but the audio thread.
+  bool importLayer(int trackId, const juce::File &file);
+  bool isImporting() const;
+
+  // Audio export. startExport() writes one file per track, flattened from
+  // its finished layers with its volume applied, and optionally the master
+  // mix as it plays, going `numCycles` times round the loop. The layers,
+  // volumes and solos are those at the start: later overdubs and control
+  // changes don't reach the files, and the export fails (deleting them) if
+  // a track or layer it renders is removed or the sample rate changes.
+  // False if an export is already running, there is no loop yet, a track is
+  // being resampled or a file can't be created. The audio is rendered and
+  // written on background threads, which read the tracks under the
+  // reclaimer's readers lock a block at a time and never hold up the audio
+  // thread. Call these from one thread (the message thread).
+  bool startExport(const TrackExporter::Options &options);
+  void cancelExport();
+  bool isExporting() const;
+  float getExportProgress() const;
+  bool hasExportSucceeded() const;
+
+  // Crash journal. startJournal() keeps `file` up to date with the session
+  // from a background thread, appending each layer once it is finished
+  // (see SessionJournal); the file stays when the journal stops.
+  // recoverJournal() brings back a session from a journal left behind by a
+  // crash and otherwise works like readState(). syncJournal() waits until
+  // everything finished so far is on disk. Call these from one thread (the
+  // message thread); the journal reads the tracks the way saving does and
+  // never holds up the audio thread.
+  void startJournal(const juce::File &file);
+  void stopJournal();
+  bool syncJournal(int timeoutMs);
+  bool recoverJournal(const juce::File &file, double sampleRate,
+                      const std::function<void(double)> &progress = {});
+
 private:
+  struct TrackList : public Retirable {
+    std::vector<Track *> tracks;       // in order
+    std::vector<Track *> slots;        // by handle slot, or null
+    std::unordered_map<int, int> byId; // where the first with each id is
+    TrackControls controls;            // applied, by position (audio thread)
+    bool controlsFilled = false;       // controls filled in from the tracks
+  };
+
+  // Serialises changes made from non-audio threads; never taken by the
+  // audio thread
   mutable std::mutex tracksMutex;
 
   std::atomic<int> baseLoopLength{0};
   std::atomic<int> readPosition{0};
 
-  double currentSampleRate = 44100.0;
+  std::atomic<double> currentSampleRate{44100.0};
   int maxLoopLength = 44100 * 60;
+  int maxBlockSize = 512;
 
-  std::vector<std::unique_ptr<Track>> tracks;
+  std::vector<std::unique_ptr<Track>> tracks; // owners, under tracksMutex
   int nextTrackId = 0;
 
-  // Internal unlocked helpers (caller must hold tracksMutex)
+  // The slot map behind TrackHandles, under tracksMutex. A slot's
+  // generation moves on each time a track takes it.
+  struct Slot {
+    Track *track = nullptr;
+    juce::uint32 generation = 0;
+  };
+  std::vector<Slot> slots;
+  std::vector<juce::uint32> freeSlots;
+
+  // Give a track a slot and its handle, or free the slot of one removed
+  void takeSlot(Track &track);
+  void releaseSlot(const Track &track);
+
+  std::atomic<TrackList *> trackList{nullptr};
+  AudioEpoch audioEpoch;
+  Reclaimer reclaimer{&audioEpoch};
+  std::atomic<bool> audioActive{false};
+
+  // The published track list. Valid on the audio thread during
+  // processBlock, under tracksMutex, or under the reclaimer's readers lock.
+  const TrackList &currentList() const {
+    return *trackList.load(std::memory_order_acquire);
+  }
+  TrackList &currentList() {
+    return *trackList.load(std::memory_order_acquire);
+  }
+  const std::vector<Track *> &currentTracks() const {
+    return currentList().tracks;
+  }
+
+  // Replace the published list with the current owners (holds tracksMutex)
+  void publishTracks();
+
+  static constexpr int commandQueueSize = 256;
+  CommandQueue<TrackCommand, commandQueueSize> commands;
+  std::array<TrackCommand, commandQueueSize> blockCommands; // audio thread
+  std::atomic<int> numDroppedCommands{0};
+
+  // Pop queued commands into blockCommands, sorted by offset (audio thread)
+  int collectBlockCommands(int numSamples);
+
+  // Apply everything queued now (caller holds tracksMutex, audio stopped)
+  void drainCommands();
+
+  // Carry out one command (audio thread, or drainCommands)
+  void applyCommand(const TrackCommand &command);
+
+  // Record and play [startSample, startSample + numSamples) of the block
+  void processSegment(juce::AudioBuffer<float> &buffer, int startSample,
+                      int numSamples, bool shouldMonitor);
+
+  // Renders the playback of one of the list's audible tracks into its
+  // render bus
+  struct PlaybackJob : public RenderPool::Job {
+    const TrackList *list = nullptr;
+    int numSamples = 0;
+    int readPosition = 0;
+    int loopLength = 0;
+
+    void runTask(int index) override;
+  };
+
+  std::atomic<RenderPool *> renderPool{nullptr};
+  std::atomic<int> parallelThreshold{defaultParallelThreshold};
+  PlaybackJob playbackJob; // audio thread
+
+  TripleBuffer<TelemetrySnapshot> telemetry;
+  juce::uint64 telemetrySequence = 0;
+
+  // Meters the output of every block (audio thread)
+  LevelMeter masterMeter;
+
+  // Fill in and publish a snapshot, closing a block of numSamples on the
+  // meters. Audio thread, or while audio is stopped under tracksMutex.
+  void publishTelemetry(int numSamples);
+
+  // Mix every audible track's playback into buffer, in parallel if
+  // worthwhile
+  void mixPlayback(juce::AudioBuffer<float> &buffer, int readPos,
+                   int loopLen);
+
+  // Replace the tracks with restored ones, under tracksMutex
+  void adoptRestoredTracks(std::vector<std::unique_ptr<Track>> restored);
+
+  // Fill restored tracks from their layer chunks, each track on one thread,
+  // then set the loop length and swap them in (under tracksMutex)
+  void restoreTracks(
+      std::vector<std::unique_ptr<Track>> restored,
+      const std::vector<std::vector<SessionReader::Chunk>> &layers,
+      int baseLength, const std::function<void(double)> &progress);
+
+  // What an export renders of each track, fixed when it starts
+  struct ExportTrack {
+    int trackId = 0;
+    float volume = 1.0f;
+    bool inMaster = true; // false if muted by another track's solo
+    std::vector<juce::uint32> layers;
+  };
+
+  // Fills an export block for TrackExporter from any thread; false once a
+  // track or layer has gone or the audio has been resampled
+  bool renderExport(const std::vector<ExportTrack> &exportTracks,
+                    double sampleRate, int position, int loopLength,
+                    std::vector<juce::AudioBuffer<float>> &stemBlocks,
+                    juce::AudioBuffer<float> &master) const;
+
+  // The last export started; reads the tracks, so it goes first on teardown
+  std::unique_ptr<TrackExporter> exporter;
+
+  // For SessionJournal, on its thread
+  void captureJournal(SessionJournal::Snapshot &snapshot) const;
+  bool encodeJournalLayer(int trackId, juce::uint32 serial,
+                          juce::MemoryBlock &payload) const;
+
+  // Likewise reads the tracks, so it goes first on teardown
+  std::unique_ptr<SessionJournal> journal;
+
+  // The track a handle names in the current list; hold the readers lock
+  Track *resolveInternal(TrackHandle handle) const;
+
+  // Internal helpers (audio thread, or drainCommands)
   Track *findTrackInternal(int trackId) const;
+  int findTrackIndexInternal(int trackId) const;
   Track *findTrackWithMostRecentLoopInternal() const;
   void stopAllRecordingInternal();
   void stopAllPlaybackInternal();
-  void startPlaybackTrackInternal(int trackId);
-  bool isAnyTrackSoloedInternal() const;
+  void startAllPlaybackInternal();
+  void startPlaybackTrackInternal(Track &track);
+  void resetTimingIfEmpty();
   bool isPlayingInternal() const;
+  bool hasAnyLoopsInternal() const;
+
+  // Copy a track's applied state into the list's controls, or every
+  // track's the first time the list is used (audio thread, or while audio
+  // is stopped under tracksMutex)
+  void syncControls(int index);
+  void fillControls();
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackManager)
 };
@@ -0,0 +1,71 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <juce_core/juce_core.h>
+
+/**
+ * TripleBuffer - Hands the latest value from one thread to another
+ *
+ * The writer fills its own slot and publishes it by swapping it with the
+ * spare; the reader swaps the spare for its slot when something new has been
+ * published. Neither side waits, allocates or ever sees a half-written
+ * value, and the reader always gets the most recent one (older values are
+ * simply overwritten).
+ *
+ * One writer and one reader at a time, which may be different threads from
+ * call to call as long as the calls don't overlap.
+ */
+template <typename ValueType> class TripleBuffer {
+public:
+  TripleBuffer() = default;
+
+  // Writer: fill this, then publish() it
+  ValueType &getWriteBuffer() { return slots[writeIndex]; }
+
+  void publish() {
+    const auto previous = spare.exchange(
+        static_cast<juce::uint8>(writeIndex | freshFlag),
+        std::memory_order_acq_rel);
+    writeIndex = previous & indexMask;
+  }
+
+  // Reader: the latest published value, valid until the next read()
+  const ValueType &read() {
+    if ((spare.load(std::memory_order_relaxed) & freshFlag) != 0) {
+      const auto previous = spare.exchange(static_cast<juce::uint8>(readIndex),
+                                           std::memory_order_acq_rel);
+      readIndex = previous & indexMask;
+    }
+    return slots[readIndex];
+  }
+
+private:
+  static constexpr juce::uint8 indexMask = 3;
+  static constexpr juce::uint8 freshFlag = 4;
+
+  std::array<ValueType, 3> slots{};
+  std::atomic<juce::uint8> spare{1};
+  juce::uint8 writeIndex = 0;
+  juce::uint8 readIndex = 2;
+
+  JUCE_DECLARE_NON_COPYABLE(TripleBuffer)
+};
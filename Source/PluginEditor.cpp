@@ -36,8 +36,8 @@ LooperAudioProcessorEditor::LooperAudioProcessorEditor(LooperAudioProcessor &p)
   // Add initial track if none exist
   addInitialTrack();
 
-  // Start timer for UI updates (30fps)
-  startTimer(33);
+  // Start timer for UI updates; it slows down once nothing is moving
+  startTimer(1000 / maxAnimationHz);
 
   // Intercept key events across all child components
   addKeyListener(this);
@@ -73,34 +73,57 @@ void LooperAudioProcessorEditor::setupCallbacks() {
     trackContainer.removeAllTrackViews();
     // Re-add any remaining tracks (if tracks are cleared but not removed)
     syncTracksWithProcessor();
+    refreshViews();
   };
 
-  controlBar.onUndoLast = [this]() { audioProcessor.requestUndoLast(); };
+  controlBar.onUndoLast = [this]() {
+    audioProcessor.requestUndoLast();
+    refreshViews();
+  };
+
+  controlBar.onExport = [this]() {
+    auto &manager = audioProcessor.getTrackManager();
+    if (manager.isExporting()) {
+      manager.cancelExport();
+      return;
+    }
+
+    juce::PopupMenu menu;
+    menu.addItem("Export WAV...",
+                 [this] { chooseExportFolder(TrackExporter::Format::wav); });
+    menu.addItem("Export FLAC...",
+                 [this] { chooseExportFolder(TrackExporter::Format::flac); });
+    menu.showMenuAsync(juce::PopupMenu::Options().withMousePosition());
+  };
 
   // Track container callbacks
   trackContainer.onAddTrack = [this]() {
     // Add track to processor
-    Track *newTrack = audioProcessor.addTrack();
-    if (newTrack != nullptr) {
-      // Add corresponding track view to UI
-      trackContainer.addTrackView(newTrack);
-    }
-    updateTrackButtons();
+    const auto handle = audioProcessor.addTrack();
+    // Add corresponding track view to UI
+    trackContainer.addTrackView(audioProcessor.getTrackManager(), handle);
+    refreshViews();
   };
 
-  trackContainer.onRemoveTrack = [this](int trackId) {
+  trackContainer.onRemoveTrack = [this](TrackHandle handle) {
+    const int trackId = findTrackId(handle);
+    if (trackId < 0)
+      return;
     // Remove track from processor
     audioProcessor.removeTrack(trackId);
     // Remove corresponding track view from UI
     trackContainer.removeTrackView(trackId);
-    updateTrackButtons();
+    refreshViews();
   };
 
   trackContainer.onSelectedTrackChanged = [this](int trackId) {
     audioProcessor.setCurrentTrackId(trackId);
   };
 
-  trackContainer.onRecordTrack = [this](int trackId, bool isRecording) {
+  trackContainer.onRecordTrack = [this](TrackHandle handle, bool isRecording) {
+    const int trackId = findTrackId(handle);
+    if (trackId < 0)
+      return;
     if (isRecording) {
       audioProcessor.startRecordingTrack(trackId);
     } else {
@@ -109,58 +132,74 @@ void LooperAudioProcessorEditor::setupCallbacks() {
     if (trackId == audioProcessor.getCurrentTrackId()) {
       audioProcessor.syncParamsWithCurrentTrack();
     }
-    trackContainer.refreshTrackViews();
-    updateTrackButtons();
+    refreshViews();
   };
 
-  trackContainer.onPlayTrack = [this](int trackId, bool isPlaying) {
+  trackContainer.onPlayTrack = [this](TrackHandle handle, bool isPlaying) {
+    int trackId = -1;
+    bool recording = false;
+    audioProcessor.getTrackManager().withTrack(handle, [&](Track &track) {
+      trackId = track.getId();
+      recording = track.isRecording();
+    });
+    if (trackId < 0)
+      return;
     if (isPlaying) {
       audioProcessor.startPlaybackTrack(trackId);
+    } else if (recording) {
+      audioProcessor.stopRecordingTrack(trackId);
     } else {
-      if (audioProcessor.findTrack(trackId) != nullptr &&
-          audioProcessor.findTrack(trackId)->isRecording()) {
-        audioProcessor.stopRecordingTrack(trackId);
-      } else {
-        audioProcessor.stopPlaybackTrack(trackId);
-      }
+      audioProcessor.stopPlaybackTrack(trackId);
     }
     if (trackId == audioProcessor.getCurrentTrackId()) {
       audioProcessor.syncParamsWithCurrentTrack();
     }
-    trackContainer.refreshTrackViews();
-    updateTrackButtons();
+    refreshViews();
   };
 
-  trackContainer.onClearTrack = [this](int trackId) {
+  trackContainer.onClearTrack = [this](TrackHandle handle) {
+    const int trackId = findTrackId(handle);
+    if (trackId < 0)
+      return;
     audioProcessor.clearTrack(trackId);
+    refreshViews();
   };
 
-  trackContainer.onUndoTrack = [this](int trackId) {
+  trackContainer.onUndoTrack = [this](TrackHandle handle) {
+    const int trackId = findTrackId(handle);
+    if (trackId < 0)
+      return;
     audioProcessor.undoTrack(trackId);
+    refreshViews();
   };
 }
 
+int LooperAudioProcessorEditor::findTrackId(TrackHandle handle) const {
+  int trackId = -1;
+  audioProcessor.getTrackManager().withTrack(
+      handle, [&trackId](Track &track) { trackId = track.getId(); });
+  return trackId;
+}
+
 void LooperAudioProcessorEditor::addInitialTrack() {
   // If no tracks exist in the processor, add one
   if (audioProcessor.getTrackCount() == 0) {
-    Track *track = audioProcessor.addTrack();
-    if (track != nullptr) {
-      trackContainer.addTrackView(track);
-    }
+    trackContainer.addTrackView(audioProcessor.getTrackManager(),
+                                audioProcessor.addTrack());
   } else {
     // Tracks were restored from state - add them to UI
     syncTracksWithProcessor();
   }
 
   // Select the first track by default
-  if (audioProcessor.getTrackCount() > 0) {
-    auto tracks = audioProcessor.getTracks();
-    if (!tracks.empty()) {
-      trackContainer.selectTrack(tracks[0]->getId());
-    }
+  const auto handles = audioProcessor.getTrackHandles();
+  if (!handles.empty()) {
+    const int trackId = findTrackId(handles[0]);
+    if (trackId >= 0)
+      trackContainer.selectTrack(trackId);
   }
 
-  updateTrackButtons();
+  refreshViews();
 }
 
 void LooperAudioProcessorEditor::syncTracksWithProcessor() {
@@ -168,27 +207,29 @@ void LooperAudioProcessorEditor::syncTracksWithProcessor() {
   trackContainer.removeAllTrackViews();
 
   // Add track views for all tracks in processor
-  for (auto *track : audioProcessor.getTracks()) {
-    trackContainer.addTrackView(track);
+  for (const auto handle : audioProcessor.getTrackHandles()) {
+    trackContainer.addTrackView(audioProcessor.getTrackManager(), handle);
   }
 }
 
-void LooperAudioProcessorEditor::updateTrackButtons() {
-  bool anyPlaying = false;
-  auto tracks = audioProcessor.getTracks();
-  for (auto *track : tracks) {
-    if (track->isPlaying())
-      anyPlaying = true;
+void LooperAudioProcessorEditor::updateTrackButtons(
+    const TelemetrySnapshot &snapshot) {
+  if (snapshot.anyPlaying != shownPlaying) {
+    shownPlaying = snapshot.anyPlaying;
+    controlBar.setPlayAllButtonState(shownPlaying);
   }
 
-  controlBar.setPlayAllButtonState(anyPlaying);
-
   // Update control bar info
   int totalLoops = 0;
-  for (auto *track : tracks) {
-    totalLoops += static_cast<int>(track->getLooper().getNumLoops());
+  for (int i = 0; i < snapshot.numTracks; ++i) {
+    totalLoops += snapshot.tracks[static_cast<size_t>(i)].numLoops;
+  }
+  if (snapshot.numTracks != shownTrackCount ||
+      totalLoops != shownLoopCount) {
+    shownTrackCount = snapshot.numTracks;
+    shownLoopCount = totalLoops;
+    controlBar.setLoopInfo(shownTrackCount, shownLoopCount);
   }
-  controlBar.setLoopInfo(audioProcessor.getTrackCount(), totalLoops);
 }
 
 bool LooperAudioProcessorEditor::keyPressed(const juce::KeyPress &key,
@@ -203,12 +244,17 @@ bool LooperAudioProcessorEditor::keyPressed(const juce::KeyPress &key,
   if (selectedId < 0)
     return false;
 
-  Track *track = audioProcessor.findTrack(selectedId);
-  if (track == nullptr)
+  bool recording = false, playing = false;
+  const auto &manager = audioProcessor.getTrackManager();
+  if (!manager.withTrack(manager.getTrackHandle(selectedId),
+                         [&](Track &track) {
+                           recording = track.isRecording();
+                           playing = track.isPlaying();
+                         }))
     return false;
 
   if (key == juce::KeyPress('r') || key == juce::KeyPress('R')) {
-    if (track->isRecording()) {
+    if (recording) {
       audioProcessor.stopRecordingTrack(selectedId);
     } else {
       audioProcessor.startRecordingTrack(selectedId);
@@ -216,35 +262,33 @@ bool LooperAudioProcessorEditor::keyPressed(const juce::KeyPress &key,
     if (selectedId == audioProcessor.getCurrentTrackId()) {
       audioProcessor.syncParamsWithCurrentTrack();
     }
-    trackContainer.refreshTrackViews();
-    updateTrackButtons();
+    refreshViews();
     return true;
   }
 
   if (key == juce::KeyPress(' ')) {
-    if (track->isPlaying()) {
+    if (playing) {
       audioProcessor.stopPlaybackTrack(selectedId);
     } else {
       audioProcessor.startPlaybackTrack(selectedId);
     }
     if (selectedId == audioProcessor.getCurrentTrackId())
       audioProcessor.syncParamsWithCurrentTrack();
-    trackContainer.refreshTrackViews();
-    updateTrackButtons();
+    refreshViews();
     return true;
   }
 
   if (key == juce::KeyPress::backspaceKey) {
     audioProcessor.clearTrack(selectedId);
     audioProcessor.syncParamsWithCurrentTrack();
-    trackContainer.refreshTrackViews();
+    refreshViews();
     return true;
   }
 
   if (key == juce::KeyPress('z') && key.getModifiers().isCtrlDown()) {
     audioProcessor.undoTrack(selectedId);
     audioProcessor.syncParamsWithCurrentTrack();
-    trackContainer.refreshTrackViews();
+    refreshViews();
     return true;
   }
 
@@ -252,11 +296,81 @@ bool LooperAudioProcessorEditor::keyPressed(const juce::KeyPress &key,
 }
 
 void LooperAudioProcessorEditor::timerCallback() {
-  // Update loop counts in track views
-  trackContainer.refreshTrackViews();
+  // A session restored by the host replaces every track, leaving the views
+  // holding handles to tracks that have gone
+  if (trackContainer.hasStaleTrackViews())
+    syncTracksWithProcessor();
+
+  // Views only repaint what changed since the last snapshot
+  const auto &snapshot = audioProcessor.getTelemetry();
+  trackContainer.refreshTrackViews(snapshot);
+  updateTrackButtons(snapshot);
+  controlBar.setMasterLevel(snapshot.master);
+
+  // Hosts that load sessions off the message thread get a progress readout
+  const float loadProgress = audioProcessor.getRestoreProgress();
+  if (loadProgress != shownLoadProgress) {
+    shownLoadProgress = loadProgress;
+    controlBar.setProgress("Loading session", loadProgress);
+  }
+
+  // So do exports, which always run in the background
+  const auto &manager = audioProcessor.getTrackManager();
+  const bool exporting = manager.isExporting();
+  if (exporting) {
+    controlBar.setProgress("Exporting", manager.getExportProgress());
+  } else if (shownExporting) {
+    controlBar.setStatusText(manager.hasExportSucceeded() ? "Exported"
+                                                          : "Export stopped");
+  }
+  if (exporting != shownExporting) {
+    shownExporting = exporting;
+    controlBar.setExportButtonState(exporting);
+  }
+
+  // Animate the cursors and meters while something moves; otherwise only
+  // look out for changes made by the host
+  const bool animating =
+      snapshot.anyPlaying || snapshot.anyRecording ||
+      !snapshot.master.isSilent() || loadProgress < 1.0f || exporting ||
+      juce::Time::getMillisecondCounter() < settleUntilMs;
+  const int intervalMs = 1000 / (animating ? maxAnimationHz : idleHz);
+  if (getTimerInterval() != intervalMs)
+    startTimer(intervalMs);
+}
+
+void LooperAudioProcessorEditor::chooseExportFolder(
+    TrackExporter::Format format) {
+  exportChooser = std::make_unique<juce::FileChooser>(
+      "Export tracks to...",
+      juce::File::getSpecialLocation(juce::File::userDocumentsDirectory));
+  exportChooser->launchAsync(
+      juce::FileBrowserComponent::openMode |
+          juce::FileBrowserComponent::canSelectDirectories,
+      [this, format](const juce::FileChooser &chooser) {
+        const auto folder = chooser.getResult();
+        if (folder == juce::File())
+          return;
+
+        TrackExporter::Options options;
+        options.folder = folder;
+        options.format = format;
+        if (!audioProcessor.getTrackManager().startExport(options))
+          controlBar.setStatusText("Export failed");
+        refreshViews();
+      });
+}
+
+void LooperAudioProcessorEditor::refreshViews() {
+  // Commands take effect a block later while audio runs, so keep watching
+  // closely for a moment
+  settleUntilMs = juce::Time::getMillisecondCounter() + settleMs;
+  if (getTimerInterval() != 1000 / maxAnimationHz)
+    startTimer(1000 / maxAnimationHz);
 
-  // Update track info display
-  updateTrackButtons();
+  const auto &snapshot = audioProcessor.getTelemetry();
+  trackContainer.refreshTrackViews(snapshot);
+  updateTrackButtons(snapshot);
 }
 
 void LooperAudioProcessorEditor::paint(juce::Graphics &g) {
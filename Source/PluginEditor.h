@@ -50,10 +50,35 @@ private:
   GlobalControlBar controlBar;
   TrackContainer trackContainer;
 
+  // Timer rates: capped while cursors move, slow while idle
+  static constexpr int maxAnimationHz = 30;
+  static constexpr int idleHz = 4;
+  static constexpr juce::uint32 settleMs = 500;
+  juce::uint32 settleUntilMs = 0;
+
+  // Control bar state as last shown
+  bool shownPlaying = false;
+  int shownTrackCount = -1;
+  int shownLoopCount = -1;
+  float shownLoadProgress = 1.0f;
+  bool shownExporting = false;
+
+  // Kept alive while the folder chooser is open
+  std::unique_ptr<juce::FileChooser> exportChooser;
+
   void setupCallbacks();
   void addInitialTrack();
-  void updateTrackButtons();
+  void updateTrackButtons(const TelemetrySnapshot &snapshot);
   void syncTracksWithProcessor();
 
+  // The id of the track a view's handle names, or -1 once it has gone
+  int findTrackId(TrackHandle handle) const;
+
+  // Ask for a folder, then export every track and the master to it
+  void chooseExportFolder(TrackExporter::Format format);
+
+  // Bring the views up to date after a UI action and animate for a moment
+  void refreshViews();
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LooperAudioProcessorEditor)
 };
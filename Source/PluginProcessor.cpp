@@ -46,6 +46,10 @@ LooperAudioProcessor::LooperAudioProcessor()
 }
 
 LooperAudioProcessor::~LooperAudioProcessor() {
+  // Closed cleanly, so there is nothing to recover
+  trackManager.stopJournal();
+  getJournalFile(getJournalName()).getParentDirectory().deleteRecursively();
+
   parameters.removeParameterListener("playAll", this);
   parameters.removeParameterListener("record", this);
   parameters.removeParameterListener("play", this);
@@ -104,12 +108,23 @@ void LooperAudioProcessor::changeProgramName(int index,
 
 void LooperAudioProcessor::prepareToPlay(double sampleRate,
                                          int samplesPerBlock) {
-  juce::ignoreUnused(samplesPerBlock);
   currentSampleRate = sampleRate;
-  trackManager.prepare(sampleRate);
+  trackManager.prepare(sampleRate, samplesPerBlock);
+
+  if (!journalStarted) {
+    journalStarted = true;
+    trackManager.startJournal(getJournalFile(getJournalName()));
+  }
+
+  if (!renderWorkersStarted) {
+    renderWorkersStarted = true;
+    const int spareCores = juce::SystemStats::getNumPhysicalCpus() - 1;
+    trackManager.setParallelRendering(
+        juce::jlimit(0, maxRenderWorkers, spareCores));
+  }
 }
 
-void LooperAudioProcessor::releaseResources() {}
+void LooperAudioProcessor::releaseResources() { trackManager.release(); }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool LooperAudioProcessor::isBusesLayoutSupported(
@@ -155,18 +170,56 @@ juce::AudioProcessorEditor *LooperAudioProcessor::createEditor() {
 }
 
 void LooperAudioProcessor::getStateInformation(juce::MemoryBlock &destData) {
-  juce::ValueTree state = parameters.copyState();
-
-  trackManager.getState(state, currentSampleRate);
-
+  // Sized up front so the audio is copied once, straight into destData
   juce::MemoryOutputStream stream(destData, true);
-  state.writeToStream(stream);
+  stream.preallocate(destData.getSize() + trackManager.getStateSizeEstimate());
+  SessionWriter writer(stream);
+
+  juce::MemoryOutputStream parameterData;
+  parameters.copyState().writeToStream(parameterData);
+  writer.beginChunk(SessionFormat::parametersId);
+  writer.write(parameterData.getData(), parameterData.getDataSize());
+  writer.endChunk();
+
+  const auto name = getJournalName();
+  writer.beginChunk(SessionFormat::journalId);
+  writer.write(name.toRawUTF8(), name.getNumBytesAsUTF8());
+  writer.endChunk();
+
+  trackManager.writeState(writer, currentSampleRate,
+                          compressSavedAudio.load());
+  writer.finish();
 }
 
 void LooperAudioProcessor::setStateInformation(const void *data,
                                                int sizeInBytes) {
-  juce::ValueTree state =
-      juce::ValueTree::readFromData(data, static_cast<size_t>(sizeInBytes));
+  const auto numBytes = static_cast<size_t>(sizeInBytes);
+
+  if (SessionFormat::hasMagic(data, numBytes)) {
+    SessionReader reader(data, numBytes);
+    if (!reader.isValid())
+      return;
+
+    SessionReader::Chunk chunk;
+    if (reader.find(SessionFormat::parametersId, chunk) && chunk.isIntact()) {
+      auto state = juce::ValueTree::readFromData(chunk.data, chunk.size);
+      if (state.isValid())
+        parameters.replaceState(state);
+    }
+
+    restoreProgress = 0.0f;
+    const auto progress = [this](double done) {
+      restoreProgress = static_cast<float>(done);
+    };
+    if (!recoverJournal(reader, progress))
+      trackManager.readState(reader, currentSampleRate, progress);
+    restoreProgress = 1.0f;
+    return;
+  }
+
+  // Sessions saved before the binary format: one ValueTree, with each layer
+  // base64-encoded in a property
+  juce::ValueTree state = juce::ValueTree::readFromData(data, numBytes);
   if (state.isValid()) {
     parameters.replaceState(state);
 
@@ -174,6 +227,50 @@ void LooperAudioProcessor::setStateInformation(const void *data,
   }
 }
 
+juce::File LooperAudioProcessor::getJournalFile(const juce::String &name) {
+  return juce::File::getSpecialLocation(
+             juce::File::userApplicationDataDirectory)
+      .getChildFile("LooperPlugin")
+      .getChildFile("Sessions")
+      .getChildFile(juce::File::createLegalFileName(name))
+      .getChildFile("session.journal");
+}
+
+juce::String LooperAudioProcessor::getJournalName() const {
+  const juce::ScopedLock lock(journalLock);
+  return journalName;
+}
+
+bool LooperAudioProcessor::recoverJournal(
+    const SessionReader &reader,
+    const std::function<void(double)> &progress) {
+  SessionReader::Chunk chunk;
+  if (!reader.find(SessionFormat::journalId, chunk) || !chunk.isIntact())
+    return false;
+
+  // A journal still open belongs to this instance, or to another one loaded
+  // from the same session; only one left closed was cut off by a crash
+  const auto name =
+      juce::String::fromUTF8(chunk.data, static_cast<int>(chunk.size));
+  const auto file = getJournalFile(name);
+  if (name.isEmpty() || SessionJournal::isOpen(file) ||
+      !file.existsAsFile() ||
+      !trackManager.recoverJournal(file, currentSampleRate, progress))
+    return false;
+
+  // Carry on in the recovered journal, which starts over from the session
+  // as restored, and drop this instance's own
+  const auto previous = getJournalFile(getJournalName());
+  {
+    const juce::ScopedLock lock(journalLock);
+    journalName = name;
+  }
+  if (journalStarted)
+    trackManager.startJournal(file);
+  previous.getParentDirectory().deleteRecursively();
+  return true;
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout
 LooperAudioProcessor::createParameterLayout() {
   juce::AudioProcessorValueTreeState::ParameterLayout layout;
@@ -195,70 +292,62 @@ LooperAudioProcessor::createParameterLayout() {
 
 void LooperAudioProcessor::parameterChanged(const juce::String &parameterID,
                                             float newValue) {
+  // Hosts may call this from the audio thread, so post commands by id
+  // rather than looking the track up; the audio thread ignores repeats
+  using Type = TrackCommand::Type;
+
   if (parameterID == "playAll") {
     if (newValue >= 0.5f)
-      startPlayback();
+      trackManager.playAll();
     else
-      stopPlayback();
+      trackManager.stopPlayback();
     return;
   }
 
   if (parameterID == "monitor")
     return;
 
-  auto *track = findTrack(currentTrackId);
-  if (track == nullptr)
+  const int trackId = currentTrackId.load();
+  if (trackId < 0)
     return;
 
   if (parameterID == "record") {
-    bool shouldBeRecording = newValue >= 0.5f;
-    if (track->isRecording() == shouldBeRecording)
-      return;
-    if (shouldBeRecording)
-      trackManager.startRecordingTrack(currentTrackId);
-    else
-      trackManager.stopRecordingTrack(currentTrackId);
+    trackManager.postCommand(
+        {newValue >= 0.5f ? Type::startRecording : Type::stopRecording,
+         trackId});
   } else if (parameterID == "play") {
-    bool shouldBePlaying = newValue >= 0.5f;
-    if (track->isPlaying() == shouldBePlaying)
-      return;
-    if (shouldBePlaying)
-      trackManager.startPlaybackTrack(currentTrackId);
-    else
-      trackManager.stopPlaybackTrack(currentTrackId);
+    trackManager.postCommand(
+        {newValue >= 0.5f ? Type::startPlayback : Type::stopPlayback, trackId});
   } else if (parameterID == "solo") {
-    bool shouldBeSoloed = newValue >= 0.5f;
-    if (track->isSoloed() == shouldBeSoloed)
-      return;
-    track->setSoloed(shouldBeSoloed);
+    trackManager.postCommand(
+        {Type::setSolo, trackId, newValue >= 0.5f ? 1.0f : 0.0f});
   } else if (parameterID == "clear" && newValue >= 0.5f) {
-    clearTrack(currentTrackId);
+    trackManager.postCommand({Type::clear, trackId});
     if (auto *param = parameters.getParameter("clear"))
       param->setValueNotifyingHost(0.0f);
   } else if (parameterID == "undo" && newValue >= 0.5f) {
-    undoTrack(currentTrackId);
+    trackManager.postCommand({Type::undo, trackId});
     if (auto *param = parameters.getParameter("undo"))
       param->setValueNotifyingHost(0.0f);
   }
 }
 
 void LooperAudioProcessor::syncParamsWithCurrentTrack() {
-  auto *track = findTrack(currentTrackId);
-  if (track == nullptr) {
-    if (auto *p = parameters.getParameter("record"))
-      p->setValueNotifyingHost(0.0f);
-    if (auto *p = parameters.getParameter("play"))
-      p->setValueNotifyingHost(0.0f);
-    if (auto *p = parameters.getParameter("solo"))
-      p->setValueNotifyingHost(0.0f);
-    return;
-  }
+  // Read under the readers lock, but notify the host outside it
+  bool recording = false, playing = false, soloed = false;
+  trackManager.withTrack(trackManager.getTrackHandle(currentTrackId),
+                         [&](Track &track) {
+                           recording = track.isRecording();
+                           playing = track.isPlaying();
+                           soloed = track.isSoloed();
+                         });
+
   if (auto *p = parameters.getParameter("record"))
-    p->setValueNotifyingHost(track->isRecording() ? 1.0f : 0.0f);
+    p->setValueNotifyingHost(recording ? 1.0f : 0.0f);
   if (auto *p = parameters.getParameter("play"))
-    p->setValueNotifyingHost(track->isPlaying() ? 1.0f : 0.0f);
+    p->setValueNotifyingHost(playing ? 1.0f : 0.0f);
   if (auto *p = parameters.getParameter("solo"))
-    p->setValueNotifyingHost(track->isSoloed() ? 1.0f : 0.0f);
+    p->setValueNotifyingHost(soloed ? 1.0f : 0.0f);
 }
 
 juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter() {
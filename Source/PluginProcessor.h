@@ -58,16 +58,30 @@ public:
   void getStateInformation(juce::MemoryBlock &destData) override;
   void setStateInformation(const void *data, int sizeInBytes) override;
 
+  // Whether saved sessions store their audio losslessly compressed (the
+  // default) or as raw floats; sessions load either way
+  void setCompressSavedAudio(bool shouldCompress) {
+    compressSavedAudio = shouldCompress;
+  }
+
+  // How far setStateInformation() has got restoring a session, from 0 to 1
+  // (1 when no session is being loaded). Safe from any thread.
+  float getRestoreProgress() const { return restoreProgress.load(); }
+
   juce::AudioProcessorValueTreeState parameters;
 
-  // Track management for editor (delegated to TrackManager)
-  Track *addTrack() { return trackManager.addTrack(); }
+  // Track management for editor (delegated to TrackManager). A restore may
+  // replace the tracks on another thread, so the editor holds them by handle
+  // and reaches them through TrackManager::withTrack().
+  TrackHandle addTrack() {
+    auto *track = trackManager.addTrack();
+    return track != nullptr ? track->getHandle() : TrackHandle{};
+  }
   void removeTrack(int trackId) { trackManager.removeTrack(trackId); }
   void removeAllTracks() { trackManager.removeAllTracks(); }
-  std::vector<Track *> getTracks() {
-    return trackManager.getTracks();
+  std::vector<TrackHandle> getTrackHandles() const {
+    return trackManager.getTrackHandles();
   }
-  Track *findTrack(int trackId) { return trackManager.findTrack(trackId); }
   int getTrackCount() const { return trackManager.getTrackCount(); }
 
   // Track controls (delegated to TrackManager)
@@ -95,6 +109,11 @@ public:
   // Solo logic (delegated to TrackManager)
   bool isAnyTrackSoloed() const { return trackManager.isAnyTrackSoloed(); }
 
+  // Latest state published by the audio thread (message thread only)
+  const TelemetrySnapshot &getTelemetry() {
+    return trackManager.getTelemetry();
+  }
+
   // Access to track manager
   TrackManager &getTrackManager() { return trackManager; }
 
@@ -125,6 +144,30 @@ private:
 
   // State
   double currentSampleRate = 44100.0;
+  std::atomic<bool> compressSavedAudio{true};
+  std::atomic<float> restoreProgress{1.0f};
+
+  // Crash journal: one directory per instance, named in saved sessions so
+  // that a session lost to a crash comes back when the host reloads it.
+  // Started with audio, and deleted when the instance closes cleanly.
+  juce::String journalName = juce::Uuid().toString();
+  bool journalStarted = false;
+  juce::CriticalSection journalLock; // guards journalName
+
+  // Playback is rendered in parallel once enough tracks are audible (see
+  // TrackManager::setParallelRendering). The workers are started with
+  // audio, one per spare physical core up to a few, leaving the rest to the
+  // host.
+  static constexpr int maxRenderWorkers = 3;
+  bool renderWorkersStarted = false;
+
+  static juce::File getJournalFile(const juce::String &name);
+  juce::String getJournalName() const;
+
+  // Restore the session from the journal named in `reader`, if one was left
+  // behind, and carry on writing to it. False to read the session instead.
+  bool recoverJournal(const SessionReader &reader,
+                      const std::function<void(double)> &progress);
 
   juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
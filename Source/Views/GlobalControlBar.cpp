@@ -104,6 +104,18 @@ void GlobalControlBar::setupComponents() {
   };
   addAndMakeVisible(undoLastButton);
 
+  // Export button
+  exportButton.setButtonText("Export");
+  exportButton.onClick = [this]() {
+    if (onExport) {
+      onExport();
+    }
+  };
+  addAndMakeVisible(exportButton);
+
+  // Master level meter
+  addAndMakeVisible(masterMeter);
+
   // Status label
   statusLabel.setText("Ready", juce::dontSendNotification);
   statusLabel.setJustificationType(juce::Justification::right);
@@ -159,9 +171,17 @@ void GlobalControlBar::resized() {
   clearAllButton.setBounds(bottomRow.removeFromLeft(smallButtonWidth));
   bottomRow.removeFromLeft(5);
   undoLastButton.setBounds(bottomRow.removeFromLeft(smallButtonWidth));
+  bottomRow.removeFromLeft(5);
+  exportButton.setBounds(bottomRow.removeFromLeft(smallButtonWidth));
 
   // Info label on the right
   infoLabel.setBounds(bottomRow.removeFromRight(150));
+
+  // Master meter in whatever is left between them
+  bottomRow.removeFromLeft(20);
+  masterMeter.setBounds(
+      bottomRow.removeFromLeft(juce::jmin(bottomRow.getWidth(), 160))
+          .reduced(0, 6));
 }
 
 void GlobalControlBar::setPlayAllButtonState(bool isPlaying) {
@@ -187,10 +207,27 @@ void GlobalControlBar::updateButtonStyles() {
     setStatusText("Stopped");
 }
 
+void GlobalControlBar::setMasterLevel(const MeterReading &reading) {
+  masterMeter.setReading(reading);
+}
+
 void GlobalControlBar::setStatusText(const juce::String &text) {
   statusLabel.setText(text, juce::dontSendNotification);
 }
 
+void GlobalControlBar::setProgress(const juce::String &task,
+                                   float progress) {
+  if (progress < 1.0f)
+    setStatusText(task + " " +
+                  juce::String(juce::roundToInt(progress * 100.0f)) + "%");
+  else
+    updateButtonStyles();
+}
+
+void GlobalControlBar::setExportButtonState(bool isExporting) {
+  exportButton.setButtonText(isExporting ? "Cancel" : "Export");
+}
+
 void GlobalControlBar::setLoopInfo(int trackCount, int totalLoops) {
   infoLabel.setText("Tracks: " + juce::String(trackCount) +
                         " | Loops: " + juce::String(totalLoops),
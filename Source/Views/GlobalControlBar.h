@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "LevelMeterView.h"
 #include <functional>
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_gui_basics/juce_gui_basics.h>
@@ -31,6 +32,8 @@
  * - Monitor button (input monitoring)
  * - Clear All button
  * - Undo Last button (on last modified track or global undo)
+ * - Export button (tracks and master to audio files)
+ * - Master level meter
  * - Status/Info display
  */
 class GlobalControlBar : public juce::Component,
@@ -42,6 +45,7 @@ public:
   std::function<void()> onStopAll;
   std::function<void()> onClearAll;
   std::function<void()> onUndoLast;
+  std::function<void()> onExport;
 
   GlobalControlBar(juce::AudioProcessorValueTreeState &parameters);
   ~GlobalControlBar() override;
@@ -57,9 +61,19 @@ public:
   void setStatusText(const juce::String &text);
   void setLoopInfo(int trackCount, int totalLoops);
 
+  // Show how far a long job (a session loading, an export) has got, going
+  // back to the play state at 1
+  void setProgress(const juce::String &task, float progress);
+
+  // Turn the export button into a cancel button while an export runs
+  void setExportButtonState(bool isExporting);
+
   // Set play all button state without triggering callbacks
   void setPlayAllButtonState(bool isPlaying);
 
+  // Show the level of the output
+  void setMasterLevel(const MeterReading &reading);
+
 private:
   juce::AudioProcessorValueTreeState &parameters;
 
@@ -74,6 +88,9 @@ private:
 
   juce::TextButton clearAllButton;
   juce::TextButton undoLastButton;
+  juce::TextButton exportButton;
+
+  LevelMeterView masterMeter{false};
 
   // Labels
   juce::Label titleLabel;
@@ -0,0 +1,99 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LevelMeterView.h"
+
+LevelMeterView::LevelMeterView(bool isVertical) : vertical(isVertical) {
+  setInterceptsMouseClicks(false, false);
+}
+
+LevelMeterView::~LevelMeterView() {}
+
+int LevelMeterView::toPixels(float gain) const {
+  const int length = vertical ? getHeight() : getWidth();
+  const float db = juce::Decibels::gainToDecibels(gain, minimumDb);
+  return juce::roundToInt(juce::jmap(db, minimumDb, 0.0f, 0.0f,
+                                     static_cast<float>(length)));
+}
+
+void LevelMeterView::setReading(const MeterReading &reading) {
+  // Clipping changes the colour even where the bar doesn't move
+  auto looksDifferent = [this](float a, float b) {
+    return toPixels(a) != toPixels(b) || (a >= 1.0f) != (b >= 1.0f);
+  };
+
+  bool changed = false;
+  for (size_t channel = 0; channel < reading.peak.size(); ++channel) {
+    changed = changed ||
+              looksDifferent(reading.peak[channel], shown.peak[channel]) ||
+              looksDifferent(reading.rms[channel], shown.rms[channel]) ||
+              looksDifferent(reading.peakHold[channel],
+                             shown.peakHold[channel]);
+  }
+
+  shown = reading;
+  if (changed)
+    repaint();
+}
+
+void LevelMeterView::paint(juce::Graphics &g) {
+  g.fillAll(juce::Colours::black);
+
+  auto bounds = getLocalBounds();
+  const int numChannels = static_cast<int>(shown.peak.size());
+  const int laneSize =
+      (vertical ? bounds.getWidth() : bounds.getHeight()) / numChannels;
+  const float warning = juce::Decibels::decibelsToGain(warningDb);
+
+  for (size_t channel = 0; channel < shown.peak.size(); ++channel) {
+    auto lane = vertical ? bounds.removeFromLeft(laneSize)
+                         : bounds.removeFromTop(laneSize);
+    lane.reduce(vertical ? 1 : 0, vertical ? 0 : 1);
+
+    // A bar from the quiet end of the lane out to `gain`
+    auto bar = [this, lane](float gain) {
+      auto area = lane;
+      const int pixels = toPixels(gain);
+      return vertical ? area.removeFromBottom(pixels)
+                      : area.removeFromLeft(pixels);
+    };
+
+    const float peak = shown.peak[channel];
+    const auto colour = peak >= 1.0f      ? juce::Colours::red
+                        : peak >= warning ? juce::Colours::yellow
+                                          : juce::Colours::limegreen;
+
+    g.setColour(colour.withAlpha(0.45f));
+    g.fillRect(bar(peak));
+    g.setColour(colour);
+    g.fillRect(bar(shown.rms[channel]));
+
+    // Held peak as a line across the lane
+    const float hold = shown.peakHold[channel];
+    const int holdPixels = toPixels(hold);
+    if (holdPixels > 0) {
+      g.setColour(hold >= 1.0f ? juce::Colours::red : juce::Colours::white);
+      if (vertical)
+        g.fillRect(lane.getX(), lane.getBottom() - holdPixels,
+                   lane.getWidth(), 1);
+      else
+        g.fillRect(lane.getX() + holdPixels - 1, lane.getY(), 1,
+                   lane.getHeight());
+    }
+  }
+}
@@ -0,0 +1,52 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../Models/LevelMeter.h"
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * LevelMeterView - Stereo level meter on a dB scale
+ *
+ * Draws a bar per channel: RMS filled solid, peak lighter above it, and the
+ * held peak as a line. Bars turn yellow near full scale and red at it.
+ * setReading() only repaints when something moves by a pixel or more.
+ */
+class LevelMeterView : public juce::Component {
+public:
+  explicit LevelMeterView(bool isVertical);
+  ~LevelMeterView() override;
+
+  void paint(juce::Graphics &g) override;
+
+  // Show the latest reading, repainting only if it looks different
+  void setReading(const MeterReading &reading);
+
+private:
+  static constexpr float minimumDb = -60.0f;
+  static constexpr float warningDb = -6.0f;
+
+  const bool vertical;
+  MeterReading shown;
+
+  // Pixels from the quiet end of the meter to the level `gain`
+  int toPixels(float gain) const;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeterView)
+};
@@ -18,11 +18,112 @@
 
 #include "LoopWaveform.h"
 
-LoopWaveform::LoopWaveform(Track &t) : track(t) {}
+LoopWaveform::LoopWaveform(TrackManager &m, TrackHandle h)
+    : manager(m), handle(h) {}
 
 LoopWaveform::~LoopWaveform() {}
 
+void LoopWaveform::resized() { cacheValid = false; }
+
+void LoopWaveform::refresh(const TelemetrySnapshot &snapshot,
+                           const TrackTelemetry &trackTelemetry) {
+  telemetry = trackTelemetry;
+  baseLoopLength = snapshot.baseLoopLength;
+  readPosition = snapshot.readPosition;
+
+  const int displayLength = updateDisplayLength();
+  const auto generation = telemetry.contentGeneration;
+
+  if (generation != shownGeneration || displayLength != shownDisplayLength) {
+    shownGeneration = generation;
+    shownDisplayLength = displayLength;
+    repaint();
+    return;
+  }
+
+  // Only the cursors moved
+  int playX = -1, recX = -1;
+  getCursorColumns(playX, recX);
+  if (playX != playheadX) {
+    repaintColumn(playheadX);
+    repaintColumn(playX);
+  }
+  if (recX != recordX) {
+    repaintColumn(recordX);
+    repaintColumn(recX);
+  }
+}
+
 void LoopWaveform::paint(juce::Graphics &g) {
+  const int displayLength = updateDisplayLength();
+  const auto generation = telemetry.contentGeneration;
+  const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+  if (!cacheValid || generation != cachedGeneration ||
+      displayLength != cachedDisplayLength ||
+      cachedBody.getWidth() != juce::roundToInt(getWidth() * scale)) {
+    cachedGeneration = generation;
+    cachedDisplayLength = displayLength;
+    renderBody(scale, displayLength);
+  }
+
+  g.drawImage(cachedBody, getLocalBounds().toFloat());
+
+  getCursorColumns(playheadX, recordX);
+  auto bounds = getLocalBounds();
+  float centerY = bounds.getCentreY();
+
+  // Playhead (only show once we have a real loop length)
+  if (playheadX >= 0) {
+    g.setColour(juce::Colours::orange);
+    g.drawVerticalLine(playheadX, bounds.getY(), bounds.getBottom());
+    g.setColour(juce::Colours::white.withAlpha(0.6f));
+    g.drawVerticalLine(playheadX, centerY - 1.0f, centerY + 1.0f);
+  }
+
+  // Recording position (only show once we have a real loop length)
+  if (recordX >= 0) {
+    g.setColour(juce::Colours::red.withAlpha(0.8f));
+    g.drawVerticalLine(recordX, bounds.getY(), bounds.getBottom());
+  }
+}
+
+int LoopWaveform::updateDisplayLength() {
+  if (baseLoopLength > 0) {
+    assumedLength = 0;
+    return baseLoopLength;
+  }
+
+  // During first recording, assume a length and grow it as needed
+  if (!telemetry.recording) {
+    assumedLength = 0;
+    return 0;
+  }
+
+  if (assumedLength <= 0) {
+    double sampleRate = 44100.0;
+    manager.withTrack(handle, [&sampleRate](Track &track) {
+      sampleRate = track.getLooper().getSampleRate();
+    });
+    assumedLength = static_cast<int>(sampleRate * 8.0);
+  }
+  int writePos = telemetry.recordingLength;
+  while (writePos > assumedLength) {
+    assumedLength = static_cast<int>(assumedLength * 1.2);
+  }
+  return assumedLength;
+}
+
+void LoopWaveform::renderBody(float scale, int displayLength) {
+  cacheValid = true;
+  cachedBody = juce::Image(juce::Image::ARGB,
+                           juce::jmax(1, juce::roundToInt(getWidth() * scale)),
+                           juce::jmax(1, juce::roundToInt(getHeight() * scale)),
+                           true);
+
+  juce::Graphics g(cachedBody);
+  g.addTransform(juce::AffineTransform::scale(scale));
+
   auto bounds = getLocalBounds();
   float w = static_cast<float>(bounds.getWidth());
   float h = static_cast<float>(bounds.getHeight());
@@ -32,57 +133,46 @@ void LoopWaveform::paint(juce::Graphics &g) {
   g.setColour(juce::Colours::black.withAlpha(0.35f));
   g.fillRect(bounds);
 
-  auto &looper = track.getLooper();
-  int baseLen = track.getBaseLoopLength();
+  if (displayLength <= 0) {
+    g.setColour(juce::Colours::grey);
+    g.drawText("No loop", bounds, juce::Justification::centred, false);
+    return;
+  }
 
-  // During first recording, assume a length and grow it as needed
-  int displayLen = baseLen;
-  if (displayLen <= 0) {
-    if (track.isRecording()) {
-      if (assumedLength <= 0) {
-        assumedLength = static_cast<int>(looper.getSampleRate() * 8.0);
-      }
-      int writePos = looper.getRecordingLength();
-      while (writePos > assumedLength) {
-        assumedLength = static_cast<int>(assumedLength * 1.2);
-      }
-      displayLen = assumedLength;
-    } else {
-      assumedLength = 0;
-      g.setColour(juce::Colours::grey);
-      g.drawText("No loop", bounds, juce::Justification::centred, false);
-      return;
-    }
-  } else {
-    assumedLength = 0;
+  // One min/max pair per pixel, read from the peak pyramids
+  int numBins = juce::jmax(1, bounds.getWidth());
+  std::vector<PeakPyramid::Range> peaks;
+  if (!manager.withTrack(handle, [&](Track &track) {
+        peaks = track.getLooper().getWaveformPeaks(numBins, 0, displayLength);
+      })) {
+    g.setColour(juce::Colours::grey);
+    g.drawText("No loop", bounds, juce::Justification::centred, false);
+    return;
   }
 
   // Center line
   g.setColour(juce::Colours::darkgrey);
   g.drawHorizontalLine(static_cast<int>(centerY), 0.0f, w);
 
-  // Get waveform peaks using the display length
-  int numBins = juce::jmax(1, bounds.getWidth());
-  auto peaks = looper.getWaveformPeaks(numBins, 0, displayLen);
-
-  // Build filled waveform path
+  // Build filled waveform path: maxima along the top, minima back along
+  // the bottom
   juce::Path path;
   float ampScale = h * 0.48f;
+  auto yFor = [centerY, ampScale](float sample) {
+    float boosted = juce::jlimit(-1.0f, 1.0f, sample * 2.5f);
+    return centerY - boosted * ampScale;
+  };
 
   path.startNewSubPath(0.0f, centerY);
 
   for (int x = 0; x < numBins; ++x) {
-    float boosted = juce::jmin(1.0f, peaks[static_cast<size_t>(x)] * 2.5f);
-    float y = centerY - boosted * ampScale;
-    path.lineTo(static_cast<float>(x), y);
+    path.lineTo(static_cast<float>(x), yFor(peaks[static_cast<size_t>(x)].max));
   }
 
   path.lineTo(w - 1.0f, centerY);
 
   for (int x = numBins - 1; x >= 0; --x) {
-    float boosted = juce::jmin(1.0f, peaks[static_cast<size_t>(x)] * 2.5f);
-    float y = centerY + boosted * ampScale;
-    path.lineTo(static_cast<float>(x), y);
+    path.lineTo(static_cast<float>(x), yFor(peaks[static_cast<size_t>(x)].min));
   }
 
   path.closeSubPath();
@@ -94,22 +184,24 @@ void LoopWaveform::paint(juce::Graphics &g) {
   // Outline waveform
   g.setColour(juce::Colours::cyan.withAlpha(0.8f));
   g.strokePath(path, juce::PathStrokeType(1.0f));
+}
 
-  // Playhead (only show once we have a real loop length)
-  if (baseLen > 0 && looper.isPlaying()) {
-    float playX = static_cast<float>(track.getReadPosition()) / baseLen * w;
-    g.setColour(juce::Colours::orange);
-    g.drawVerticalLine(static_cast<int>(playX), bounds.getY(),
-                       bounds.getBottom());
-    g.setColour(juce::Colours::white.withAlpha(0.6f));
-    g.drawVerticalLine(static_cast<int>(playX), centerY - 1.0f, centerY + 1.0f);
-  }
+void LoopWaveform::getCursorColumns(int &playX, int &recX) const {
+  playX = -1;
+  recX = -1;
 
-  // Recording position (only show once we have a real loop length)
-  if (baseLen > 0 && track.isRecording()) {
-    float recX = static_cast<float>(track.getReadPosition()) / baseLen * w;
-    g.setColour(juce::Colours::red.withAlpha(0.8f));
-    g.drawVerticalLine(static_cast<int>(recX), bounds.getY(),
-                       bounds.getBottom());
-  }
+  if (baseLoopLength <= 0)
+    return;
+
+  const int x = static_cast<int>(static_cast<float>(readPosition) /
+                                 baseLoopLength * getWidth());
+  if (telemetry.playing)
+    playX = x;
+  if (telemetry.recording)
+    recX = x;
+}
+
+void LoopWaveform::repaintColumn(int x) {
+  if (x >= 0)
+    repaint(x - 1, 0, 3, getHeight());
 }
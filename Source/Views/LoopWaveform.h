@@ -18,7 +18,9 @@
 
 #pragma once
 
+#include "../Models/Telemetry.h"
 #include "../Models/Track.h"
+#include "../Models/TrackManager.h"
 #include <juce_gui_basics/juce_gui_basics.h>
 
 /**
@@ -28,17 +30,57 @@
  * - Combined waveform of all loops in the track
  * - Playhead position when playing
  * - Recording position when recording
+ *
+ * The waveform is rendered into a cached image that is only redrawn when the
+ * looper's content generation, the display length or the size changes. The
+ * cursors are drawn over it, and moving them only repaints their columns.
+ *
+ * The track is held by handle, since a restore may free it on another
+ * thread; once it is gone the waveform shows no loop.
  */
 class LoopWaveform : public juce::Component {
 public:
-  LoopWaveform(Track &track);
+  LoopWaveform(TrackManager &manager, TrackHandle handle);
   ~LoopWaveform() override;
 
   void paint(juce::Graphics &g) override;
+  void resized() override;
+
+  // Take the latest telemetry and repaint whatever changed
+  void refresh(const TelemetrySnapshot &snapshot,
+               const TrackTelemetry &trackTelemetry);
 
 private:
-  Track &track;
+  TrackManager &manager;
+  TrackHandle handle;
   int assumedLength = 0;
 
+  // State from the last refresh()
+  TrackTelemetry telemetry;
+  int baseLoopLength = 0;
+  int readPosition = 0;
+
+  // What the cached body was drawn from
+  juce::Image cachedBody;
+  juce::uint32 cachedGeneration = 0;
+  int cachedDisplayLength = -1;
+  bool cacheValid = false;
+
+  // What refresh() last asked to be shown
+  juce::uint32 shownGeneration = 0;
+  int shownDisplayLength = -1;
+
+  // Cursor columns as last painted, or -1 when hidden
+  int playheadX = -1;
+  int recordX = -1;
+
+  // Length the waveform spans: the base loop, or a guess that grows during
+  // the first recording; 0 when there is nothing to show
+  int updateDisplayLength();
+
+  void renderBody(float scale, int displayLength);
+  void getCursorColumns(int &playX, int &recX) const;
+  void repaintColumn(int x);
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopWaveform)
 };
@@ -60,47 +60,46 @@ void TrackContainer::resized() {
                     bounds.getHeight());
 }
 
-void TrackContainer::addTrackView(Track *track) {
-  if (track == nullptr)
+void TrackContainer::addTrackView(TrackManager &manager, TrackHandle handle) {
+  // Create track view - TrackView looks the track up by handle
+  auto trackView = std::make_unique<TrackView>(manager, handle);
+  if (trackView->isStale())
     return;
 
-  // Create track view - TrackView stores reference to track
-  auto trackView = std::make_unique<TrackView>(track->getId(), *track);
-
   // Setup callbacks
-  trackView->onRemoveTrack = [this](int trackId) {
+  trackView->onRemoveTrack = [this](TrackHandle track) {
     if (onRemoveTrack) {
-      onRemoveTrack(trackId);
+      onRemoveTrack(track);
     }
   };
 
-  trackView->onRecordClicked = [this](int trackId, bool isRecording) {
+  trackView->onRecordClicked = [this](TrackHandle track, bool isRecording) {
     if (onRecordTrack) {
-      onRecordTrack(trackId, isRecording);
+      onRecordTrack(track, isRecording);
     }
   };
 
-  trackView->onPlayClicked = [this](int trackId, bool isPlaying) {
+  trackView->onPlayClicked = [this](TrackHandle track, bool isPlaying) {
     if (onPlayTrack) {
-      onPlayTrack(trackId, isPlaying);
+      onPlayTrack(track, isPlaying);
     }
   };
 
-  trackView->onClearTrack = [this](int trackId) {
+  trackView->onClearTrack = [this](TrackHandle track) {
     if (onClearTrack) {
-      onClearTrack(trackId);
+      onClearTrack(track);
     }
   };
 
-  trackView->onUndoTrack = [this](int trackId) {
+  trackView->onUndoTrack = [this](TrackHandle track) {
     if (onUndoTrack) {
-      onUndoTrack(trackId);
+      onUndoTrack(track);
     }
   };
 
   trackView->onTrackClicked = [this](int trackId) { selectTrack(trackId); };
 
-  int id = track->getId();
+  int id = trackView->getTrackId();
   trackView->isSelectedCallback = [this, id]() {
     return id == selectedTrackId;
   };
@@ -125,9 +124,17 @@ void TrackContainer::removeAllTrackViews() {
   resized();
 }
 
-void TrackContainer::refreshTrackViews() {
+bool TrackContainer::hasStaleTrackViews() const {
+  for (const auto &trackView : trackList.getTrackViews()) {
+    if (trackView->isStale())
+      return true;
+  }
+  return false;
+}
+
+void TrackContainer::refreshTrackViews(const TelemetrySnapshot &snapshot) {
   for (auto &trackView : trackList.getTrackViews()) {
-    trackView->updateFromTrack();
+    trackView->updateFromTrack(snapshot);
   }
 }
 
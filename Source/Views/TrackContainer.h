@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "../Models/Track.h"
+#include "../Models/TrackManager.h"
 #include "TrackView.h"
 #include <functional>
 #include <juce_gui_basics/juce_gui_basics.h>
@@ -37,25 +37,29 @@ class TrackContainer : public juce::Component {
 public:
   // Callbacks
   std::function<void()> onAddTrack;
-  std::function<void(int)> onRemoveTrack;
-  std::function<void(int, bool)> onRecordTrack;
-  std::function<void(int, bool)> onPlayTrack;
-  std::function<void(int)> onClearTrack;
-  std::function<void(int)> onUndoTrack;
+  std::function<void(TrackHandle)> onRemoveTrack;
+  std::function<void(TrackHandle, bool)> onRecordTrack;
+  std::function<void(TrackHandle, bool)> onPlayTrack;
+  std::function<void(TrackHandle)> onClearTrack;
+  std::function<void(TrackHandle)> onUndoTrack;
   std::function<void(int)> onSelectedTrackChanged;
   std::function<void()> onRefreshUI;
 
   TrackContainer();
   ~TrackContainer() override;
 
-  // Track management - TrackContainer does NOT own tracks, just the views
-  void addTrackView(
-      Track *track); // Takes raw pointer - track owned by PluginProcessor
+  // Track management - TrackContainer does NOT own tracks, just the views,
+  // which refer to them by handle. A handle that no longer names a track
+  // adds nothing.
+  void addTrackView(TrackManager &manager, TrackHandle handle);
   void removeTrackView(int trackId);
   void removeAllTrackViews();
 
+  // True if any view's track has been removed or replaced by a restore
+  bool hasStaleTrackViews() const;
+
   // Refresh all track views (call during timer callback)
-  void refreshTrackViews();
+  void refreshTrackViews(const TelemetrySnapshot &snapshot);
 
   // Selection
   void selectTrack(int trackId);
@@ -80,6 +84,9 @@ private:
     std::vector<std::unique_ptr<TrackView>> &getTrackViews() {
       return trackViews;
     }
+    const std::vector<std::unique_ptr<TrackView>> &getTrackViews() const {
+      return trackViews;
+    }
 
   private:
     TrackContainer &owner;
@@ -18,16 +18,31 @@
 
 #include "TrackView.h"
 
-TrackView::TrackView(int id, Track &t) : trackId(id), track(t), waveform(t) {
+TrackView::TrackView(TrackManager &m, TrackHandle h)
+    : manager(m), handle(h), waveform(m, h) {
+  // Until the first snapshot that includes this track arrives
+  manager.withTrack(handle, [this](Track &track) {
+    trackId = track.getId();
+    trackName = track.getName();
+    telemetry.version = track.getStateVersion();
+    telemetry.volume = track.getVolume();
+    telemetry.soloed = track.isSoloed();
+    telemetry.recording = track.isRecording();
+    telemetry.playing = track.isPlaying();
+  });
+  telemetry.trackId = trackId;
+
   setupComponents();
-  updateFromTrack();
+  applyTelemetry();
 }
 
 TrackView::~TrackView() {}
 
+bool TrackView::isStale() const { return manager.resolve(handle) == nullptr; }
+
 void TrackView::setupComponents() {
   // Track name label
-  trackNameLabel.setText(track.getName(), juce::dontSendNotification);
+  trackNameLabel.setText(trackName, juce::dontSendNotification);
   trackNameLabel.setJustificationType(juce::Justification::centred);
   trackNameLabel.setFont(juce::Font(juce::FontOptions(14.0f, juce::Font::bold)));
   addAndMakeVisible(trackNameLabel);
@@ -36,12 +51,17 @@ void TrackView::setupComponents() {
   volumeSlider.setSliderStyle(juce::Slider::LinearVertical);
   volumeSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 50, 20);
   volumeSlider.setRange(0.0, 1.0, 0.01);
-  volumeSlider.setValue(track.getVolume());
+  volumeSlider.setValue(telemetry.volume);
   volumeSlider.onValueChange = [this]() {
-    track.setVolume(static_cast<float>(volumeSlider.getValue()));
+    const auto volume = static_cast<float>(volumeSlider.getValue());
+    manager.withTrack(handle,
+                      [volume](Track &track) { track.setVolume(volume); });
   };
   addAndMakeVisible(volumeSlider);
 
+  // Playback level meter beside the slider
+  addAndMakeVisible(meter);
+
   // Record button
   recordButton.setButtonText("Record");
   recordButton.setColour(juce::TextButton::buttonColourId, juce::Colours::grey);
@@ -52,7 +72,7 @@ void TrackView::setupComponents() {
   recordButton.setClickingTogglesState(true);
   recordButton.onClick = [this]() {
     if (onRecordClicked)
-      onRecordClicked(trackId, recordButton.getToggleState());
+      onRecordClicked(handle, recordButton.getToggleState());
   };
   addAndMakeVisible(recordButton);
 
@@ -65,7 +85,7 @@ void TrackView::setupComponents() {
   playButton.setClickingTogglesState(true);
   playButton.onClick = [this]() {
     if (onPlayClicked)
-      onPlayClicked(trackId, playButton.getToggleState());
+      onPlayClicked(handle, playButton.getToggleState());
   };
   addAndMakeVisible(playButton);
 
@@ -77,7 +97,9 @@ void TrackView::setupComponents() {
   soloButton.setColour(juce::TextButton::textColourOnId, juce::Colours::black);
   soloButton.setClickingTogglesState(true);
   soloButton.onClick = [this]() {
-    track.setSoloed(soloButton.getToggleState());
+    const bool soloed = soloButton.getToggleState();
+    manager.withTrack(handle,
+                      [soloed](Track &track) { track.setSoloed(soloed); });
   };
   addAndMakeVisible(soloButton);
 
@@ -85,7 +107,7 @@ void TrackView::setupComponents() {
   clearButton.setButtonText("Clear");
   clearButton.onClick = [this]() {
     if (onClearTrack) {
-      onClearTrack(trackId);
+      onClearTrack(handle);
     }
   };
   addAndMakeVisible(clearButton);
@@ -94,7 +116,7 @@ void TrackView::setupComponents() {
   undoButton.setButtonText("Undo");
   undoButton.onClick = [this]() {
     if (onUndoTrack) {
-      onUndoTrack(trackId);
+      onUndoTrack(handle);
     }
   };
   addAndMakeVisible(undoButton);
@@ -103,7 +125,7 @@ void TrackView::setupComponents() {
   removeButton.setButtonText("X");
   removeButton.onClick = [this]() {
     if (onRemoveTrack) {
-      onRemoveTrack(trackId);
+      onRemoveTrack(handle);
     }
   };
   addAndMakeVisible(removeButton);
@@ -134,7 +156,7 @@ void TrackView::paint(juce::Graphics &g) {
   g.drawRect(getLocalBounds(), 1);
 
   // Highlight if this track is recording
-  if (track.isRecording()) {
+  if (telemetry.recording) {
     g.setColour(juce::Colours::red.withAlpha(0.3f));
     g.fillRect(getLocalBounds());
   }
@@ -185,34 +207,55 @@ void TrackView::resized() {
   // Leave room for the text box below the slider
   bounds.removeFromBottom(20);
 
+  // Level meter beside the slider, level with the slider's track
+  meter.setBounds(bounds.removeFromRight(12).withTrimmedBottom(20));
+  bounds.removeFromRight(3);
+
   // Volume slider takes whatever space is left
   volumeSlider.setBounds(bounds);
 }
 
-void TrackView::updateFromTrack() {
-  // Sync UI with track state
-  volumeSlider.setValue(track.getVolume(), juce::dontSendNotification);
-  soloButton.setToggleState(track.isSoloed(), juce::dontSendNotification);
-  recordButton.setToggleState(track.isRecording(), juce::dontSendNotification);
-  playButton.setToggleState(track.isPlaying(), juce::dontSendNotification);
+void TrackView::updateFromTrack(const TelemetrySnapshot &snapshot) {
+  if (const auto *entry = snapshot.findTrack(handle)) {
+    const bool controlsChanged = entry->version != telemetry.version;
+    const bool loopsChanged = entry->numLoops != telemetry.numLoops;
+    telemetry = *entry;
+
+    // Leave the components alone unless something they show has changed
+    if (controlsChanged)
+      applyTelemetry();
+    else if (loopsChanged)
+      refreshLoopCount();
+  }
+
+  waveform.refresh(snapshot, telemetry);
+  meter.setReading(telemetry.meter);
+}
+
+void TrackView::applyTelemetry() {
+  // Sync UI with track state; the telemetry may lag a drag by a block
+  if (!volumeSlider.isMouseButtonDown())
+    volumeSlider.setValue(telemetry.volume, juce::dontSendNotification);
+  soloButton.setToggleState(telemetry.soloed, juce::dontSendNotification);
+  recordButton.setToggleState(telemetry.recording,
+                              juce::dontSendNotification);
+  playButton.setToggleState(telemetry.playing, juce::dontSendNotification);
 
-  waveform.repaint();
   updateButtonStyles();
   refreshLoopCount();
 }
 
 void TrackView::refreshLoopCount() {
-  int loopCount = static_cast<int>(track.getLooper().getNumLoops());
-  loopCountLabel.setText("Loops: " + juce::String(loopCount),
+  loopCountLabel.setText("Loops: " + juce::String(telemetry.numLoops),
                          juce::dontSendNotification);
 }
 
 void TrackView::updateButtonStyles() {
-  bool playing = track.isPlaying();
+  bool playing = telemetry.playing;
   playButton.setButtonText(playing ? "Stop" : "Play");
   playButton.setToggleState(playing, juce::dontSendNotification);
 
-  bool recording = track.isRecording();
+  bool recording = telemetry.recording;
   recordButton.setToggleState(recording, juce::dontSendNotification);
   recordButton.repaint();
 
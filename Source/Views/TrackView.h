@@ -18,7 +18,10 @@
 
 #pragma once
 
+#include "../Models/Telemetry.h"
 #include "../Models/Track.h"
+#include "../Models/TrackManager.h"
+#include "LevelMeterView.h"
 #include "LoopWaveform.h"
 #include <functional>
 #include <juce_gui_basics/juce_gui_basics.h>
@@ -29,32 +32,37 @@
  * Displays controls for:
  * - Track name/label
  * - Volume slider
+ * - Level meter
  * - Record button
  * - Mute button
  * - Solo button
  * - Remove button
  * - Loop count display
+ *
+ * The track is held by handle and looked up on each use, since a restore
+ * may free it on another thread. A view whose track has gone is stale and
+ * does nothing until it is replaced.
  */
 class TrackView : public juce::Component {
 public:
   // Callbacks
-  std::function<void(int)> onRemoveTrack;
-  std::function<void(int, bool)> onRecordClicked;
-  std::function<void(int, bool)> onPlayClicked;
-  std::function<void(int)> onClearTrack;
-  std::function<void(int)> onUndoTrack;
+  std::function<void(TrackHandle)> onRemoveTrack;
+  std::function<void(TrackHandle, bool)> onRecordClicked;
+  std::function<void(TrackHandle, bool)> onPlayClicked;
+  std::function<void(TrackHandle)> onClearTrack;
+  std::function<void(TrackHandle)> onUndoTrack;
   std::function<void(int)> onTrackClicked;
   std::function<bool()> isSelectedCallback;
 
-  TrackView(int trackId, Track &track);
+  TrackView(TrackManager &manager, TrackHandle handle);
   ~TrackView() override;
 
   void paint(juce::Graphics &g) override;
   void resized() override;
   void mouseDown(const juce::MouseEvent &event) override;
 
-  // Update UI to reflect track state
-  void updateFromTrack();
+  // Update UI to reflect the track's entry in the latest telemetry
+  void updateFromTrack(const TelemetrySnapshot &snapshot);
 
   // Refresh the loop count display
   void refreshLoopCount();
@@ -63,15 +71,27 @@ public:
   void updateButtonStyles();
 
   int getTrackId() const { return trackId; }
+  TrackHandle getHandle() const { return handle; }
+
+  // True once the track has been removed or replaced by a restore
+  bool isStale() const;
 
 private:
-  int trackId;
-  Track &track;
+  TrackManager &manager;
+  TrackHandle handle;
+  int trackId = -1;
+  juce::String trackName;
+
+  // Track state as of the last update
+  TrackTelemetry telemetry;
+
+  void applyTelemetry();
 
   // UI Components
   juce::Label trackNameLabel;
   LoopWaveform waveform;
   juce::Slider volumeSlider;
+  LevelMeterView meter{true};
   juce::TextButton recordButton;
   juce::TextButton soloButton;
   juce::TextButton clearButton;
@@ -0,0 +1,225 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "realtime_checker.h"
+
+#if LOOPER_REALTIME_CHECKS
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+namespace {
+constexpr int maxRecorded = 4;
+constexpr int maxFrames = 48;
+
+struct Violation {
+  const char *call = nullptr;
+  std::array<void *, maxFrames> frames{};
+  int numFrames = 0;
+};
+
+// Nothing here may allocate: it runs inside the interposed calls
+thread_local int scopeDepth = 0;
+thread_local bool reporting = false;
+
+std::atomic<int> numViolations{0};
+std::array<Violation, maxRecorded> recorded;
+
+void noteCall(const char *call) {
+  if (scopeDepth == 0 || reporting)
+    return;
+
+  reporting = true;
+  const int index = numViolations.fetch_add(1);
+  if (index < maxRecorded) {
+    auto &violation = recorded[static_cast<size_t>(index)];
+    violation.call = call;
+    violation.numFrames = backtrace(violation.frames.data(), maxFrames);
+  }
+  reporting = false;
+}
+
+template <typename Function> Function lookUp(const char *name) {
+  return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+}
+
+using MutexFunction = int (*)(pthread_mutex_t *);
+using CondWaitFunction = int (*)(pthread_cond_t *, pthread_mutex_t *);
+using CondTimedWaitFunction = int (*)(pthread_cond_t *, pthread_mutex_t *,
+                                      const timespec *);
+using RwLockFunction = int (*)(pthread_rwlock_t *);
+using SemWaitFunction = int (*)(sem_t *);
+
+struct RealFunctions {
+  MutexFunction mutexLock = lookUp<MutexFunction>("pthread_mutex_lock");
+  CondWaitFunction condWait = reinterpret_cast<CondWaitFunction>(
+      dlvsym(RTLD_NEXT, "pthread_cond_wait", "GLIBC_2.3.2"));
+  CondTimedWaitFunction condTimedWait =
+      reinterpret_cast<CondTimedWaitFunction>(
+          dlvsym(RTLD_NEXT, "pthread_cond_timedwait", "GLIBC_2.3.2"));
+  RwLockFunction readLock = lookUp<RwLockFunction>("pthread_rwlock_rdlock");
+  RwLockFunction writeLock = lookUp<RwLockFunction>("pthread_rwlock_wrlock");
+  SemWaitFunction semWait = lookUp<SemWaitFunction>("sem_wait");
+
+  RealFunctions() {
+    // backtrace() loads the unwinder on first use, which allocates
+    void *frames[2];
+    backtrace(frames, 2);
+  }
+};
+
+RealFunctions &real() {
+  static RealFunctions functions;
+  return functions;
+}
+
+// Resolve everything before any test runs
+const bool resolved = (real(), true);
+} // namespace
+
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void *__libc_memalign(size_t, size_t);
+void __libc_free(void *);
+
+void *malloc(size_t size) {
+  noteCall("malloc");
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  noteCall("calloc");
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+  noteCall("realloc");
+  return __libc_realloc(pointer, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  noteCall("aligned_alloc");
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **result, size_t alignment, size_t size) {
+  noteCall("posix_memalign");
+  *result = __libc_memalign(alignment, size);
+  return *result != nullptr ? 0 : ENOMEM;
+}
+
+void free(void *pointer) {
+  if (pointer != nullptr)
+    noteCall("free");
+  __libc_free(pointer);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) {
+  noteCall("pthread_mutex_lock");
+  return real().mutexLock(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t *condition, pthread_mutex_t *mutex) {
+  noteCall("pthread_cond_wait");
+  return real().condWait(condition, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t *condition, pthread_mutex_t *mutex,
+                           const timespec *deadline) {
+  noteCall("pthread_cond_timedwait");
+  return real().condTimedWait(condition, mutex, deadline);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t *lock) {
+  noteCall("pthread_rwlock_rdlock");
+  return real().readLock(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t *lock) {
+  noteCall("pthread_rwlock_wrlock");
+  return real().writeLock(lock);
+}
+
+int sem_wait(sem_t *semaphore) {
+  noteCall("sem_wait");
+  return real().semWait(semaphore);
+}
+}
+
+namespace RealtimeChecker {
+
+Scope::Scope() { ++scopeDepth; }
+
+Scope::~Scope() { --scopeDepth; }
+
+bool isEnabled() { return resolved; }
+
+int getNumViolations() { return numViolations.load(); }
+
+std::string describeViolations() {
+  std::string description;
+  const int count = std::min(numViolations.load(), maxRecorded);
+  for (int i = 0; i < count; ++i) {
+    const auto &violation = recorded[static_cast<size_t>(i)];
+    description += std::string(violation.call) + " on the audio thread:\n";
+
+    char **symbols =
+        backtrace_symbols(violation.frames.data(), violation.numFrames);
+    for (int frame = 1; frame < violation.numFrames; ++frame)
+      description += std::string("  ") + symbols[frame] + "\n";
+    std::free(symbols);
+  }
+  if (numViolations.load() > count)
+    description += "...and " + std::to_string(numViolations.load() - count) +
+                   " more\n";
+  return description;
+}
+
+void reset() { numViolations.store(0); }
+
+} // namespace RealtimeChecker
+
+#else
+
+namespace RealtimeChecker {
+
+Scope::Scope() {}
+
+Scope::~Scope() {}
+
+bool isEnabled() { return false; }
+
+int getNumViolations() { return 0; }
+
+std::string describeViolations() { return {}; }
+
+void reset() {}
+
+} // namespace RealtimeChecker
+
+#endif
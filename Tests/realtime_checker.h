@@ -0,0 +1,52 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * RealtimeChecker - Catches allocation and blocking on the audio thread
+ *
+ * With LOOPER_REALTIME_CHECKS defined (Linux/glibc), the test binary
+ * interposes the malloc family and the pthread lock and wait primitives.
+ * Any call made by a thread inside a Scope is recorded as a violation along
+ * with a stack trace. Without it, scopes do nothing and isEnabled() is false.
+ */
+namespace RealtimeChecker {
+
+// Treat the current thread as the audio thread until destroyed
+class Scope {
+public:
+  Scope();
+  ~Scope();
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+};
+
+bool isEnabled();
+
+int getNumViolations();
+
+// The first few violations, each with a symbolised stack trace
+std::string describeViolations();
+
+void reset();
+
+} // namespace RealtimeChecker
@@ -0,0 +1,66 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../Source/Models/Track.h"
+#include "../Source/Models/TrackManager.h"
+
+/**
+ * TestHelpers - Recording and inspection shared by the model tests
+ *
+ * Tests run the manager in blocks of `blockSize` samples and record a ramp
+ * that rises by a thousandth per sample, positive on the left channel and
+ * negative on the right.
+ */
+namespace TestHelpers {
+
+constexpr int blockSize = 100;
+
+inline float ramp(int channel, int position) {
+  return static_cast<float>(position) / 1000.0f *
+         (channel == 0 ? 1.0f : -1.0f);
+}
+
+// Record `numBlocks` blocks of the ramp onto a track, from the start of the
+// loop, then stop and run one silent block unless `stop` is false
+inline void recordRamp(TrackManager &manager, Track &track, int numBlocks,
+                       bool stop = true) {
+  juce::AudioBuffer<float> buffer(2, blockSize);
+  manager.startRecordingTrack(track.getId());
+  for (int block = 0; block < numBlocks; ++block) {
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < blockSize; ++i)
+        buffer.setSample(channel, i, ramp(channel, block * blockSize + i));
+    manager.processBlock(buffer, false);
+  }
+  if (!stop)
+    return;
+
+  manager.stopRecordingTrack(track.getId());
+  buffer.clear();
+  manager.processBlock(buffer, false);
+}
+
+// One sample of a track's layer, read from its pages
+inline float layerSample(const Track &track, int channel, int position,
+                         int layer = 0) {
+  return track.getLooper().getLayerSample(layer, channel, position);
+}
+
+} // namespace TestHelpers
@@ -0,0 +1,133 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/LayerCodec.h"
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+// Encode `samples` in frames of `frameSize`, decode them again and return
+// the encoded size, or 0 if any frame failed to decode
+size_t roundTrip(const std::vector<float> &samples,
+                 std::vector<float> &decoded, int frameSize) {
+  LayerCodec encoder;
+  juce::MemoryOutputStream encoded;
+  const int total = static_cast<int>(samples.size());
+  for (int pos = 0; pos < total; pos += frameSize)
+    encoder.encodeFrame(samples.data() + pos,
+                        juce::jmin(frameSize, total - pos), encoded);
+
+  LayerCodec decoder;
+  juce::MemoryInputStream input(encoded.getData(), encoded.getDataSize(),
+                                false);
+  decoded.assign(samples.size(), 1.0f);
+  for (int pos = 0; pos < total; pos += frameSize) {
+    if (!decoder.decodeFrame(input, juce::jmin(frameSize, total - pos),
+                             decoded.data() + pos))
+      return 0;
+  }
+  return encoded.getDataSize();
+}
+
+bool sameBits(const std::vector<float> &a, const std::vector<float> &b) {
+  return a.size() == b.size() &&
+         std::memcmp(a.data(), b.data(), sizeof(float) * a.size()) == 0;
+}
+} // namespace
+
+TEST(LayerCodecTest, RestoresTheExactBitsOfAnySignal) {
+  const int numSamples = 3 * LayerCodec::maxFrameSize + 123;
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+  std::vector<float> silence(numSamples, 0.0f);
+  std::vector<float> quantised(numSamples);
+  std::vector<float> white(numSamples);
+  std::vector<float> awkward(numSamples);
+  std::vector<float> wide(numSamples);
+  for (int i = 0; i < numSamples; ++i) {
+    const auto index = static_cast<size_t>(i);
+    quantised[index] =
+        std::round(std::sin(static_cast<float>(i) * 0.01f) * 8388607.0f) /
+        8388608.0f;
+    white[index] = noise(random);
+
+    // Too wide a range to scale to integers: 2^-100 needs a shift that
+    // takes the louder samples far past int32
+    wide[index] = i % 7 == 0 ? std::ldexp(1.0f, -100) : white[index];
+
+    // Values no scaling can represent, amongst ordinary ones
+    switch (i % 6) {
+    case 0:
+      awkward[index] = -0.0f;
+      break;
+    case 1:
+      awkward[index] = std::numeric_limits<float>::quiet_NaN();
+      break;
+    case 2:
+      awkward[index] = std::numeric_limits<float>::denorm_min() * 3.0f;
+      break;
+    case 3:
+      awkward[index] = -std::numeric_limits<float>::infinity();
+      break;
+    default:
+      awkward[index] = white[index];
+    }
+  }
+
+  std::vector<float> decoded;
+  for (int frameSize : {LayerCodec::maxFrameSize, 1000, 1}) {
+    EXPECT_GT(roundTrip(silence, decoded, frameSize), 0u);
+    EXPECT_TRUE(sameBits(silence, decoded));
+    EXPECT_GT(roundTrip(quantised, decoded, frameSize), 0u);
+    EXPECT_TRUE(sameBits(quantised, decoded));
+    EXPECT_GT(roundTrip(white, decoded, frameSize), 0u);
+    EXPECT_TRUE(sameBits(white, decoded));
+    EXPECT_GT(roundTrip(awkward, decoded, frameSize), 0u);
+    EXPECT_TRUE(sameBits(awkward, decoded));
+    EXPECT_GT(roundTrip(wide, decoded, frameSize), 0u);
+    EXPECT_TRUE(sameBits(wide, decoded));
+  }
+
+  // Silence costs a byte a frame, and 24-bit audio well under its floats
+  const size_t rawBytes = sizeof(float) * numSamples;
+  EXPECT_EQ(roundTrip(silence, decoded, LayerCodec::maxFrameSize), 4u);
+  EXPECT_LT(roundTrip(quantised, decoded, LayerCodec::maxFrameSize),
+            rawBytes / 2);
+}
+
+TEST(LayerCodecTest, RefusesTruncatedFrames) {
+  std::vector<float> samples(LayerCodec::maxFrameSize);
+  for (size_t i = 0; i < samples.size(); ++i)
+    samples[i] = static_cast<float>(i % 100) / 128.0f;
+
+  LayerCodec codec;
+  juce::MemoryOutputStream encoded;
+  codec.encodeFrame(samples.data(), LayerCodec::maxFrameSize, encoded);
+  ASSERT_EQ(static_cast<int>(static_cast<const char *>(encoded.getData())[0]),
+            static_cast<int>(LayerCodec::FrameType::predicted));
+
+  juce::MemoryInputStream truncated(encoded.getData(),
+                                    encoded.getDataSize() - 1, false);
+  EXPECT_FALSE(
+      codec.decodeFrame(truncated, LayerCodec::maxFrameSize, nullptr));
+}
@@ -0,0 +1,109 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test_helpers.h"
+#include <gtest/gtest.h>
+
+using namespace TestHelpers;
+
+namespace {
+// A stereo WAV of `length` samples of the ramp
+juce::File writeRamp(const juce::String &name, double sampleRate,
+                     int length) {
+  auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                  .getChildFile(name);
+  file.deleteFile();
+
+  juce::AudioBuffer<float> audio(2, length);
+  for (int i = 0; i < length; ++i) {
+    audio.setSample(0, i, ramp(0, i));
+    audio.setSample(1, i, ramp(1, i));
+  }
+
+  juce::WavAudioFormat format;
+  std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(
+      file.createOutputStream().release(), sampleRate, 2, 32, {}, 0));
+  EXPECT_NE(writer, nullptr);
+  if (writer != nullptr)
+    writer->writeFromAudioSampleBuffer(audio, 0, length);
+  return file;
+}
+
+// Run blocks until the import has been added
+void waitForImport(TrackManager &manager) {
+  juce::AudioBuffer<float> buffer(2, 100);
+  for (int i = 0; i < 2000 && manager.isImporting(); ++i) {
+    buffer.clear();
+    manager.processBlock(buffer, false);
+    juce::Thread::sleep(1);
+  }
+  buffer.clear();
+  manager.processBlock(buffer, false);
+}
+} // namespace
+
+TEST(LayerImporterTest, ImportIntoAnEmptySessionSetsTheLoopLength) {
+  const auto file = writeRamp("LooperImportEmpty.wav", 1000.0, 700);
+  TrackManager manager;
+  manager.prepare(1000.0, 100);
+  auto *track = manager.addTrack();
+
+  ASSERT_TRUE(manager.importLayer(track->getId(), file));
+  EXPECT_FALSE(manager.importLayer(track->getId() + 1, file));
+  waitForImport(manager);
+
+  EXPECT_EQ(manager.getBaseLoopLength(), 700);
+  ASSERT_EQ(track->getLooper().getNumLoops(), 1u);
+  for (int position : {0, 123, 699}) {
+    EXPECT_FLOAT_EQ(layerSample(*track, 0, position), ramp(0, position));
+    EXPECT_FLOAT_EQ(layerSample(*track, 1, position), ramp(1, position));
+  }
+  file.deleteFile();
+}
+
+TEST(LayerImporterTest, ImportsAreFittedToTheLoopAndItsRate) {
+  TrackManager manager;
+  manager.prepare(1000.0, 100);
+  auto *track = manager.addTrack();
+  manager.setBaseLoopLength(300);
+
+  // Longer than the loop: cut to it, with the seam crossfaded
+  const auto longFile = writeRamp("LooperImportLong.wav", 1000.0, 1000);
+  ASSERT_TRUE(manager.importLayer(track->getId(), longFile));
+  waitForImport(manager);
+  ASSERT_EQ(track->getLooper().getNumLoops(), 1u);
+  EXPECT_FLOAT_EQ(layerSample(*track, 0, 150), ramp(0, 150));
+  EXPECT_LT(layerSample(*track, 0, 299), ramp(0, 299));
+
+  // At twice the rate and half the loop: resampled, then padded
+  const auto fastFile = writeRamp("LooperImportFast.wav", 2000.0, 300);
+  ASSERT_TRUE(manager.importLayer(track->getId(), fastFile));
+  waitForImport(manager);
+  ASSERT_EQ(track->getLooper().getNumLoops(), 2u);
+  EXPECT_EQ(manager.getBaseLoopLength(), 300);
+
+  // Missing files fail without adding anything
+  const juce::File missing("/nonexistent.wav");
+  ASSERT_TRUE(manager.importLayer(track->getId(), missing));
+  waitForImport(manager);
+  EXPECT_EQ(track->getLooper().getNumLoops(), 2u);
+  EXPECT_EQ(track->getLooper().getImporter().getNumFailures(), 1);
+
+  longFile.deleteFile();
+  fastFile.deleteFile();
+}
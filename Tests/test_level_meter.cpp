@@ -0,0 +1,90 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/LevelMeter.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(LevelMeterTest, AnalyseMatchesAPlainLoopAtAnyAlignment) {
+  std::vector<float> samples(300);
+  for (size_t i = 0; i < samples.size(); ++i)
+    samples[i] = std::sin(static_cast<float>(i) * 0.37f) * 0.5f;
+  samples[101] = -0.9f;
+
+  // Offsets and lengths that leave a ragged head and tail around the
+  // vectorised middle
+  for (int start = 0; start < 5; ++start) {
+    for (int length : {0, 1, 3, 7, 64, 253}) {
+      float peak = 0.0f;
+      double sumOfSquares = 0.0;
+      for (int i = start; i < start + length; ++i) {
+        peak = std::max(peak, std::abs(samples[static_cast<size_t>(i)]));
+        sumOfSquares += samples[static_cast<size_t>(i)] *
+                        samples[static_cast<size_t>(i)];
+      }
+
+      const auto levels = LevelMeter::analyse(samples.data() + start, length);
+      EXPECT_FLOAT_EQ(levels.peak, peak);
+      EXPECT_NEAR(levels.sumOfSquares, sumOfSquares, 1.0e-4);
+    }
+  }
+}
+
+TEST(LevelMeterTest, PeakHoldsThenFallsAndRmsSettles) {
+  const double sampleRate = 48000.0;
+  const int blockSize = 480; // 10 ms
+  LevelMeter meter;
+  meter.prepare(sampleRate);
+
+  std::vector<float> loud(blockSize, 0.5f);
+  std::vector<float> quiet(blockSize, 0.0f);
+
+  // Two seconds of a constant level: RMS settles on it
+  for (int block = 0; block < 200; ++block) {
+    meter.measure(0, loud.data(), blockSize);
+    meter.update(blockSize);
+  }
+  EXPECT_NEAR(meter.getReading().rms[0], 0.5f, 1.0e-3f);
+  EXPECT_FLOAT_EQ(meter.getReading().peak[0], 0.5f);
+
+  // Gain applies to what is measured
+  meter.measure(1, loud.data(), blockSize, 0.5f);
+  EXPECT_FLOAT_EQ(meter.update(blockSize).peakHold[1], 0.25f);
+
+  // After a second of silence on the left, the block above included, the
+  // peak has fallen 20 dB but the hold hasn't
+  for (int block = 0; block < 99; ++block) {
+    meter.measure(0, quiet.data(), blockSize);
+    meter.update(blockSize);
+  }
+  EXPECT_NEAR(meter.getReading().peak[0], 0.05f, 1.0e-3f);
+  EXPECT_FLOAT_EQ(meter.getReading().peakHold[0], 0.5f);
+
+  // Once the hold time is up it falls at the same rate, from where it was
+  for (int block = 0; block < 60; ++block)
+    meter.update(blockSize);
+  EXPECT_LT(meter.getReading().peakHold[0], 0.5f);
+  EXPECT_GT(meter.getReading().peakHold[0], meter.getReading().peak[0]);
+
+  // Silence eventually reads as exactly nothing
+  for (int block = 0; block < 500; ++block)
+    meter.update(blockSize);
+  EXPECT_TRUE(meter.getReading().isSilent());
+  EXPECT_EQ(meter.getReading().rms[0], 0.0f);
+}
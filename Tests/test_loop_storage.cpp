@@ -0,0 +1,115 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/LoopStorage.h"
+#include <gtest/gtest.h>
+
+TEST(LoopStorageTest, UnwrittenRegionsReadAsSilence) {
+  auto pool = std::make_shared<LoopPagePool>();
+  LoopBuffer buffer(pool, 2, 44100 * 60);
+  EXPECT_EQ(buffer.getNumAllocatedPages(), 0);
+  EXPECT_EQ(buffer.getSample(1, 12345), 0.0f);
+}
+
+TEST(LoopStorageTest, WritesSpanningPagesRoundTrip) {
+  auto pool = std::make_shared<LoopPagePool>();
+  LoopBuffer buffer(pool, 1, 44100);
+
+  std::vector<float> source(1000);
+  for (size_t i = 0; i < source.size(); ++i)
+    source[i] = static_cast<float>(i);
+
+  const int start = LoopPagePool::pageSize - 10;
+  buffer.copyFrom(0, start, source.data(), static_cast<int>(source.size()));
+  EXPECT_EQ(buffer.getNumAllocatedPages(), 2);
+
+  std::vector<float> dest(source.size());
+  buffer.copyTo(0, start, dest.data(), static_cast<int>(dest.size()));
+  EXPECT_EQ(dest, source);
+}
+
+TEST(LoopStorageTest, ReleasedPagesAreRecycledZeroed) {
+  auto pool = std::make_shared<LoopPagePool>();
+  {
+    LoopBuffer buffer(pool, 2, 44100);
+    buffer.setSample(0, 0, 1.0f);
+    buffer.setSample(1, 0, 1.0f);
+  }
+  const int totalPages = pool->getNumPages();
+  EXPECT_EQ(pool->getNumFreePages(), totalPages);
+
+  LoopBuffer reused(pool, 1, 44100);
+  auto *page = reused.getWritePointer(0, 0);
+  ASSERT_NE(page, nullptr);
+  EXPECT_EQ(page[0], 0.0f);
+  EXPECT_EQ(pool->getNumPages(), totalPages);
+}
+
+TEST(LoopStorageTest, PagesAreCacheLineAligned) {
+  LoopPagePool pool;
+  std::vector<float *> pages;
+  for (int i = 0; i < 100; ++i)
+    pages.push_back(pool.acquire());
+
+  for (auto *page : pages) {
+    ASSERT_NE(page, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(page) % 64, 0u);
+    pool.release(page);
+  }
+}
+
+TEST(LoopStorageTest, PeakPyramidFollowsWritesAtEveryLevel) {
+  auto pool = std::make_shared<LoopPagePool>();
+  LoopLayer layer(pool, 1, 3 * LoopPagePool::pageSize);
+
+  // A single-sample spike must show at every level, not just where a bin
+  // happens to sample it
+  const int spikeAt = LoopPagePool::pageSize + 1001;
+  const float spike[] = {-0.75f, 0.5f};
+  layer.buffer.copyFrom(0, spikeAt, spike, 2);
+  layer.peaks.refresh(0, spikeAt, 2);
+
+  for (int level = 0; level < PeakPyramid::numLevels; ++level) {
+    const auto range = layer.peaks.getRange(0, level, spikeAt - 10, spikeAt);
+    EXPECT_FLOAT_EQ(range.min, -0.75f);
+    EXPECT_FLOAT_EQ(range.max, 0.5f);
+
+    const auto silent = layer.peaks.getRange(0, level, 0, 64);
+    EXPECT_EQ(silent.min, 0.0f);
+    EXPECT_EQ(silent.max, 0.0f);
+  }
+
+  // Rewriting the spike away refreshes the coarser levels too
+  const float quiet[] = {0.125f, 0.0f};
+  layer.buffer.copyFrom(0, spikeAt, quiet, 2);
+  layer.peaks.refresh(0, spikeAt, 2);
+  const auto top = layer.peaks.getRange(0, PeakPyramid::numLevels - 1,
+                                        0, layer.buffer.getCapacity());
+  EXPECT_FLOAT_EQ(top.min, 0.0f);
+  EXPECT_FLOAT_EQ(top.max, 0.125f);
+
+  // The bins are kept with the one page written, and come back zeroed
+  EXPECT_EQ(layer.buffer.getNumAllocatedPages(), 1);
+  layer.buffer.clear();
+  LoopLayer reused(pool, 1, LoopPagePool::pageSize);
+  reused.buffer.setSample(0, 0, 0.0f);
+  const auto recycled =
+      reused.peaks.getRange(0, PeakPyramid::numLevels - 1, 0,
+                            LoopPagePool::pageSize);
+  EXPECT_EQ(recycled.max, 0.0f);
+}
@@ -37,3 +37,224 @@ TEST(LooperTest, CanStopRecording) {
   looper.stopRecording(0);
   EXPECT_FALSE(looper.isRecording());
 }
+
+TEST(LooperTest, MemoryFollowsRecordedAudio) {
+  Looper looper;
+  looper.prepare(44100.0);
+  looper.startRecording(0, 0);
+
+  juce::AudioBuffer<float> input(2, 512);
+  input.clear();
+  looper.processRecording(input, 44100 * 60, 0);
+
+  // One page per channel, not a 60-second buffer
+  EXPECT_EQ(looper.getAllocatedBytes(),
+            2 * sizeof(float) * LoopPagePool::pageSize);
+}
+
+TEST(LooperTest, RolloverTakesLayerFromPool) {
+  Looper looper;
+  looper.prepare(44100.0);
+  EXPECT_EQ(looper.getLayerPool().getNumReady(), LayerPool::depth);
+
+  const int loopLength = 1024;
+  looper.startRecording(0, loopLength);
+
+  juce::AudioBuffer<float> input(2, 512);
+  input.clear();
+  looper.processRecording(input, loopLength, 0);
+  looper.processRecording(input, loopLength, 512);
+
+  // Both the first layer and the rollover layer come from the pool
+  EXPECT_EQ(looper.getNumLoops(), 2u);
+  EXPECT_EQ(looper.getLayerPool().getNumServed(), 2);
+  EXPECT_EQ(looper.getLayerPool().getNumMisses(), 0);
+}
+
+TEST(LooperTest, PlaybackMixesLayersAcrossLoopWrap) {
+  Looper looper;
+  looper.prepare(44100.0);
+
+  const int loopLength = 300;
+  looper.startRecording(0, loopLength);
+  juce::AudioBuffer<float> input(2, loopLength);
+  for (int channel = 0; channel < 2; ++channel)
+    for (int i = 0; i < loopLength; ++i)
+      input.setSample(channel, i, 0.25f);
+  looper.processRecording(input, loopLength, 0);
+  looper.stopRecording(loopLength);
+  looper.startPlayback();
+
+  // Block starts near the end of the loop and wraps back to the start
+  juce::AudioBuffer<float> output(2, 128);
+  output.clear();
+  looper.processPlayback(output, 0.5f, 250, loopLength);
+
+  // Sample 100 in the block reads loop position 50; the input is constant,
+  // so the seam crossfade leaves it unchanged
+  EXPECT_NEAR(output.getSample(0, 100), std::tanh(0.25f) * 0.5f, 1.0e-6f);
+  EXPECT_NEAR(output.getSample(1, 100), std::tanh(0.25f) * 0.5f, 1.0e-6f);
+}
+
+TEST(LooperTest, RenderedMixMatchesPlayback) {
+  Looper looper;
+  looper.prepare(44100.0);
+
+  const int loopLength = 300;
+  looper.startRecording(0, loopLength);
+  juce::AudioBuffer<float> input(2, loopLength);
+  for (int channel = 0; channel < 2; ++channel)
+    for (int i = 0; i < loopLength; ++i)
+      input.setSample(channel, i, 0.001f * static_cast<float>(i));
+  looper.processRecording(input, loopLength, 0);
+  looper.stopRecording(loopLength);
+  looper.startPlayback();
+
+  juce::AudioBuffer<float> played(2, 128);
+  played.clear();
+  looper.processPlayback(played, 1.0f, 250, loopLength);
+
+  // Same block, seams and wrap included, without touching playback
+  std::vector<juce::uint32> serials;
+  looper.getFinishedLayers(serials);
+  juce::AudioBuffer<float> rendered(2, 128);
+  ASSERT_TRUE(looper.renderMix(rendered, 250, loopLength, serials));
+  for (int channel = 0; channel < 2; ++channel)
+    for (int i = 0; i < 128; ++i)
+      EXPECT_FLOAT_EQ(rendered.getSample(channel, i),
+                      played.getSample(channel, i));
+
+  // An overdub finished since the serials were taken stays out
+  looper.startRecording(0, loopLength);
+  looper.processRecording(input, loopLength, 0);
+  looper.stopRecording(loopLength);
+  juce::AudioBuffer<float> again(2, 128);
+  ASSERT_TRUE(looper.renderMix(again, 250, loopLength, serials));
+  for (int i = 0; i < 128; ++i)
+    EXPECT_FLOAT_EQ(again.getSample(0, i), rendered.getSample(0, i));
+
+  // Once a layer it renders is gone, the render fails
+  looper.clearAll();
+  EXPECT_FALSE(looper.renderMix(again, 250, loopLength, serials));
+}
+
+TEST(LooperTest, LayerSumFollowsOverdubsAndUndo) {
+  Looper looper;
+  looper.prepare(1000.0);
+
+  const int loopLength = 300;
+  juce::AudioBuffer<float> input;
+  auto fill = [&input](int numSamples, float value) {
+    input.setSize(2, numSamples);
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < numSamples; ++i)
+        input.setSample(channel, i, value);
+  };
+
+  // One full pass, then an overdub that stops just short of the loop end
+  looper.startRecording(0, loopLength);
+  fill(loopLength, 0.25f);
+  looper.processRecording(input, loopLength, 0);
+  fill(loopLength - 1, 0.125f);
+  looper.processRecording(input, loopLength, 0);
+  looper.stopRecording(loopLength);
+  looper.startPlayback();
+  ASSERT_TRUE(looper.hasLayerSum());
+
+  auto playAt = [&looper](int position) {
+    juce::AudioBuffer<float> output(2, 1);
+    output.clear();
+    looper.processPlayback(output, 1.0f, position, loopLength);
+    return output.getSample(0, 0);
+  };
+  EXPECT_NEAR(playAt(100), std::tanh(0.375f), 1.0e-6f);
+
+  // Undo drops to mixing the layers until the sum has been rebuilt
+  looper.removeLastLoop();
+  EXPECT_NEAR(playAt(100), std::tanh(0.25f), 1.0e-6f);
+
+  for (int i = 0; i < 200 && !looper.hasLayerSum(); ++i) {
+    looper.handlePendingRequests();
+    juce::Thread::sleep(10);
+  }
+  ASSERT_TRUE(looper.hasLayerSum());
+  EXPECT_NEAR(playAt(100), std::tanh(0.25f), 1.0e-6f);
+}
+
+TEST(LooperTest, WaveformPeaksCatchSpikesBetweenBins) {
+  Looper looper;
+  looper.prepare(1000.0);
+
+  const int loopLength = 8192;
+  looper.startRecording(0, loopLength);
+  juce::AudioBuffer<float> input(2, loopLength);
+  input.clear();
+  input.setSample(0, 4001, 0.5f);
+  input.setSample(0, 6003, -0.25f);
+  looper.processRecording(input, loopLength, 0);
+  looper.stopRecording(loopLength);
+
+  // 64 bins of 128 samples read pyramid level 0; 8 bins read level 2
+  for (int numBins : {64, 8, 4096}) {
+    auto peaks = looper.getWaveformPeaks(numBins, 0, loopLength);
+    ASSERT_EQ(peaks.size(), static_cast<size_t>(numBins));
+    EXPECT_FLOAT_EQ(peaks[static_cast<size_t>(4001 * numBins / loopLength)].max,
+                    0.5f);
+    EXPECT_FLOAT_EQ(peaks[static_cast<size_t>(6003 * numBins / loopLength)].min,
+                    -0.25f);
+  }
+}
+
+TEST(LooperTest, UndoLeavesTheExactSumOfTheRemainingLayers) {
+  Looper looper;
+  looper.prepare(1000.0);
+
+  // Layers of unrelated values, so subtracting one leaves rounding behind.
+  // The last pass stops short of the loop end, so no layer follows it.
+  const int loopLength = 300;
+  juce::Random random(7);
+  juce::AudioBuffer<float> input;
+  looper.startRecording(0, loopLength);
+  for (int layer = 0; layer < 4; ++layer) {
+    input.setSize(2, layer < 3 ? loopLength : loopLength - 1);
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < input.getNumSamples(); ++i)
+        input.setSample(channel, i, random.nextFloat() * 0.3f - 0.15f);
+    looper.processRecording(input, loopLength, 0);
+  }
+  looper.stopRecording(loopLength);
+  looper.startPlayback();
+
+  std::vector<juce::uint32> serials;
+  looper.getFinishedLayers(serials);
+  ASSERT_EQ(serials.size(), 4u);
+  serials.pop_back();
+  juce::AudioBuffer<float> expected(2, 128);
+  ASSERT_TRUE(looper.renderMix(expected, 100, loopLength, serials));
+
+  // Playback reads the sum, which must end up as if built without the layer
+  auto matches = [&] {
+    juce::AudioBuffer<float> output(2, 128);
+    output.clear();
+    looper.processPlayback(output, 1.0f, 100, loopLength);
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < 128; ++i)
+        if (output.getSample(channel, i) != expected.getSample(channel, i))
+          return false;
+    return true;
+  };
+
+  looper.removeLastLoop();
+  bool exact = false;
+  for (int i = 0; i < 200 && !exact; ++i) {
+    looper.handlePendingRequests();
+    exact = looper.hasLayerSum() && matches();
+    juce::Thread::sleep(10);
+  }
+  EXPECT_TRUE(exact);
+
+  // and stay that way
+  juce::Thread::sleep(100);
+  looper.handlePendingRequests();
+  EXPECT_TRUE(matches());
+}
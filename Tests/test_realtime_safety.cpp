@@ -0,0 +1,202 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/Track.h"
+#include "../Source/Models/TrackManager.h"
+#include "realtime_checker.h"
+#include <atomic>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int blockSize = 256;
+
+enum class Action {
+  record,
+  stop,
+  undo,
+  clear,
+  clearAll,
+  undoLast,
+  solo,
+  unsolo,
+  saveState,
+  saveCompressed,
+  import
+};
+
+struct Step {
+  int block;
+  Action action;
+  int track;
+};
+
+// Half a second of sine at another rate, for imports to resample
+juce::File importFile() {
+  static const auto file = [] {
+    auto wav = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                   .getChildFile("LooperRealtimeImport.wav");
+    wav.deleteFile();
+    juce::AudioBuffer<float> audio(2, 24000);
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < audio.getNumSamples(); ++i)
+        audio.setSample(channel, i, 0.25f * std::sin(0.02f * float(i)));
+    juce::WavAudioFormat format;
+    std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(
+        wav.createOutputStream().release(), 48000.0, 2, 24, {}, 0));
+    if (writer != nullptr)
+      writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+    return wav;
+  }();
+  return file;
+}
+
+// Runs processBlock on its own thread inside a RealtimeChecker scope while
+// the steps are applied from this thread as their blocks come round
+void runScenario(TrackManager &manager, const std::vector<Step> &steps,
+                 int numBlocks) {
+  manager.prepare(44100.0, blockSize);
+  std::vector<int> ids;
+  for (int i = 0; i < 3; ++i)
+    ids.push_back(manager.addTrack()->getId());
+
+  std::atomic<int> currentBlock{0};
+  std::thread audio([&] {
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    for (int block = 0; block < numBlocks; ++block) {
+      for (int channel = 0; channel < 2; ++channel)
+        for (int i = 0; i < blockSize; ++i)
+          buffer.setSample(channel, i,
+                           0.25f * std::sin(0.01f * float(i + block)));
+      {
+        RealtimeChecker::Scope scope;
+        manager.processBlock(buffer, true);
+      }
+      currentBlock.store(block + 1);
+
+      // Roughly real time, so the background refills keep up
+      std::this_thread::sleep_for(std::chrono::microseconds(1500));
+    }
+  });
+
+  for (const auto &step : steps) {
+    // Poll telemetry like the editor does while waiting
+    while (currentBlock.load() < step.block) {
+      EXPECT_LE(manager.getTelemetry().numTracks, 3);
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    const int id = ids[static_cast<size_t>(step.track)];
+    switch (step.action) {
+    case Action::record:
+      manager.startRecordingTrack(id);
+      break;
+    case Action::stop:
+      manager.stopRecordingTrack(id);
+      break;
+    case Action::undo:
+      manager.undoTrack(id);
+      break;
+    case Action::clear:
+      manager.clearTrack(id);
+      break;
+    case Action::clearAll:
+      manager.requestClearAll();
+      break;
+    case Action::undoLast:
+      manager.requestUndoLast();
+      break;
+    case Action::solo:
+    case Action::unsolo:
+      if (auto *track = manager.findTrack(id))
+        track->setSoloed(step.action == Action::solo);
+      break;
+    case Action::saveState:
+    case Action::saveCompressed: {
+      juce::MemoryOutputStream stream;
+      SessionWriter writer(stream);
+      manager.writeState(writer, 44100.0,
+                         step.action == Action::saveCompressed);
+      writer.finish();
+      break;
+    }
+    case Action::import:
+      manager.importLayer(id, importFile());
+      break;
+    }
+  }
+
+  audio.join();
+}
+} // namespace
+
+class RealtimeSafetyTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    if (!RealtimeChecker::isEnabled())
+      GTEST_SKIP() << "Built without LOOPER_REALTIME_CHECKS";
+    RealtimeChecker::reset();
+  }
+};
+
+TEST_F(RealtimeSafetyTest, RecordOverdubAndRollover) {
+  // The overdub on track 0 runs past the loop end and rolls over twice
+  TrackManager manager;
+  runScenario(manager,
+              {{2, Action::record, 0},
+               {30, Action::stop, 0},
+               {32, Action::record, 1},
+               {40, Action::stop, 1},
+               {42, Action::record, 0},
+               {110, Action::stop, 0},
+               {112, Action::saveState, 0}},
+              130);
+
+  EXPECT_GE(manager.getTracks()[0]->getLooper().getNumLoops(), 3u);
+  EXPECT_EQ(RealtimeChecker::getNumViolations(), 0)
+      << RealtimeChecker::describeViolations();
+}
+
+TEST_F(RealtimeSafetyTest, UndoClearAndSoloWhileRecording) {
+  TrackManager manager;
+  runScenario(manager,
+              {{2, Action::record, 0},
+               {20, Action::stop, 0},
+               {22, Action::record, 1},
+               {30, Action::solo, 1},
+               {34, Action::undo, 1},
+               {36, Action::record, 2},
+               {38, Action::import, 0},
+               {40, Action::saveState, 0},
+               {44, Action::unsolo, 1},
+               {46, Action::clear, 2},
+               {48, Action::record, 0},
+               {60, Action::undoLast, 0},
+               {64, Action::record, 1},
+               {70, Action::saveCompressed, 0},
+               {72, Action::clearAll, 0},
+               {76, Action::record, 2},
+               {90, Action::stop, 2}},
+              100);
+
+  EXPECT_TRUE(manager.getTracks()[2]->getLooper().hasLoops());
+  EXPECT_EQ(RealtimeChecker::getNumViolations(), 0)
+      << RealtimeChecker::describeViolations();
+}
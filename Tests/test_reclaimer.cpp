@@ -0,0 +1,51 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/Reclaimer.h"
+#include <gtest/gtest.h>
+
+namespace {
+struct Tracked : public Retirable {
+  explicit Tracked(std::atomic<int> &count) : destroyed(count) {}
+  ~Tracked() override { destroyed.fetch_add(1); }
+  std::atomic<int> &destroyed;
+};
+} // namespace
+
+TEST(ReclaimerTest, ReclaimNowFreesEverythingPending) {
+  std::atomic<int> destroyed{0};
+  Reclaimer reclaimer;
+
+  reclaimer.retire(std::make_unique<Tracked>(destroyed));
+  reclaimer.retire(std::make_unique<Tracked>(destroyed));
+
+  reclaimer.reclaimNow();
+  EXPECT_EQ(destroyed.load(), 2);
+  EXPECT_EQ(reclaimer.getNumPending(), 0);
+}
+
+TEST(ReclaimerTest, HousekeepingThreadFreesRetiredObjects) {
+  std::atomic<int> destroyed{0};
+  Reclaimer reclaimer;
+  reclaimer.retire(std::make_unique<Tracked>(destroyed));
+
+  for (int i = 0; i < 100 && destroyed.load() == 0; ++i)
+    juce::Thread::sleep(10);
+
+  EXPECT_EQ(destroyed.load(), 1);
+}
@@ -0,0 +1,52 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/RenderPool.h"
+#include <gtest/gtest.h>
+
+namespace {
+struct CountingJob : public RenderPool::Job {
+  std::array<std::atomic<int>, 100> runs{};
+  void runTask(int index) override {
+    runs[static_cast<size_t>(index)].fetch_add(1);
+  }
+};
+} // namespace
+
+TEST(RenderPoolTest, RunsEveryTaskOncePerRound) {
+  RenderPool pool(3);
+  CountingJob job;
+
+  for (int round = 1; round <= 50; ++round) {
+    pool.run(job, static_cast<int>(job.runs.size()));
+    for (auto &runs : job.runs)
+      ASSERT_EQ(runs.load(), round);
+  }
+}
+
+TEST(RenderPoolTest, WakesParkedWorkers) {
+  RenderPool pool(2);
+  CountingJob job;
+  pool.run(job, static_cast<int>(job.runs.size()));
+
+  // Long enough for the workers to stop spinning and park
+  juce::Thread::sleep(200);
+  pool.run(job, static_cast<int>(job.runs.size()));
+  for (auto &runs : job.runs)
+    ASSERT_EQ(runs.load(), 2);
+}
@@ -0,0 +1,77 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/Resampler.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace {
+// A loop of whole sine cycles, so it is periodic
+std::vector<float> sineLoop(int length, int cycles) {
+  std::vector<float> samples(static_cast<size_t>(length));
+  for (int i = 0; i < length; ++i)
+    samples[static_cast<size_t>(i)] = static_cast<float>(
+        std::sin(juce::MathConstants<double>::twoPi * cycles * i / length));
+  return samples;
+}
+
+float maxError(const std::vector<float> &actual,
+               const std::vector<float> &expected) {
+  float error = 0.0f;
+  for (size_t i = 0; i < actual.size(); ++i)
+    error = juce::jmax(error, std::abs(actual[i] - expected[i]));
+  return error;
+}
+} // namespace
+
+TEST(ResamplerTest, ConvertsLengthsBetweenRates) {
+  EXPECT_EQ(Resampler::convertLength(44100, 44100.0, 48000.0), 48000);
+  EXPECT_EQ(Resampler::convertLength(96000, 96000.0, 48000.0), 48000);
+  EXPECT_EQ(Resampler::convertLength(0, 44100.0, 48000.0), 0);
+}
+
+TEST(ResamplerTest, UpsampledSineMatchesAnalyticSine) {
+  const int inputLength = 4410;
+  const int outputLength =
+      Resampler::convertLength(inputLength, 44100.0, 48000.0);
+  const auto input = sineLoop(inputLength, 100); // 1 kHz
+  std::vector<float> output(static_cast<size_t>(outputLength));
+
+  Resampler resampler(44100.0, 48000.0);
+  resampler.processLoop(input.data(), inputLength, output.data(), outputLength);
+
+  EXPECT_LT(maxError(output, sineLoop(outputLength, 100)), 1.0e-3f);
+}
+
+TEST(ResamplerTest, DownsamplingRemovesContentAboveTheNewNyquist) {
+  const int inputLength = 9600;
+  const int outputLength =
+      Resampler::convertLength(inputLength, 96000.0, 48000.0);
+
+  // 1 kHz plus 30 kHz, which can't be represented at 48 kHz
+  auto input = sineLoop(inputLength, 100);
+  const auto high = sineLoop(inputLength, 3000);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] += high[i];
+  std::vector<float> output(static_cast<size_t>(outputLength));
+
+  Resampler resampler(96000.0, 48000.0);
+  resampler.processLoop(input.data(), inputLength, output.data(), outputLength);
+
+  EXPECT_LT(maxError(output, sineLoop(outputLength, 100)), 1.0e-3f);
+}
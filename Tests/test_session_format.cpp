@@ -0,0 +1,302 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test_helpers.h"
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+
+using namespace TestHelpers;
+
+namespace {
+constexpr double sampleRate = 1000.0;
+constexpr int loopLength = 300;
+
+// Two tracks: the first with one layer of a ramp, the second empty but
+// soloed at a low volume
+void recordSession(TrackManager &manager) {
+  manager.prepare(sampleRate, 100);
+  auto *first = manager.addTrack();
+  auto *second = manager.addTrack();
+  second->setVolume(0.25f);
+  second->setSoloed(true);
+
+  recordRamp(manager, *first, loopLength / blockSize);
+}
+
+juce::MemoryBlock save(const TrackManager &manager,
+                       bool compressAudio = false) {
+  juce::MemoryBlock block;
+  juce::MemoryOutputStream stream(block, false);
+  SessionWriter writer(stream);
+  manager.writeState(writer, sampleRate, compressAudio);
+  writer.finish();
+  EXPECT_TRUE(writer.wasSuccessful());
+  stream.flush();
+  return block;
+}
+
+bool load(TrackManager &manager, const juce::MemoryBlock &block) {
+  SessionReader reader(block.getData(), block.getSize());
+  return reader.isValid() && manager.readState(reader, sampleRate);
+}
+
+// Offset of the first chunk with the given id
+size_t findChunk(const juce::MemoryBlock &block, juce::uint32 id) {
+  SessionReader reader(block.getData(), block.getSize());
+  SessionReader::Chunk chunk;
+  if (!reader.find(id, chunk))
+    return 0;
+  return static_cast<size_t>(chunk.data -
+                             static_cast<const char *>(block.getData()));
+}
+} // namespace
+
+TEST(SessionFormatTest, RoundTripRestoresTracksControlsAndAudio) {
+  TrackManager original;
+  recordSession(original);
+  const auto block = save(original);
+  ASSERT_TRUE(SessionFormat::hasMagic(block.getData(), block.getSize()));
+
+  // Raw samples plus a little framing: no base64 growth
+  const size_t audioBytes = 2 * loopLength * sizeof(float);
+  EXPECT_LT(block.getSize(), audioBytes + 256);
+
+  TrackManager restored;
+  restored.prepare(sampleRate, 100);
+  ASSERT_TRUE(load(restored, block));
+
+  const auto tracks = restored.getTracks();
+  ASSERT_EQ(tracks.size(), 2u);
+  EXPECT_EQ(restored.getBaseLoopLength(), loopLength);
+  EXPECT_EQ(tracks[1]->getId(), original.getTracks()[1]->getId());
+  EXPECT_FLOAT_EQ(tracks[1]->getVolume(), 0.25f);
+  EXPECT_TRUE(tracks[1]->isSoloed());
+  EXPECT_FALSE(tracks[1]->getLooper().hasLoops());
+
+  ASSERT_EQ(tracks[0]->getLooper().getNumLoops(), 1u);
+  for (int position : {0, 1, 150, loopLength - 1}) {
+    EXPECT_FLOAT_EQ(layerSample(*tracks[0], 0, position),
+                    layerSample(*original.getTracks()[0], 0, position));
+    EXPECT_FLOAT_EQ(layerSample(*tracks[0], 1, position),
+                    layerSample(*original.getTracks()[0], 1, position));
+  }
+}
+
+TEST(SessionFormatTest, CompressedLayersRestoreTheSameAudio) {
+  TrackManager original;
+  recordSession(original);
+  const auto raw = save(original);
+  const auto compressed = save(original, true);
+  EXPECT_EQ(findChunk(compressed, SessionFormat::layerId), 0u);
+  ASSERT_GT(findChunk(compressed, SessionFormat::compressedLayerId), 0u);
+  EXPECT_LT(compressed.getSize(), raw.getSize());
+
+  // Sample for sample what the raw floats restore
+  TrackManager fromRaw, fromCompressed;
+  fromRaw.prepare(sampleRate, 100);
+  fromCompressed.prepare(sampleRate, 100);
+  ASSERT_TRUE(load(fromRaw, raw));
+  ASSERT_TRUE(load(fromCompressed, compressed));
+
+  const auto expected = fromRaw.getTracks();
+  const auto tracks = fromCompressed.getTracks();
+  ASSERT_EQ(tracks.size(), 2u);
+  ASSERT_EQ(tracks[0]->getLooper().getNumLoops(), 1u);
+  EXPECT_FALSE(tracks[1]->getLooper().hasLoops());
+  for (int channel = 0; channel < 2; ++channel) {
+    for (int position = 0; position < loopLength; ++position)
+      EXPECT_EQ(layerSample(*tracks[0], channel, position),
+                layerSample(*expected[0], channel, position));
+  }
+}
+
+TEST(SessionFormatTest, RestoresReportProgressAndSkipSilence) {
+  TrackManager original;
+  recordSession(original);
+
+  // A silent overdub on the second track, stopped before it comes round
+  auto *second = original.getTracks()[1];
+  juce::AudioBuffer<float> buffer(2, 100);
+  original.startRecordingTrack(second->getId());
+  buffer.clear();
+  original.processBlock(buffer, false);
+  original.stopRecordingTrack(second->getId());
+  buffer.clear();
+  original.processBlock(buffer, false);
+  ASSERT_EQ(second->getLooper().getNumLoops(), 1u);
+
+  for (bool compressAudio : {false, true}) {
+    const auto block = save(original, compressAudio);
+    TrackManager restored;
+    restored.prepare(sampleRate, 100);
+    std::vector<double> reports;
+    SessionReader reader(block.getData(), block.getSize());
+    ASSERT_TRUE(restored.readState(reader, sampleRate, [&](double done) {
+      reports.push_back(done);
+    }));
+
+    ASSERT_FALSE(reports.empty());
+    EXPECT_TRUE(std::is_sorted(reports.begin(), reports.end()));
+    EXPECT_EQ(reports.back(), 1.0);
+
+    // The silent layer is restored without taking any pages
+    const auto tracks = restored.getTracks();
+    ASSERT_EQ(tracks.size(), 2u);
+    EXPECT_EQ(tracks[1]->getLooper().getNumLoops(), 1u);
+    EXPECT_EQ(tracks[1]->getLooper().getAllocatedBytes(), 0u);
+    EXPECT_GT(tracks[0]->getLooper().getAllocatedBytes(), 0u);
+    EXPECT_FLOAT_EQ(layerSample(*tracks[0], 1, 150),
+                    layerSample(*original.getTracks()[0], 1, 150));
+  }
+}
+
+TEST(SessionFormatTest, LayersBeingRecordedAreSavedAsFarAsTheyHaveGot) {
+  TrackManager manager;
+  recordSession(manager);
+  auto *second = manager.getTracks()[1];
+
+  // A block into an overdub that hasn't come round yet
+  juce::AudioBuffer<float> buffer(2, 100);
+  manager.startRecordingTrack(second->getId());
+  for (int channel = 0; channel < 2; ++channel)
+    juce::FloatVectorOperations::fill(buffer.getWritePointer(channel), 0.5f,
+                                      100);
+  manager.processBlock(buffer, false);
+  ASSERT_TRUE(second->getLooper().isRecording());
+
+  for (bool compressAudio : {false, true}) {
+    TrackManager restored;
+    restored.prepare(sampleRate, 100);
+    ASSERT_TRUE(load(restored, save(manager, compressAudio)));
+
+    // A full-length layer holding just the block recorded
+    const auto &looper = restored.getTracks()[1]->getLooper();
+    ASSERT_EQ(looper.getNumLoops(), 1u);
+    int numRecorded = 0;
+    for (int position = 0; position < loopLength; ++position) {
+      const float sample = layerSample(*restored.getTracks()[1], 0, position);
+      EXPECT_TRUE(sample == 0.0f || sample == 0.5f);
+      numRecorded += sample == 0.5f ? 1 : 0;
+    }
+    EXPECT_EQ(numRecorded, 100);
+  }
+
+  // Recording on, the session is saved and the layer finalized as usual
+  manager.stopRecordingTrack(second->getId());
+  manager.processBlock(buffer, false);
+  TrackManager restored;
+  restored.prepare(sampleRate, 100);
+  ASSERT_TRUE(load(restored, save(manager)));
+  EXPECT_EQ(restored.getTracks()[1]->getLooper().getNumLoops(), 1u);
+}
+
+TEST(SessionFormatTest, AFirstRecordingInProgressSetsTheLoopLength) {
+  TrackManager manager;
+  manager.prepare(sampleRate, 100);
+  auto *track = manager.addTrack();
+  juce::AudioBuffer<float> buffer(2, 100);
+  manager.startRecordingTrack(track->getId());
+  for (int block = 0; block < 2; ++block) {
+    for (int channel = 0; channel < 2; ++channel)
+      juce::FloatVectorOperations::fill(buffer.getWritePointer(channel),
+                                        0.25f, 100);
+    manager.processBlock(buffer, false);
+  }
+
+  TrackManager restored;
+  restored.prepare(sampleRate, 100);
+  ASSERT_TRUE(load(restored, save(manager)));
+  EXPECT_EQ(restored.getBaseLoopLength(), 200);
+  ASSERT_EQ(restored.getTracks()[0]->getLooper().getNumLoops(), 1u);
+  EXPECT_EQ(layerSample(*restored.getTracks()[0], 0, 199), 0.25f);
+}
+
+TEST(SessionFormatTest, DamagedLayersAreLeftOutAndDamagedSessionsRefused) {
+  TrackManager original;
+  recordSession(original);
+  auto block = save(original);
+
+  // A flipped bit in the layer's audio drops that layer only
+  auto damagedLayer = block;
+  const auto layerOffset = findChunk(block, SessionFormat::layerId);
+  ASSERT_GT(layerOffset, 0u);
+  static_cast<char *>(damagedLayer.getData())[layerOffset + 100] ^= 0x10;
+
+  TrackManager restored;
+  restored.prepare(sampleRate, 100);
+  ASSERT_TRUE(load(restored, damagedLayer));
+  ASSERT_EQ(restored.getTracks().size(), 2u);
+  EXPECT_FALSE(restored.getTracks()[0]->getLooper().hasLoops());
+  EXPECT_TRUE(restored.getTracks()[1]->isSoloed());
+
+  // Without an intact session chunk nothing is restored or replaced
+  auto damagedSession = block;
+  const auto sessionOffset = findChunk(block, SessionFormat::sessionId);
+  static_cast<char *>(damagedSession.getData())[sessionOffset] ^= 0x01;
+  EXPECT_FALSE(load(restored, damagedSession));
+  EXPECT_EQ(restored.getTracks().size(), 2u);
+
+  // Cut short, whatever arrived whole is kept
+  juce::MemoryBlock truncated(block.getData(), layerOffset + 8);
+  TrackManager partial;
+  partial.prepare(sampleRate, 100);
+  ASSERT_TRUE(load(partial, truncated));
+  ASSERT_EQ(partial.getTracks().size(), 1u);
+  EXPECT_FALSE(partial.getTracks()[0]->getLooper().hasLoops());
+}
+
+TEST(SessionFormatTest, LegacyValueTreeSessionsStillLoad) {
+  // The layout sessions were saved in before the binary format
+  juce::MemoryBlock layer;
+  {
+    juce::MemoryOutputStream stream(layer, false);
+    stream.writeInt(loopLength);
+    stream.writeBool(true);
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < loopLength; ++i)
+        stream.writeFloat(ramp(channel, i));
+  }
+
+  juce::ValueTree trackState("Track0");
+  trackState.setProperty("trackId", 3, nullptr);
+  trackState.setProperty("volume", 0.5f, nullptr);
+  trackState.setProperty("soloed", true, nullptr);
+  trackState.setProperty("loopCount", 1, nullptr);
+  trackState.setProperty("sampleRate", sampleRate, nullptr);
+  trackState.setProperty("loop_0", layer.toBase64Encoding(), nullptr);
+
+  juce::ValueTree state("PARAMETERS");
+  state.setProperty("baseLoopLength", loopLength, nullptr);
+  state.setProperty("sampleRate", sampleRate, nullptr);
+  state.setProperty("trackCount", 1, nullptr);
+  state.addChild(trackState, -1, nullptr);
+
+  TrackManager manager;
+  manager.prepare(sampleRate, 100);
+  manager.setState(state, sampleRate);
+
+  const auto tracks = manager.getTracks();
+  ASSERT_EQ(tracks.size(), 1u);
+  EXPECT_EQ(tracks[0]->getId(), 3);
+  EXPECT_TRUE(tracks[0]->isSoloed());
+  EXPECT_EQ(manager.getBaseLoopLength(), loopLength);
+  ASSERT_EQ(tracks[0]->getLooper().getNumLoops(), 1u);
+  EXPECT_FLOAT_EQ(layerSample(*tracks[0], 0, 120), ramp(0, 120));
+  EXPECT_FLOAT_EQ(layerSample(*tracks[0], 1, 120), ramp(1, 120));
+}
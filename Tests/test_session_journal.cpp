@@ -0,0 +1,123 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test_helpers.h"
+#include <gtest/gtest.h>
+
+using namespace TestHelpers;
+
+namespace {
+constexpr double sampleRate = 1000.0;
+
+juce::File journalFile() {
+  const auto folder =
+      juce::File::getSpecialLocation(juce::File::tempDirectory)
+          .getChildFile("LooperJournalTest");
+  folder.deleteRecursively();
+  return folder.getChildFile("session.journal");
+}
+} // namespace
+
+TEST(SessionJournalTest, RecoversFinishedLayersAndControls) {
+  const auto file = journalFile();
+  TrackManager manager;
+  manager.prepare(sampleRate, 100);
+  auto *first = manager.addTrack();
+  auto *second = manager.addTrack();
+  second->setVolume(0.25f);
+  second->setSoloed(true);
+  recordRamp(manager, *first, 3);
+
+  // A layer still being recorded is left for later
+  manager.startJournal(file);
+  recordRamp(manager, *second, 1, false);
+  ASSERT_TRUE(manager.syncJournal(5000));
+
+  TrackManager recovered;
+  recovered.prepare(sampleRate, 100);
+  ASSERT_TRUE(recovered.recoverJournal(file, sampleRate));
+  EXPECT_EQ(recovered.getBaseLoopLength(), 300);
+
+  const auto tracks = recovered.getTracks();
+  ASSERT_EQ(tracks.size(), 2u);
+  EXPECT_EQ(tracks[0]->getId(), first->getId());
+  ASSERT_EQ(tracks[0]->getLooper().getNumLoops(), 1u);
+  for (int channel = 0; channel < 2; ++channel)
+    for (int position = 0; position < 300; ++position)
+      EXPECT_EQ(layerSample(*tracks[0], channel, position),
+                layerSample(*first, channel, position))
+          << channel << ", " << position;
+
+  EXPECT_EQ(tracks[1]->getLooper().getNumLoops(), 0u);
+  EXPECT_FLOAT_EQ(tracks[1]->getVolume(), 0.25f);
+  EXPECT_TRUE(tracks[1]->isSoloed());
+
+  // Once finished, the layer follows
+  manager.stopRecordingTrack(second->getId());
+  juce::AudioBuffer<float> buffer(2, 100);
+  manager.processBlock(buffer, false);
+  ASSERT_TRUE(manager.syncJournal(5000));
+  ASSERT_TRUE(recovered.recoverJournal(file, sampleRate));
+  EXPECT_EQ(recovered.getTracks()[1]->getLooper().getNumLoops(), 1u);
+
+  manager.stopJournal();
+  EXPECT_TRUE(file.existsAsFile());
+  file.getParentDirectory().deleteRecursively();
+}
+
+TEST(SessionJournalTest, LeavesOutUndoneLayersAndTornRecords) {
+  const auto file = journalFile();
+  TrackManager manager;
+  manager.prepare(sampleRate, 100);
+  auto *track = manager.addTrack();
+  manager.startJournal(file);
+
+  recordRamp(manager, *track, 3);
+  recordRamp(manager, *track, 1);
+  ASSERT_TRUE(manager.syncJournal(5000));
+  EXPECT_EQ(track->getLooper().getNumLoops(), 2u);
+
+  // The undo is queued, then carried out at the top of the next block
+  manager.undoTrack(track->getId());
+  juce::AudioBuffer<float> buffer(2, 100);
+  manager.processBlock(buffer, false);
+  manager.processBlock(buffer, false);
+  EXPECT_EQ(track->getLooper().getNumLoops(), 1u);
+  ASSERT_TRUE(manager.syncJournal(5000));
+  manager.stopJournal();
+
+  // A crash in the middle of writing a record leaves part of it behind
+  {
+    juce::FileOutputStream stream(file);
+    stream.writeInt(static_cast<int>(SessionJournal::layerId));
+    stream.writeInt(1 << 20);
+    stream.writeInt(track->getId());
+  }
+
+  TrackManager recovered;
+  recovered.prepare(sampleRate, 100);
+  ASSERT_TRUE(recovered.recoverJournal(file, sampleRate));
+  const auto tracks = recovered.getTracks();
+  ASSERT_EQ(tracks.size(), 1u);
+  EXPECT_EQ(tracks[0]->getLooper().getNumLoops(), 1u);
+
+  // Nothing to recover from a file that isn't a journal
+  file.deleteFile();
+  EXPECT_FALSE(recovered.recoverJournal(file, sampleRate));
+  file.getParentDirectory().deleteRecursively();
+}
@@ -0,0 +1,89 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../Source/Models/TrackControls.h"
+#include <gtest/gtest.h>
+
+TEST(TrackControlsTest, CountsFollowEachChange) {
+  TrackControls controls;
+  controls.resize(130);
+
+  controls.set(3, 0.5f, true, true, false);
+  controls.set(70, 0.5f, true, false, true);
+  controls.set(129, 0.5f, false, true, false);
+  EXPECT_TRUE(controls.isAnySoloed());
+  EXPECT_TRUE(controls.isAnyRecording());
+
+  // Setting the same state again changes nothing
+  controls.set(3, 0.5f, true, true, false);
+  controls.set(3, 0.5f, false, true, false);
+  EXPECT_TRUE(controls.isAnySoloed());
+  controls.set(70, 0.5f, false, false, false);
+  EXPECT_FALSE(controls.isAnySoloed());
+  EXPECT_FALSE(controls.isAnyRecording());
+
+  controls.set(3, 0.5f, false, false, false);
+  EXPECT_TRUE(controls.isAnyPlaying());
+  controls.set(129, 0.5f, false, false, false);
+  EXPECT_FALSE(controls.isAnyPlaying());
+}
+
+TEST(TrackControlsTest, SoloLimitsTheAudibleTracks) {
+  TrackControls controls;
+  controls.resize(100);
+  for (int i = 0; i < 100; ++i)
+    controls.set(i, i == 50 ? 0.0f : 0.5f, false, i % 2 == 0, false);
+
+  // Every playing track with some volume, in order
+  const int numAudible = controls.collectAudible();
+  ASSERT_EQ(numAudible, 49);
+  EXPECT_EQ(controls.getAudible(0), 0);
+  EXPECT_EQ(controls.getAudible(25), 52);
+  EXPECT_EQ(controls.getAudible(48), 98);
+
+  // Soloed and playing is heard; soloed but stopped, or playing but not
+  // soloed, is not
+  controls.set(64, 0.5f, true, true, false);
+  controls.set(65, 0.5f, true, false, false);
+  controls.set(66, 0.5f, false, true, false);
+  ASSERT_EQ(controls.collectAudible(), 1);
+  EXPECT_EQ(controls.getAudible(0), 64);
+
+  // Once nothing is soloed, every playing track is heard again
+  controls.set(64, 0.5f, false, true, false);
+  controls.set(65, 0.5f, false, false, false);
+  EXPECT_EQ(controls.collectAudible(), numAudible);
+}
+
+TEST(TrackControlsTest, VisitsRecordingTracksInOrder) {
+  TrackControls controls;
+  controls.resize(200);
+  controls.set(1, 0.5f, false, true, true);
+  controls.set(150, 0.5f, false, true, true);
+  controls.set(63, 0.5f, false, true, true);
+
+  // Stopping a track while it is visited is allowed
+  std::vector<int> visited;
+  controls.forEachRecording([&](int index) {
+    visited.push_back(index);
+    controls.set(index, 0.5f, false, true, false);
+  });
+
+  EXPECT_EQ(visited, (std::vector<int>{1, 63, 150}));
+  EXPECT_FALSE(controls.isAnyRecording());
+}
@@ -0,0 +1,388 @@
+/*
+ * LooperPlugin
+ * Copyright (C) 2026 NathanMyles
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test_helpers.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(TrackManagerTest, ControlsApplyAtOnceWhileAudioIsStopped) {
+  TrackManager manager;
+  auto *track = manager.addTrack();
+
+  manager.startRecordingTrack(track->getId());
+  EXPECT_TRUE(track->getLooper().isRecording());
+
+  manager.stopRecordingTrack(track->getId());
+  EXPECT_FALSE(track->getLooper().isRecording());
+}
+
+TEST(TrackManagerTest, ControlsWaitForTheNextBlockWhileAudioRuns) {
+  TrackManager manager;
+  manager.prepare(44100.0, 256);
+  auto *track = manager.addTrack();
+  juce::AudioBuffer<float> buffer(2, 256);
+  buffer.clear();
+
+  manager.startRecordingTrack(track->getId());
+  EXPECT_TRUE(track->isRecording());
+  EXPECT_FALSE(track->getLooper().isRecording());
+
+  manager.processBlock(buffer, false);
+  EXPECT_TRUE(track->getLooper().isRecording());
+
+  // Undo stops recording, then drops the layer just recorded
+  manager.undoTrack(track->getId());
+  EXPECT_TRUE(track->getLooper().hasLoops());
+
+  manager.processBlock(buffer, false);
+  EXPECT_FALSE(track->getLooper().isRecording());
+  EXPECT_FALSE(track->getLooper().hasLoops());
+  EXPECT_FALSE(manager.hasBaseLoopLength());
+}
+
+TEST(TrackManagerTest, RemovingATrackPublishesANewList) {
+  TrackManager manager;
+  manager.prepare(44100.0, 256);
+  auto *first = manager.addTrack();
+  manager.addTrack();
+  ASSERT_EQ(manager.getTrackCount(), 2);
+
+  manager.removeTrack(first->getId());
+  EXPECT_EQ(manager.getTrackCount(), 1);
+  EXPECT_EQ(manager.findTrack(first->getId()), nullptr);
+
+  juce::AudioBuffer<float> buffer(2, 256);
+  buffer.clear();
+  manager.processBlock(buffer, false);
+}
+
+TEST(TrackManagerTest, HandlesGoStaleWhenTheirTrackIsRemoved) {
+  TrackManager manager;
+  manager.prepare(44100.0, 256);
+  const int firstId = manager.addTrack()->getId();
+  auto *second = manager.addTrack();
+  const auto first = manager.getTrackHandle(firstId);
+  ASSERT_FALSE(first.isNull());
+  EXPECT_EQ(manager.resolve(first)->getId(), firstId);
+  EXPECT_EQ(manager.resolve(second->getHandle()), second);
+  EXPECT_TRUE(manager.getTrackHandle(firstId + 100).isNull());
+  EXPECT_EQ(manager.resolve({}), nullptr);
+
+  // The new track takes the freed slot, but not the old handle
+  manager.removeTrack(firstId);
+  auto *third = manager.addTrack();
+  EXPECT_EQ(third->getHandle().slot, first.slot);
+  EXPECT_EQ(manager.resolve(first), nullptr);
+  EXPECT_EQ(manager.resolve(third->getHandle()), third);
+  EXPECT_EQ(manager.findTrack(third->getId()), third);
+
+  // Restored tracks replace every handle
+  const auto secondHandle = second->getHandle();
+  manager.setState(juce::ValueTree("LooperState"), 44100.0);
+  EXPECT_EQ(manager.resolve(secondHandle), nullptr);
+  EXPECT_EQ(manager.getTrackCount(), 0);
+}
+
+TEST(TrackManagerTest, WithTrackKeepsTheTrackAliveWhileItRuns) {
+  TrackManager manager;
+  manager.prepare(1000.0, TestHelpers::blockSize);
+  auto *track = manager.addTrack();
+  TestHelpers::recordRamp(manager, *track, 3);
+  const auto handles = manager.getTrackHandles();
+  ASSERT_EQ(handles.size(), 1u);
+
+  // A view reading the waveform while the host restores a session elsewhere
+  std::atomic<int> numReads{0};
+  std::thread reader([&] {
+    while (manager.withTrack(handles[0], [](Track &t) {
+      EXPECT_EQ(t.getLooper().getWaveformPeaks(64, 0, 300).size(), 64u);
+    }))
+      ++numReads;
+  });
+  while (numReads.load() == 0)
+    std::this_thread::yield();
+  manager.setState(juce::ValueTree("LooperState"), 1000.0);
+  reader.join();
+
+  EXPECT_TRUE(manager.getTrackHandles().empty());
+  EXPECT_FALSE(manager.withTrack(handles[0], [](Track &) { FAIL(); }));
+}
+
+TEST(TrackManagerTest, CommandsTakeEffectAtTheirSampleOffset) {
+  TrackManager manager;
+  manager.prepare(44100.0, 256);
+  auto *track = manager.addTrack();
+  juce::AudioBuffer<float> buffer(2, 256);
+  buffer.clear();
+
+  manager.postCommand(
+      {TrackCommand::Type::startRecording, track->getId(), 0.0f, 100});
+  manager.processBlock(buffer, false);
+
+  // Recording (and the playback it starts) began 100 samples in
+  EXPECT_TRUE(track->getLooper().isRecording());
+  EXPECT_EQ(track->getLooper().getRecordingLength(), 156);
+  EXPECT_EQ(manager.getReadPosition(), 156);
+}
+
+TEST(TrackManagerTest, ParallelRenderingMatchesSerial) {
+  auto render = [](int numWorkers) {
+    TrackManager manager;
+    manager.prepare(1000.0, 64);
+    manager.setParallelRendering(numWorkers, 2);
+
+    juce::AudioBuffer<float> buffer(2, 64);
+    for (int t = 0; t < 6; ++t) {
+      auto *track = manager.addTrack();
+      manager.startRecordingTrack(track->getId());
+      for (int block = 0; block < 4; ++block) {
+        for (int channel = 0; channel < 2; ++channel)
+          for (int i = 0; i < 64; ++i)
+            buffer.setSample(channel, i, 0.01f * static_cast<float>(t + 1));
+        manager.processBlock(buffer, false);
+      }
+      manager.stopRecordingTrack(track->getId());
+    }
+
+    buffer.clear();
+    manager.processBlock(buffer, false);
+    return buffer.getSample(0, 10);
+  };
+
+  const float serial = render(0);
+  EXPECT_GT(serial, 0.0f);
+  EXPECT_NEAR(render(3), serial, 1.0e-6f);
+}
+
+TEST(TrackManagerTest, RateChangeResamplesLoopsInsteadOfClearingThem) {
+  TrackManager manager;
+  manager.prepare(1000.0, 100);
+  auto *track = manager.addTrack();
+
+  juce::AudioBuffer<float> buffer(2, 100);
+  manager.startRecordingTrack(track->getId());
+  for (int block = 0; block < 3; ++block) {
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < 100; ++i)
+        buffer.setSample(channel, i, 0.25f);
+    manager.processBlock(buffer, false);
+  }
+  manager.stopRecordingTrack(track->getId());
+  manager.processBlock(buffer, false);
+  ASSERT_EQ(manager.getBaseLoopLength(), 300);
+
+  manager.release();
+  manager.prepare(2000.0, 100);
+  EXPECT_EQ(manager.getBaseLoopLength(), 600);
+  EXPECT_TRUE(track->getLooper().hasLoops());
+
+  // Silent until the converted layers are swapped in
+  for (int i = 0; i < 200 && (track->getLooper().isResampling() ||
+                              !track->getLooper().hasLayerSum());
+       ++i) {
+    buffer.clear();
+    manager.processBlock(buffer, false);
+    juce::Thread::sleep(10);
+  }
+  ASSERT_FALSE(track->getLooper().isResampling());
+
+  buffer.clear();
+  manager.processBlock(buffer, false);
+  EXPECT_NEAR(buffer.getSample(0, 50), std::tanh(0.25f) * 0.7f, 1.0e-3f);
+}
+
+TEST(TrackManagerTest, TelemetryIsPublishedEveryBlock) {
+  TrackManager manager;
+  auto *track = manager.addTrack();
+
+  // While audio is stopped, applying a command publishes straight away
+  track->setVolume(0.5f);
+  const auto &stopped = manager.getTelemetry();
+  ASSERT_EQ(stopped.numTracks, 1);
+  EXPECT_EQ(stopped.tracks[0].trackId, track->getId());
+  EXPECT_FLOAT_EQ(stopped.tracks[0].volume, 0.5f);
+
+  manager.prepare(44100.0, 256);
+  juce::AudioBuffer<float> buffer(2, 256);
+  auto fill = [&buffer] {
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < 256; ++i)
+        buffer.setSample(channel, i, 0.25f);
+  };
+
+  manager.startRecordingTrack(track->getId());
+  for (int block = 0; block < 4; ++block) {
+    fill();
+    manager.processBlock(buffer, false);
+  }
+  const auto sequence = manager.getTelemetry().sequence;
+  const auto &recording = manager.getTelemetry();
+  EXPECT_TRUE(recording.tracks[0].recording);
+  EXPECT_EQ(recording.tracks[0].numLoops, 1);
+  EXPECT_EQ(recording.tracks[0].recordingLength, 4 * 256);
+
+  manager.stopRecordingTrack(track->getId());
+  fill();
+  manager.processBlock(buffer, false);
+  fill();
+  manager.processBlock(buffer, false);
+
+  // The loop plays back at a constant level, after saturation and volume
+  const auto &playing = manager.getTelemetry();
+  EXPECT_GT(playing.sequence, sequence);
+  EXPECT_TRUE(playing.anyPlaying);
+  EXPECT_EQ(playing.baseLoopLength, 4 * 256);
+  const float level = std::tanh(0.25f) * 0.5f;
+  EXPECT_NEAR(playing.tracks[0].meter.peak[0], level, 1.0e-5f);
+  EXPECT_NEAR(playing.tracks[0].meter.peakHold[1], level, 1.0e-5f);
+
+  // RMS is averaged over a few hundred milliseconds, so it is still rising
+  EXPECT_GT(playing.tracks[0].meter.rms[1], 0.0f);
+  EXPECT_LT(playing.tracks[0].meter.rms[1], level);
+  EXPECT_GT(playing.master.peak[0], 0.0f);
+}
+
+TEST(TrackManagerTest, StateVersionOnlyChangesWithTheControls) {
+  TrackManager manager;
+  auto *track = manager.addTrack();
+  manager.prepare(44100.0, 256);
+  juce::AudioBuffer<float> buffer(2, 256);
+  buffer.clear();
+
+  track->setVolume(0.5f);
+  manager.processBlock(buffer, false);
+  const auto version = manager.getTelemetry().tracks[0].version;
+
+  // Requests that leave the controls as they were don't count as changes
+  track->setVolume(0.5f);
+  track->setSoloed(false);
+  manager.processBlock(buffer, false);
+  EXPECT_EQ(manager.getTelemetry().tracks[0].version, version);
+
+  track->setSoloed(true);
+  manager.processBlock(buffer, false);
+  EXPECT_NE(manager.getTelemetry().tracks[0].version, version);
+  EXPECT_TRUE(manager.getTelemetry().tracks[0].soloed);
+}
+
+TEST(TrackManagerTest, ExportWritesEveryTrackAndTheMaster) {
+  const auto folder =
+      juce::File::getSpecialLocation(juce::File::tempDirectory)
+          .getChildFile("LooperExportTest");
+  folder.deleteRecursively();
+  TrackExporter::Options options;
+  options.folder = folder;
+  options.numCycles = 2;
+
+  // Nothing to export before there is a loop
+  TrackManager manager;
+  manager.prepare(1000.0, 100);
+  auto *track = manager.addTrack();
+  manager.addTrack();
+  EXPECT_FALSE(manager.startExport(options));
+
+  juce::AudioBuffer<float> buffer(2, 100);
+  manager.startRecordingTrack(track->getId());
+  for (int block = 0; block < 3; ++block) {
+    for (int channel = 0; channel < 2; ++channel)
+      juce::FloatVectorOperations::fill(buffer.getWritePointer(channel),
+                                        0.5f, 100);
+    manager.processBlock(buffer, false);
+  }
+  manager.stopRecordingTrack(track->getId());
+  buffer.clear();
+  manager.processBlock(buffer, false);
+
+  ASSERT_TRUE(manager.startExport(options));
+  while (manager.isExporting())
+    juce::Thread::sleep(1);
+  EXPECT_TRUE(manager.hasExportSucceeded());
+  EXPECT_EQ(manager.getExportProgress(), 1.0f);
+  for (const char *name : {"Track 1.wav", "Track 2.wav", "Master.wav"})
+    EXPECT_TRUE(folder.getChildFile(name).existsAsFile()) << name;
+
+  folder.deleteRecursively();
+}
+
+TEST(TrackManagerTest, TelemetryReportsEveryTrackByHandle) {
+  TrackManager manager;
+  std::vector<Track *> tracks;
+  while (auto *track = manager.addTrack())
+    tracks.push_back(track);
+  ASSERT_EQ(tracks.size(), TrackManager::maxTracks);
+
+  // Removing one frees a slot for a new track, under a new handle
+  const auto removed = tracks[5]->getHandle();
+  manager.removeTrack(tracks[5]->getId());
+  auto *added = manager.addTrack();
+  ASSERT_NE(added, nullptr);
+  added->setVolume(0.25f);
+
+  const auto &snapshot = manager.getTelemetry();
+  EXPECT_EQ(snapshot.numTracks, static_cast<int>(TrackManager::maxTracks));
+  EXPECT_EQ(snapshot.findTrack(removed), nullptr);
+  ASSERT_NE(snapshot.findTrack(added->getHandle()), nullptr);
+  EXPECT_EQ(snapshot.findTrack(added->getHandle())->trackId, added->getId());
+  EXPECT_FLOAT_EQ(snapshot.findTrack(added->getHandle())->volume, 0.25f);
+  const auto *last = snapshot.findTrack(tracks.back()->getHandle());
+  ASSERT_NE(last, nullptr);
+  EXPECT_EQ(last->trackId, tracks.back()->getId());
+}
+
+TEST(TrackManagerTest, SoloIsHeardAcrossManyTracks) {
+  TrackManager manager;
+  manager.prepare(1000.0, 64);
+  juce::AudioBuffer<float> buffer(2, 64);
+
+  // Every track records the same block, so each one adds 0.01
+  std::vector<Track *> tracks;
+  for (int t = 0; t < 70; ++t) {
+    auto *track = manager.addTrack();
+    tracks.push_back(track);
+    manager.startRecordingTrack(track->getId());
+    for (int channel = 0; channel < 2; ++channel)
+      for (int i = 0; i < 64; ++i)
+        buffer.setSample(channel, i, 0.01f);
+    manager.processBlock(buffer, false);
+    manager.stopRecordingTrack(track->getId());
+    track->setVolume(1.0f);
+  }
+
+  buffer.clear();
+  manager.processBlock(buffer, false);
+  EXPECT_NEAR(buffer.getSample(0, 10), 0.7f, 1.0e-4f);
+
+  // Soloing tracks in the second bitmap word mutes every other one
+  tracks[65]->setSoloed(true);
+  tracks[69]->setSoloed(true);
+  buffer.clear();
+  manager.processBlock(buffer, false);
+  EXPECT_NEAR(buffer.getSample(0, 10), 0.02f, 1.0e-5f);
+
+  // Removing a soloed track keeps the other soloed
+  manager.removeTrack(tracks[65]->getId());
+  buffer.clear();
+  manager.processBlock(buffer, false);
+  EXPECT_NEAR(buffer.getSample(0, 10), 0.01f, 1.0e-5f);
+
+  tracks[69]->setSoloed(false);
+  buffer.clear();
+  manager.processBlock(buffer, false);
+  EXPECT_NEAR(buffer.getSample(0, 10), 0.69f, 1.0e-4f);
+}